@@ -1,3 +1,4 @@
 C:\VulkanSDK\1.4.335.0\Bin\glslc.exe .\res\shaders\shader.vert -o .\res\shaders\vert.spv
 C:\VulkanSDK\1.4.335.0\Bin\glslc.exe .\res\shaders\shader.frag -o .\res\shaders\frag.spv
+C:\VulkanSDK\1.4.335.0\Bin\glslc.exe .\res\shaders\morph.comp -o .\res\shaders\morph.spv
 pause
\ No newline at end of file
@@ -127,7 +127,9 @@ vec3 getNormalFromMap()
     vec2 uv = getUV(getTexCoordIndex(uMat.normalTT));
     uv = applyTextureTransform(uv, uMat.normalTT);
 
-    vec3 tangentNormal = texture(normalTex, uv).xyz * 2.0 - 1.0;
+    // Only X/Y are read so two-channel (BC5) normal maps work; Z is rebuilt
+    vec2 xy = texture(normalTex, uv).rg * 2.0 - 1.0;
+    vec3 tangentNormal = vec3(xy, sqrt(clamp(1.0 - dot(xy, xy), 0.0, 1.0)));
 
     mat3 TBN = mat3(normalize(fragTangent),
                     normalize(fragBitangent),
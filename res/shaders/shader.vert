@@ -12,6 +12,8 @@ layout(push_constant) uniform PushConstants {
     int emissiveTextureSet;
     float alphaMask;
     float alphaMaskCutoff;
+    int jointOffset;        // -1 = rigid mesh
+    int vatVertexBase;      // -1 = not a crowd draw
 } pc;
 
 layout(binding = 0) uniform UniformBufferObject {
@@ -27,8 +29,26 @@ layout(binding = 0) uniform UniformBufferObject {
     float gamma;
     float prefilteredCubeMipLevels;
     float scaleIBLAmbient;
+    float time;
 } ubo;
 
+// Joint palettes of every skinned instance, indexed from pc.jointOffset
+layout(std430, binding = 1) readonly buffer JointMatrices {
+    mat4 jointMatrices[];
+};
+
+// Crowd: one clip baked per vertex, texel (vatVertexBase + vertex, frame)
+layout(binding = 2) uniform sampler2D vatPositions;
+layout(binding = 3) uniform sampler2D vatNormals;
+
+struct VatInstance {
+    mat4 transform;
+    vec4 playback;          // x = start frame, y = frames per second
+};
+layout(std430, binding = 4) readonly buffer VatInstances {
+    VatInstance vatInstances[];
+};
+
 // ─────────────────────────────────────────────
 // Vertex Inputs
 // ─────────────────────────────────────────────
@@ -37,6 +57,8 @@ layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inNormal;
 layout(location = 4) in vec4 inTangent;
+layout(location = 5) in uvec4 inJoints;
+layout(location = 6) in vec4 inWeights;
 
 // ─────────────────────────────────────────────
 // Vertex Outputs
@@ -49,14 +71,41 @@ layout(location = 4) out vec3 fragTangent;
 layout(location = 5) out vec3 fragBitangent;
 
 void main() {
+    vec3 position = inPosition;
+    vec3 normal = inNormal;
     mat4 modelNode = pc.nodeMatrix;
+    if (pc.vatVertexBase >= 0) {
+        // The pose is already baked in, only placement and phase are per instance
+        VatInstance instance = vatInstances[gl_InstanceIndex];
+        int frames = textureSize(vatPositions, 0).y;
+        float frame = mod(instance.playback.x + ubo.time * instance.playback.y, float(frames));
+        int frame0 = min(int(frame), frames - 1);
+        ivec2 texel0 = ivec2(pc.vatVertexBase + gl_VertexIndex, frame0);
+        ivec2 texel1 = ivec2(texel0.x, (frame0 + 1) % frames);
+        float t = fract(frame);
+        position = mix(texelFetch(vatPositions, texel0, 0).xyz, texelFetch(vatPositions, texel1, 0).xyz, t);
+        normal = mix(texelFetch(vatNormals, texel0, 0).xyz, texelFetch(vatNormals, texel1, 0).xyz, t);
+        modelNode = instance.transform;
+    }
+    else if (pc.jointOffset >= 0 && dot(inWeights, vec4(1.0)) > 0.0) {
+        uint base = uint(pc.jointOffset);
+        mat4 skinMatrix =
+            inWeights.x * jointMatrices[base + inJoints.x] +
+            inWeights.y * jointMatrices[base + inJoints.y] +
+            inWeights.z * jointMatrices[base + inJoints.z] +
+            inWeights.w * jointMatrices[base + inJoints.w];
+        modelNode = modelNode * skinMatrix;
+    }
 
-    vec4 worldPos = modelNode * vec4(inPosition, 1.0);
+    vec4 worldPos = modelNode * vec4(position, 1.0);
     fragWorldPos = worldPos.xyz;
 
     mat3 normalMatrix = transpose(inverse(mat3(modelNode)));
-    vec3 N = normalize(normalMatrix * inNormal);
+    vec3 N = normalize(normalMatrix * normal);
     vec3 T = normalize(normalMatrix * inTangent.xyz);
+    if (pc.vatVertexBase >= 0) {
+        T = normalize(T - N * dot(N, T));   // rest-pose tangent, kept orthogonal to the baked normal
+    }
     vec3 B = cross(N, T) * inTangent.w;
 
     fragNormal   = N;
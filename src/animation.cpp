@@ -0,0 +1,599 @@
+#include "headers/animation.h"
+#include "headers/models.h"
+#include "headers/skinning.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIMATION_SSE 1
+#include <emmintrin.h>
+#endif
+//Batches
+// LINEAR channels of one instance are gathered into SoA lanes, interpolated
+// four at a time, then scattered back into the pose.
+struct Vec3Batch {
+	std::vector<float> ax, ay, az, bx, by, bz, t;
+	std::vector<glm::vec3*> target;
+
+	void clear() {
+		ax.clear(); ay.clear(); az.clear(); bx.clear(); by.clear(); bz.clear(); t.clear(); target.clear();
+	}
+	void push(const glm::vec3& a, const glm::vec3& b, float factor, glm::vec3* out) {
+		ax.push_back(a.x); ay.push_back(a.y); az.push_back(a.z);
+		bx.push_back(b.x); by.push_back(b.y); bz.push_back(b.z);
+		t.push_back(factor);
+		target.push_back(out);
+	}
+	// Zero lanes up to a multiple of four so the SIMD loop needs no tail
+	size_t pad() {
+		size_t count = t.size();
+		size_t padded = (count + 3) & ~size_t(3);
+		for (auto* lane : { &ax, &ay, &az, &bx, &by, &bz, &t }) lane->resize(padded, 0.0f);
+		return count;
+	}
+};
+
+struct QuatBatch {
+	std::vector<float> ax, ay, az, aw, bx, by, bz, bw, t;
+	std::vector<glm::quat*> target;
+
+	void clear() {
+		ax.clear(); ay.clear(); az.clear(); aw.clear(); bx.clear(); by.clear(); bz.clear(); bw.clear(); t.clear(); target.clear();
+	}
+	void push(const glm::vec4& a, const glm::vec4& b, float factor, glm::quat* out) {
+		ax.push_back(a.x); ay.push_back(a.y); az.push_back(a.z); aw.push_back(a.w);
+		bx.push_back(b.x); by.push_back(b.y); bz.push_back(b.z); bw.push_back(b.w);
+		t.push_back(factor);
+		target.push_back(out);
+	}
+	size_t pad() {
+		size_t count = t.size();
+		size_t padded = (count + 3) & ~size_t(3);
+		// Identity padding keeps the normalize away from zero-length lanes
+		for (auto* lane : { &ax, &ay, &az, &bx, &by, &bz, &t }) lane->resize(padded, 0.0f);
+		aw.resize(padded, 1.0f);
+		bw.resize(padded, 1.0f);
+		return count;
+	}
+};
+
+// Results are written back into the a lanes
+static void lerpBatch(Vec3Batch& batch) {
+	size_t count = batch.pad();
+	size_t i = 0;
+#ifdef ANIMATION_SSE
+	for (; i < count; i += 4) {
+		__m128 t = _mm_loadu_ps(&batch.t[i]);
+		float* a[3] = { &batch.ax[i], &batch.ay[i], &batch.az[i] };
+		const float* b[3] = { &batch.bx[i], &batch.by[i], &batch.bz[i] };
+		for (int c = 0; c < 3; c++) {
+			__m128 va = _mm_loadu_ps(a[c]);
+			__m128 vb = _mm_loadu_ps(b[c]);
+			_mm_storeu_ps(a[c], _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), t)));
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		batch.ax[i] += (batch.bx[i] - batch.ax[i]) * batch.t[i];
+		batch.ay[i] += (batch.by[i] - batch.ay[i]) * batch.t[i];
+		batch.az[i] += (batch.bz[i] - batch.az[i]) * batch.t[i];
+	}
+	for (i = 0; i < count; i++) {
+		*batch.target[i] = glm::vec3(batch.ax[i], batch.ay[i], batch.az[i]);
+	}
+}
+
+// Slerp approximated as nlerp with a corrected t (Kapoulkine, "Approximating
+// slerp"): no trig, so it vectorises, and the error stays below 1e-3 rad.
+static inline float slerpCorrection(float t, float d) {
+	float A = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+	float B = 0.848013f + d * (-1.06021f + d * 0.215638f);
+	float k = A * (t - 0.5f) * (t - 0.5f) + B;
+	return t + t * (t - 0.5f) * (t - 1.0f) * k;
+}
+
+static void slerpBatch(QuatBatch& batch) {
+	size_t count = batch.pad();
+	size_t i = 0;
+#ifdef ANIMATION_SSE
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (; i < count; i += 4) {
+		__m128 ax = _mm_loadu_ps(&batch.ax[i]), ay = _mm_loadu_ps(&batch.ay[i]);
+		__m128 az = _mm_loadu_ps(&batch.az[i]), aw = _mm_loadu_ps(&batch.aw[i]);
+		__m128 bx = _mm_loadu_ps(&batch.bx[i]), by = _mm_loadu_ps(&batch.by[i]);
+		__m128 bz = _mm_loadu_ps(&batch.bz[i]), bw = _mm_loadu_ps(&batch.bw[i]);
+		__m128 t = _mm_loadu_ps(&batch.t[i]);
+
+		// Take the short way round: flip b where the dot product is negative
+		__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+			_mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+		__m128 flip = _mm_and_ps(d, signMask);
+		bx = _mm_xor_ps(bx, flip); by = _mm_xor_ps(by, flip);
+		bz = _mm_xor_ps(bz, flip); bw = _mm_xor_ps(bw, flip);
+		d = _mm_xor_ps(d, flip);
+
+		__m128 A = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f),
+			_mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+		__m128 B = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f),
+			_mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+		__m128 tc = _mm_sub_ps(t, half);
+		__m128 k = _mm_add_ps(_mm_mul_ps(A, _mm_mul_ps(tc, tc)), B);
+		__m128 ot = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, _mm_mul_ps(tc, _mm_sub_ps(t, one))), k));
+
+		__m128 rx = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), ot));
+		__m128 ry = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), ot));
+		__m128 rz = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), ot));
+		__m128 rw = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), ot));
+		__m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+			_mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw))));
+
+		_mm_storeu_ps(&batch.ax[i], _mm_div_ps(rx, len));
+		_mm_storeu_ps(&batch.ay[i], _mm_div_ps(ry, len));
+		_mm_storeu_ps(&batch.az[i], _mm_div_ps(rz, len));
+		_mm_storeu_ps(&batch.aw[i], _mm_div_ps(rw, len));
+	}
+#endif
+	for (; i < count; i++) {
+		glm::vec4 a(batch.ax[i], batch.ay[i], batch.az[i], batch.aw[i]);
+		glm::vec4 b(batch.bx[i], batch.by[i], batch.bz[i], batch.bw[i]);
+		float d = glm::dot(a, b);
+		if (d < 0.0f) { b = -b; d = -d; }
+		glm::vec4 r = glm::normalize(a + (b - a) * slerpCorrection(batch.t[i], d));
+		batch.ax[i] = r.x; batch.ay[i] = r.y; batch.az[i] = r.z; batch.aw[i] = r.w;
+	}
+	for (i = 0; i < count; i++) {
+		*batch.target[i] = glm::quat(batch.aw[i], batch.ax[i], batch.ay[i], batch.az[i]);
+	}
+}
+
+//Sampling
+static inline glm::quat quatFromVec4(const glm::vec4& v) {
+	return glm::quat(v.w, v.x, v.y, v.z);
+}
+
+// Hermite spline over one key interval, tangents already scaled by the interval
+template <typename T>
+static T cubicSpline(const T& v0, const T& out0, const T& v1, const T& in1, float t, float dt) {
+	float t2 = t * t;
+	float t3 = t2 * t;
+	return (2.0f * t3 - 3.0f * t2 + 1.0f) * v0 + (t3 - 2.0f * t2 + t) * dt * out0
+		+ (-2.0f * t3 + 3.0f * t2) * v1 + (t3 - t2) * dt * in1;
+}
+
+// Moves the cursor to the key interval containing time. Playback only runs
+// forward, so this is amortised O(1); a loop back to the start resets it.
+static inline uint32_t cursorAdvance(const std::vector<float>& inputs, uint32_t cursor, float time) {
+	if (cursor >= inputs.size() || time < inputs[cursor]) {
+		cursor = 0;
+	}
+	while (cursor + 2 < inputs.size() && time >= inputs[cursor + 1]) {
+		cursor++;
+	}
+	return cursor;
+}
+
+// Morph weights: one scalar per target per key (three for CUBICSPLINE),
+// written into the node's slice of the pose
+static void weightsSample(const Model& model, const AnimationSampler& sampler, uint32_t node, uint32_t k, uint32_t k1, float t, AnimationPose& pose) {
+	uint32_t first = model.morphWeightFirst[node];
+	if (first == UINT32_MAX || sampler.outputsScalar.empty()) return;
+
+	bool cubic = sampler.interpolation == AnimationSampler::CUBICSPLINE;
+	size_t count = sampler.outputsScalar.size() / (sampler.inputs.size() * (cubic ? 3 : 1));
+	count = std::min(count, pose.weights.size() - first);
+	const float* o = sampler.outputsScalar.data();
+	float* out = &pose.weights[first];
+
+	for (size_t i = 0; i < count; i++) {
+		switch (sampler.interpolation) {
+		case AnimationSampler::STEP:
+			out[i] = o[k * count + i];
+			break;
+		case AnimationSampler::LINEAR:
+			out[i] = o[k * count + i] + (o[k1 * count + i] - o[k * count + i]) * t;
+			break;
+		case AnimationSampler::CUBICSPLINE: {
+			float v0 = o[(3 * k + 1) * count + i];
+			out[i] = k1 == k ? v0 : cubicSpline(v0, o[(3 * k + 2) * count + i], o[(3 * k1 + 1) * count + i], o[3 * k1 * count + i],
+				t, sampler.inputs[k1] - sampler.inputs[k]);
+			break;
+		}
+		}
+	}
+}
+
+//Compression
+// Smallest three: drop the largest quaternion component (it is recovered from
+// unit length), store the other three in 15 bits each over +-1/sqrt(2), and
+// the dropped index in the spare top bits. 6 bytes instead of 16.
+static constexpr float QUAT_RANGE = 0.70710678f;
+
+static void quatPack(glm::vec4 q, uint16_t* out) {
+	q = glm::normalize(q);
+	int largest = 0;
+	for (int c = 1; c < 4; c++) {
+		if (std::fabs(q[c]) > std::fabs(q[largest])) largest = c;
+	}
+	if (q[largest] < 0.0f) q = -q;   // q and -q are the same rotation
+
+	int slot = 0;
+	for (int c = 0; c < 4; c++) {
+		if (c == largest) continue;
+		float unit = glm::clamp(q[c] / QUAT_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+		out[slot++] = static_cast<uint16_t>(std::lround(unit * 32767.0f));
+	}
+	out[0] |= (largest & 1) << 15;
+	out[1] |= (largest >> 1) << 15;
+}
+
+static inline glm::vec4 quatUnpack(const uint16_t* in) {
+	int largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+	float v[3];
+	for (int i = 0; i < 3; i++) {
+		v[i] = ((in[i] & 0x7fff) * (1.0f / 32767.0f) * 2.0f - 1.0f) * QUAT_RANGE;
+	}
+	glm::vec4 q;
+	int slot = 0;
+	for (int c = 0; c < 4; c++) {
+		if (c != largest) q[c] = v[slot++];
+	}
+	q[largest] = std::sqrt(std::max(0.0f, 1.0f - v[0] * v[0] - v[1] * v[1] - v[2] * v[2]));
+	return q;
+}
+
+// Key values, decoded on the fly when the sampler is packed
+static inline glm::vec4 samplerQuat(const AnimationSampler& sampler, uint32_t key) {
+	return sampler.packed.empty() ? sampler.outputsVec4[key] : quatUnpack(&sampler.packed[3 * key]);
+}
+static inline glm::vec3 samplerVec3(const AnimationSampler& sampler, uint32_t key) {
+	if (sampler.packed.empty()) return sampler.outputsVec3[key];
+	const uint16_t* p = &sampler.packed[3 * key];
+	return sampler.rangeMin + glm::vec3(p[0], p[1], p[2]) * sampler.rangeStep;
+}
+
+static float quatAngle(const glm::vec4& a, const glm::vec4& b) {
+	float d = std::min(std::fabs(glm::dot(glm::normalize(a), glm::normalize(b))), 1.0f);
+	return 2.0f * std::acos(d);
+}
+
+// Greedy key reduction: extend each segment while every key it would skip is
+// reproduced within tolerance by interpolating the segment's ends.
+template <typename T, typename Error>
+static std::vector<uint32_t> keysReduce(const std::vector<float>& times, const std::vector<T>& values, bool step, float tolerance, Error error) {
+	std::vector<uint32_t> kept = { 0 };
+	uint32_t count = static_cast<uint32_t>(times.size());
+	for (uint32_t end = 2; end < count; end++) {
+		uint32_t start = kept.back();
+		bool fits = true;
+		for (uint32_t k = start + 1; k < end && fits; k++) {
+			T expected = values[start];
+			if (!step) {
+				float t = (times[k] - times[start]) / std::max(times[end] - times[start], 1e-6f);
+				expected = values[start] + (values[end] - values[start]) * t;
+			}
+			fits = error(expected, values[k]) <= tolerance;
+		}
+		if (!fits) kept.push_back(end - 1);
+	}
+	if (count > 1) kept.push_back(count - 1);
+	return kept;
+}
+
+static size_t samplerMemory(const AnimationSampler& sampler) {
+	return sampler.inputs.size() * sizeof(float) + sampler.outputsVec4.size() * sizeof(glm::vec4)
+		+ sampler.outputsVec3.size() * sizeof(glm::vec3) + sampler.outputsScalar.size() * sizeof(float)
+		+ sampler.packed.size() * sizeof(uint16_t);
+}
+
+size_t animationMemory(const Animation& animation) {
+	size_t bytes = animation.channels.size() * sizeof(AnimationChannel);
+	for (const AnimationSampler& sampler : animation.samplers) {
+		bytes += sizeof(AnimationSampler) + samplerMemory(sampler);
+	}
+	return bytes;
+}
+
+// Rewrites every LINEAR/STEP sampler of the asset in place. CUBICSPLINE
+// keeps its float tangents: they don't survive quantization well.
+void animationCompress(Model& model, const AnimationCompression& settings) {
+	for (Animation& animation : model.animations) {
+		std::vector<bool> isScale(animation.samplers.size(), false);
+		for (const AnimationChannel& channel : animation.channels) {
+			if (channel.path == AnimationChannel::SCALE) isScale[channel.samplerIndex] = true;
+		}
+
+		for (size_t s = 0; s < animation.samplers.size(); s++) {
+			AnimationSampler& sampler = animation.samplers[s];
+			if (sampler.interpolation == AnimationSampler::CUBICSPLINE || !sampler.packed.empty() || sampler.inputs.empty()) continue;
+			bool step = sampler.interpolation == AnimationSampler::STEP;
+			std::vector<uint32_t> kept;
+
+			if (!sampler.outputsVec4.empty()) {
+				// Neighbouring keys in the same hemisphere so the lerp test is meaningful
+				for (size_t k = 1; k < sampler.outputsVec4.size(); k++) {
+					if (glm::dot(sampler.outputsVec4[k - 1], sampler.outputsVec4[k]) < 0.0f) sampler.outputsVec4[k] = -sampler.outputsVec4[k];
+				}
+				kept = keysReduce(sampler.inputs, sampler.outputsVec4, step, settings.rotationError, quatAngle);
+				sampler.packed.resize(kept.size() * 3);
+				for (size_t k = 0; k < kept.size(); k++) quatPack(sampler.outputsVec4[kept[k]], &sampler.packed[3 * k]);
+				sampler.outputsVec4 = {};
+			}
+			else if (!sampler.outputsVec3.empty()) {
+				glm::vec3 lo(std::numeric_limits<float>::max()), hi(std::numeric_limits<float>::lowest());
+				for (const glm::vec3& v : sampler.outputsVec3) { lo = glm::min(lo, v); hi = glm::max(hi, v); }
+				glm::vec3 extent = hi - lo;
+				float tolerance = (isScale[s] ? settings.scaleError : settings.translationError) * std::max({ extent.x, extent.y, extent.z });
+
+				kept = keysReduce(sampler.inputs, sampler.outputsVec3, step, tolerance,
+					[](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); });
+				sampler.rangeMin = lo;
+				sampler.rangeStep = extent / 65535.0f;
+				sampler.packed.resize(kept.size() * 3);
+				for (size_t k = 0; k < kept.size(); k++) {
+					const glm::vec3& v = sampler.outputsVec3[kept[k]];
+					for (int c = 0; c < 3; c++) {
+						float unit = extent[c] > 0.0f ? (v[c] - lo[c]) / extent[c] : 0.0f;
+						sampler.packed[3 * k + c] = static_cast<uint16_t>(std::lround(unit * 65535.0f));
+					}
+				}
+				sampler.outputsVec3 = {};
+			}
+			else {
+				continue;
+			}
+
+			std::vector<float> times(kept.size());
+			for (size_t k = 0; k < kept.size(); k++) times[k] = sampler.inputs[kept[k]];
+			sampler.inputs = std::move(times);
+		}
+	}
+}
+
+//Animation
+void animationPoseCreate(const Model& model, ModelInstance& instance) {
+	const NodeStore& nodes = model.nodes;
+	AnimationPose& pose = instance.pose;
+
+	pose.translation = nodes.translation;
+	pose.rotation = nodes.rotation;
+	pose.scale = nodes.scale;
+	pose.global = nodes.global;
+	pose.weights = model.morphWeights;
+	pose.cursors.assign(model.animations.empty() ? 0 : model.animations[instance.animationIndex].channels.size(), 0);
+}
+
+// Parents precede children in the store, one forward pass resolves the pose
+static void posePropagate(const NodeStore& nodes, AnimationPose& pose) {
+	for (uint32_t i = 0; i < nodes.size(); i++) {
+		glm::mat4 local;
+		if (nodes.hasMatrix[i]) {
+			local = nodes.matrix[i];
+		}
+		else {
+			local = glm::translate(glm::mat4(1.0f), pose.translation[i])
+				* glm::mat4_cast(pose.rotation[i])
+				* glm::scale(glm::mat4(1.0f), pose.scale[i]);
+		}
+		pose.global[i] = nodes.parent[i] == NODE_NONE ? local : pose.global[nodes.parent[i]] * local;
+	}
+}
+
+void animationInstanceUpdate(const Model& model, ModelInstance& instance, float deltaTime, bool skipLeafJoints) {
+	if (model.animations.empty() || instance.pose.empty()) return;
+
+	const Animation& animation = model.animations[instance.animationIndex];
+	AnimationPose& pose = instance.pose;
+	if (pose.cursors.size() != animation.channels.size()) {
+		pose.cursors.assign(animation.channels.size(), 0);
+	}
+
+	float duration = animation.end - animation.start;
+	instance.animationTime += deltaTime * instance.animationSpeed;
+	if (instance.animationTime > animation.end || instance.animationTime < animation.start) {
+		instance.animationTime = duration > 0.0f
+			? animation.start + std::fmod(std::fabs(instance.animationTime - animation.start), duration)
+			: animation.start;
+	}
+	float time = instance.animationTime;
+
+	thread_local Vec3Batch vec3Batch;
+	thread_local QuatBatch quatBatch;
+	vec3Batch.clear();
+	quatBatch.clear();
+
+	for (size_t c = 0; c < animation.channels.size(); c++) {
+		const AnimationChannel& channel = animation.channels[c];
+		if (channel.node == NODE_NONE) continue;
+		if (skipLeafJoints && !model.leafJoint.empty() && model.leafJoint[channel.node]) continue;
+		const AnimationSampler& sampler = animation.samplers[channel.samplerIndex];
+		if (sampler.inputs.empty()) continue;
+
+		uint32_t k = pose.cursors[c] = cursorAdvance(sampler.inputs, pose.cursors[c], time);
+		uint32_t last = static_cast<uint32_t>(sampler.inputs.size() - 1);
+
+		// Clamp outside the keyed range, otherwise interpolate [k, k + 1]
+		float t = 0.0f;
+		uint32_t k1 = k;
+		if (time >= sampler.inputs[last]) {
+			k = k1 = last;
+		}
+		else if (time > sampler.inputs[k]) {
+			k1 = k + 1;
+			t = (time - sampler.inputs[k]) / (sampler.inputs[k1] - sampler.inputs[k]);
+		}
+
+		if (channel.path == AnimationChannel::WEIGHTS) {
+			weightsSample(model, sampler, channel.node, k, k1, t, pose);
+			continue;
+		}
+
+		bool rotation = channel.path == AnimationChannel::ROTATION;
+		glm::vec3* vec3Target = channel.path == AnimationChannel::TRANSLATION
+			? &pose.translation[channel.node] : &pose.scale[channel.node];
+
+		switch (sampler.interpolation) {
+		case AnimationSampler::STEP:
+			if (rotation) pose.rotation[channel.node] = quatFromVec4(samplerQuat(sampler, k));
+			else *vec3Target = samplerVec3(sampler, k);
+			break;
+
+		case AnimationSampler::LINEAR:
+			if (rotation) quatBatch.push(samplerQuat(sampler, k), samplerQuat(sampler, k1), t, &pose.rotation[channel.node]);
+			else vec3Batch.push(samplerVec3(sampler, k), samplerVec3(sampler, k1), t, vec3Target);
+			break;
+
+		case AnimationSampler::CUBICSPLINE: {
+			float dt = sampler.inputs[k1] - sampler.inputs[k];
+			if (rotation) {
+				const std::vector<glm::vec4>& o = sampler.outputsVec4;
+				glm::vec4 q = k1 == k ? o[3 * k + 1] : cubicSpline(o[3 * k + 1], o[3 * k + 2], o[3 * k1 + 1], o[3 * k1], t, dt);
+				pose.rotation[channel.node] = glm::normalize(quatFromVec4(q));
+			}
+			else {
+				const std::vector<glm::vec3>& o = sampler.outputsVec3;
+				*vec3Target = k1 == k ? o[3 * k + 1] : cubicSpline(o[3 * k + 1], o[3 * k + 2], o[3 * k1 + 1], o[3 * k1], t, dt);
+			}
+			break;
+		}
+		}
+	}
+
+	lerpBatch(vec3Batch);
+	slerpBatch(quatBatch);
+
+	posePropagate(model.nodes, pose);
+}
+
+//LOD
+// Fraction of the screen height an instance's bounding sphere must cover
+static constexpr float LOD_FULL_SCREEN_SIZE = 0.25f;
+static constexpr float LOD_HALF_SCREEN_SIZE = 0.10f;
+
+void animationLodSelect(State* state, const glm::mat4& viewProj, const glm::vec3& camPos, float focalScale) {
+	// Frustum planes straight from the matrix rows (Gribb & Hartmann), depth 0..1
+	glm::mat4 m = glm::transpose(viewProj);
+	std::array<glm::vec4, 6> planes = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[2], m[3] - m[2] };
+	for (glm::vec4& plane : planes) plane /= glm::length(glm::vec3(plane));
+
+	std::array<uint32_t, ANIMATION_LOD_COUNT>& counts = state->scene.animationLodCounts;
+	counts.fill(0);
+	for (ModelInstance& instance : state->scene.instances) {
+		const Model* model = modelGet(state, instance.model);
+		if (!model || (instance.pose.empty() && model->jointCount == 0)) continue;
+
+		glm::vec3 center = glm::vec3(instance.transform * glm::vec4(model->boundsCenter, 1.0f));
+		float scale = std::max({ glm::length(glm::vec3(instance.transform[0])),
+			glm::length(glm::vec3(instance.transform[1])),
+			glm::length(glm::vec3(instance.transform[2])) });
+		float radius = model->boundsRadius * scale;
+
+		bool visible = true;
+		for (const glm::vec4& plane : planes)
+			visible = visible && glm::dot(glm::vec3(plane), center) + plane.w >= -radius;
+
+		if (!visible) {
+			instance.lod = ANIMATION_LOD_FROZEN;
+		}
+		else {
+			float screenSize = radius * focalScale / std::max(glm::length(center - camPos), 1e-3f);
+			instance.lod = screenSize >= LOD_FULL_SCREEN_SIZE ? ANIMATION_LOD_FULL
+				: screenSize >= LOD_HALF_SCREEN_SIZE ? ANIMATION_LOD_HALF
+				: ANIMATION_LOD_QUARTER;
+		}
+		counts[instance.lod]++;
+	}
+}
+
+// Keeps the pose just sampled as the newest of the two LOD samples. The
+// older buffers are recycled, so steady state allocates nothing.
+static void poseSampleShift(AnimationPose& pose) {
+	if (pose.to.empty()) {
+		pose.to = { pose.translation, pose.rotation, pose.scale };
+	}
+	std::swap(pose.from, pose.to);
+	pose.to.translation.assign(pose.translation.begin(), pose.translation.end());
+	pose.to.rotation.assign(pose.rotation.begin(), pose.rotation.end());
+	pose.to.scale.assign(pose.scale.begin(), pose.scale.end());
+}
+
+// Local TRS between the two samples: lerp for translation and scale, the
+// corrected nlerp for rotation, then the globals are rebuilt from it
+static void poseSampleBlend(const NodeStore& nodes, AnimationPose& pose, float t) {
+	thread_local Vec3Batch vec3Batch;
+	thread_local QuatBatch quatBatch;
+	vec3Batch.clear();
+	quatBatch.clear();
+
+	const PoseSample& from = pose.from;
+	const PoseSample& to = pose.to;
+	for (size_t i = 0; i < to.rotation.size(); i++) {
+		vec3Batch.push(from.translation[i], to.translation[i], t, &pose.translation[i]);
+		vec3Batch.push(from.scale[i], to.scale[i], t, &pose.scale[i]);
+		const glm::quat& a = from.rotation[i];
+		const glm::quat& b = to.rotation[i];
+		quatBatch.push(glm::vec4(a.x, a.y, a.z, a.w), glm::vec4(b.x, b.y, b.z, b.w), t, &pose.rotation[i]);
+	}
+	lerpBatch(vec3Batch);
+	slerpBatch(quatBatch);
+
+	posePropagate(nodes, pose);
+}
+
+// Everything one instance needs for a frame, touching only its own data.
+// Reduced LODs sample every 2nd/4th frame and blend the local pose between
+// the last two samples, which trails the full-rate pose by one interval.
+void animationInstanceFrame(const Model& model, ModelInstance& instance, float deltaTime, glm::mat4* palette) {
+	AnimationPose& pose = instance.pose;
+	if (!pose.empty()) {
+		switch (instance.lod) {
+		case ANIMATION_LOD_FROZEN:
+			instance.lodPendingTime += deltaTime;
+			break;
+
+		case ANIMATION_LOD_FULL:
+			animationInstanceUpdate(model, instance, deltaTime + instance.lodPendingTime);
+			instance.lodPendingTime = 0.0f;
+			pose.to.clear();
+			break;
+
+		default: {
+			uint8_t interval = instance.lod == ANIMATION_LOD_HALF ? 2 : 4;
+			instance.lodPendingTime += deltaTime;
+			if (pose.to.empty() || instance.lodPhase >= interval) {
+				animationInstanceUpdate(model, instance, instance.lodPendingTime, instance.lod == ANIMATION_LOD_QUARTER);
+				instance.lodPendingTime = 0.0f;
+				instance.lodPhase = 0;
+				poseSampleShift(pose);
+			}
+			instance.lodPhase++;
+			poseSampleBlend(model.nodes, pose, (float)instance.lodPhase / interval);
+			break;
+		}
+		}
+	}
+	if (palette) {
+		skinningInstancePalette(model, instance, palette);
+	}
+}
+
+// Runs between the frame's fence wait and commandBufferRecord. Instances are
+// independent, so sampling, propagation and palettes are split over the job
+// system and all of it is done before recording starts.
+void animationUpdate(State* state, float deltaTime) {
+	PROFILE_FUNCTION();
+	auto start = std::chrono::high_resolution_clock::now();
+
+	glm::mat4* palette = skinningPaletteReserve(state);
+	std::vector<ModelInstance>& instances = state->scene.instances;
+	jobParallelFor(state, static_cast<uint32_t>(instances.size()), 16, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			ModelInstance& instance = instances[i];
+			if (instance.pose.empty() && instance.jointBase == UINT32_MAX) continue;
+			const Model* model = modelGet(state, instance.model);
+			if (model) {
+				animationInstanceFrame(*model, instance, deltaTime, instance.jointBase == UINT32_MAX ? nullptr : palette + instance.jointBase);
+			}
+		}
+	});
+	state->renderer.animationCpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
@@ -1,25 +1,50 @@
 #include "headers/application.h"
 
 void init(State *state) {
+	profilerThreadName("main");
 	errorHandlingSetup(state);
 	logPrint(state);
+	jobSystemCreate(state);
+	metricsCreate(state);               // before loading, so model load times are exported
+	startupPhase(state, "init");
 	windowCreate(state);
 };
 
 void mainloop(State *state) {
+	if (!state->frameBench.path.empty()) {
+		frameBenchRun(state);
+		return;
+	}
+	if (state->config.headless) {
+		headlessRun(state);
+		return;
+	}
+	double lastFrameTime = glfwGetTime();
 	while (!glfwWindowShouldClose(state->window.handle)) {
 		glfwPollEvents();
 		updateFPS(state);
 		processInput(state);
 
+		double frameTime = glfwGetTime();
+		float deltaTime = (float)(frameTime - lastFrameTime);
+		lastFrameTime = frameTime;
+		cameraPathRecord(state, deltaTime);
+
 		uniformBuffersUpdate(state);
 
-		frameDraw(state);
+		frameDraw(state, deltaTime);
+		metricsFrame(state);
 
 	};
 		vkDeviceWaitIdle(state->context.device);
 };
 
 void cleanup(State *state) {
+	cameraPathSave(state);
 	windowDestroy(state);
+	jobSystemDestroy(state);
+	metricsDestroy(state);
+	if (!state->config.tracePath.empty()) {
+		profilerTraceWrite(state->config.tracePath);
+	}
 };
\ No newline at end of file
@@ -0,0 +1,1025 @@
+#include "headers/benchmark.h"
+#include <random>
+//Utility
+using BenchClock = std::chrono::high_resolution_clock;
+
+static double elapsedMs(BenchClock::time_point start) {
+	return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+// Best of several runs, the first one also warms the caches
+template <typename F>
+static double benchBest(int runs, F&& body) {
+	double best = std::numeric_limits<double>::max();
+	for (int i = 0; i < runs; i++) {
+		auto start = BenchClock::now();
+		body();
+		best = std::min(best, elapsedMs(start));
+	}
+	return best;
+}
+
+// ─────────────────────────────────────────────
+// Scene storage: pointer tree vs NodeStore
+// ─────────────────────────────────────────────
+
+// The node layout processNode used to build: one heap object per node,
+// linked by pointers, found by a linear name search.
+struct LegacyNode {
+	std::string name;
+	LegacyNode* parent = nullptr;
+	std::vector<LegacyNode*> children;
+	std::vector<Mesh> meshes;
+	glm::vec3 translation = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+
+	glm::mat4 getLocalMatrix() const {
+		glm::mat4 T = glm::translate(glm::mat4(1.0f), translation);
+		glm::mat4 R = glm::mat4_cast(rotation);
+		glm::mat4 S = glm::scale(glm::mat4(1.0f), scale);
+		return T * R * S;
+	}
+	glm::mat4 getGlobalMatrix() const {
+		return parent ? parent->getGlobalMatrix() * getLocalMatrix() : getLocalMatrix();
+	}
+};
+
+static void benchSceneStorage(State* state) {
+	const uint32_t nodeCount = 100000;
+	const uint32_t lookupCount = 1000;
+	const int runs = 5;
+
+	// Same random hierarchy for both layouts: each node hangs off one of the
+	// 64 nodes created before it, which gives realistic depths (~20-40)
+	std::mt19937 rng(1234);
+	std::vector<uint32_t> parents(nodeCount, NODE_NONE);
+	for (uint32_t i = 1; i < nodeCount; i++) {
+		uint32_t lo = i > 64 ? i - 64 : 0;
+		parents[i] = std::uniform_int_distribution<uint32_t>(lo, i - 1)(rng);
+	}
+	std::vector<glm::vec3> offsets(nodeCount);
+	for (glm::vec3& offset : offsets) {
+		offset = glm::vec3(std::uniform_real_distribution<float>(-1.0f, 1.0f)(rng), 0.1f, 0.0f);
+	}
+
+	// Legacy pointer tree
+	auto buildStart = BenchClock::now();
+	std::vector<LegacyNode*> legacy(nodeCount);
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		legacy[i] = new LegacyNode();
+		legacy[i]->name = "node_" + std::to_string(i);
+		legacy[i]->translation = offsets[i];
+		if (parents[i] != NODE_NONE) {
+			legacy[i]->parent = legacy[parents[i]];
+			legacy[parents[i]]->children.push_back(legacy[i]);
+		}
+	}
+	double legacyBuildMs = elapsedMs(buildStart);
+
+	// NodeStore. Random parents are not depth-first ordered, but every parent
+	// still precedes its children, which is all updateGlobals relies on.
+	buildStart = BenchClock::now();
+	StringTable names;
+	NodeStore store;
+	std::unordered_map<uint32_t, uint32_t> nodeByName;
+	store.reserve(nodeCount);
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		uint32_t node = store.add(parents[i], names.intern("node_" + std::to_string(i)));
+		store.translation[node] = offsets[i];
+		nodeByName.emplace(store.name[node], node);
+	}
+	double storeBuildMs = elapsedMs(buildStart);
+
+	float sink = 0.0f;
+
+	// What gatherDrawItems did: a recursive walk asking every node for its
+	// global matrix, which re-walks the parent chain each time
+	double legacyWalkMs = benchBest(runs, [&] {
+		std::function<void(const LegacyNode*)> recurse = [&](const LegacyNode* node) {
+			sink += node->getGlobalMatrix()[3].x;
+			for (const LegacyNode* child : node->children) recurse(child);
+		};
+		recurse(legacy[0]);
+	});
+
+	// Fairer pointer baseline: top-down, parent matrix passed along
+	double legacyTopDownMs = benchBest(runs, [&] {
+		std::function<void(const LegacyNode*, const glm::mat4&)> recurse = [&](const LegacyNode* node, const glm::mat4& parentMatrix) {
+			glm::mat4 global = parentMatrix * node->getLocalMatrix();
+			sink += global[3].x;
+			for (const LegacyNode* child : node->children) recurse(child, global);
+		};
+		recurse(legacy[0], glm::mat4(1.0f));
+	});
+
+	double storeWalkMs = benchBest(runs, [&] {
+		store.updateGlobals();
+		sink += store.global[nodeCount - 1][3].x;
+	});
+
+	// Hierarchy-only traversal through the index links
+	double storeLinksMs = benchBest(runs, [&] {
+		std::vector<uint32_t> stack{ 0 };
+		uint32_t visited = 0;
+		while (!stack.empty()) {
+			uint32_t node = stack.back();
+			stack.pop_back();
+			visited++;
+			for (uint32_t child = store.firstChild[node]; child != NODE_NONE; child = store.nextSibling[child])
+				stack.push_back(child);
+		}
+		sink += (float)visited;
+	});
+
+	std::vector<std::string> queries(lookupCount);
+	for (std::string& query : queries) {
+		query = "node_" + std::to_string(std::uniform_int_distribution<uint32_t>(0, nodeCount - 1)(rng));
+	}
+
+	double legacyFindMs = benchBest(runs, [&] {
+		for (const std::string& query : queries) {
+			auto it = std::ranges::find_if(legacy, [&query](const LegacyNode* node) { return node->name == query; });
+			sink += it != legacy.end() ? 1.0f : 0.0f;
+		}
+	});
+
+	double storeFindMs = benchBest(runs, [&] {
+		for (const std::string& query : queries) {
+			auto it = nodeByName.find(names.find(query));
+			sink += it != nodeByName.end() ? 1.0f : 0.0f;
+		}
+	});
+
+	for (LegacyNode* node : legacy) delete node;
+
+	printf("scene storage, %u nodes (best of %i)\n", nodeCount, runs);
+	printf("  %-34s %10s %10s\n", "", "pointers", "NodeStore");
+	printf("  %-34s %10.3f %10.3f ms\n", "build", legacyBuildMs, storeBuildMs);
+	printf("  %-34s %10.3f %10.3f ms\n", "global matrices (old gather walk)", legacyWalkMs, storeWalkMs);
+	printf("  %-34s %10.3f %10.3f ms\n", "global matrices (top-down)", legacyTopDownMs, storeWalkMs);
+	printf("  %-34s %10s %10.3f ms\n", "hierarchy walk (links only)", "-", storeLinksMs);
+	printf("  %-34s %10.3f %10.3f ms\n", "findNode x1000", legacyFindMs, storeFindMs);
+	printf("  (checksum %f)\n", sink);
+}
+
+// ─────────────────────────────────────────────
+// Animation: 1000 Fox.glb instances
+// ─────────────────────────────────────────────
+
+// What Model::updateAnimation used to do per channel (binary search, glm
+// mix/slerp), minus its early exit, so both paths produce the same pose.
+static void legacyInstanceUpdate(const Model& model, ModelInstance& instance, float deltaTime) {
+	const Animation& animation = model.animations[instance.animationIndex];
+	AnimationPose& pose = instance.pose;
+
+	instance.animationTime += deltaTime;
+	if (instance.animationTime > animation.end) {
+		instance.animationTime = animation.start + std::fmod(instance.animationTime - animation.start, animation.end - animation.start);
+	}
+
+	for (const AnimationChannel& channel : animation.channels) {
+		const AnimationSampler& sampler = animation.samplers[channel.samplerIndex];
+		auto keyFrameIt = std::ranges::upper_bound(sampler.inputs, instance.animationTime);
+		if (keyFrameIt == sampler.inputs.end() || keyFrameIt == sampler.inputs.begin()) continue;
+
+		size_t i = std::distance(sampler.inputs.begin(), keyFrameIt) - 1;
+		float t = (instance.animationTime - sampler.inputs[i]) / (sampler.inputs[i + 1] - sampler.inputs[i]);
+		switch (channel.path) {
+		case AnimationChannel::TRANSLATION:
+			pose.translation[channel.node] = glm::mix(sampler.outputsVec3[i], sampler.outputsVec3[i + 1], t);
+			break;
+		case AnimationChannel::ROTATION: {
+			const glm::vec4& a = sampler.outputsVec4[i];
+			const glm::vec4& b = sampler.outputsVec4[i + 1];
+			pose.rotation[channel.node] = glm::slerp(glm::quat(a.w, a.x, a.y, a.z), glm::quat(b.w, b.x, b.y, b.z), t);
+			break;
+		}
+		case AnimationChannel::SCALE:
+			pose.scale[channel.node] = glm::mix(sampler.outputsVec3[i], sampler.outputsVec3[i + 1], t);
+			break;
+		}
+	}
+
+	const NodeStore& nodes = model.nodes;
+	for (uint32_t i = 0; i < nodes.size(); i++) {
+		glm::mat4 local = nodes.hasMatrix[i] ? nodes.matrix[i]
+			: glm::translate(glm::mat4(1.0f), pose.translation[i]) * glm::mat4_cast(pose.rotation[i]) * glm::scale(glm::mat4(1.0f), pose.scale[i]);
+		pose.global[i] = nodes.parent[i] == NODE_NONE ? local : pose.global[nodes.parent[i]] * local;
+	}
+}
+
+static void benchAnimation(State* state) {
+	const uint32_t instanceCount = 1000;
+	const uint32_t frameCount = 600;
+	const float deltaTime = 1.0f / 60.0f;
+
+	Model fox;
+	modelLoadCpu(state, state->config.FOX_MODEL_PATH, fox);
+	if (fox.animations.empty()) {
+		printf("%s has no animations\n", fox.path.c_str());
+		return;
+	}
+
+	size_t channelCount = fox.animations[0].channels.size();
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> phase(fox.animations[0].start, fox.animations[0].end);
+
+	std::vector<ModelInstance> cursors(instanceCount);
+	std::vector<ModelInstance> legacy(instanceCount);
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		cursors[i].animationTime = legacy[i].animationTime = phase(rng);
+		animationPoseCreate(fox, cursors[i]);
+		animationPoseCreate(fox, legacy[i]);
+	}
+
+	auto run = [&](std::vector<ModelInstance>& instances, auto update) {
+		auto start = BenchClock::now();
+		for (uint32_t frame = 0; frame < frameCount; frame++) {
+			for (ModelInstance& instance : instances) update(fox, instance, deltaTime);
+		}
+		return elapsedMs(start) / frameCount;
+	};
+	double legacyMs = run(legacy, legacyInstanceUpdate);
+	double cursorMs = run(cursors, [](const Model& model, ModelInstance& instance, float dt) {
+		animationInstanceUpdate(model, instance, dt);
+	});
+
+	// Both should land on the same pose; the slerp approximation accounts for the rest
+	float maxError = 0.0f;
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		for (size_t n = 0; n < fox.nodes.size(); n++) {
+			maxError = std::max(maxError, glm::length(glm::vec3(cursors[i].pose.global[n][3] - legacy[i].pose.global[n][3])));
+		}
+	}
+
+#if defined(__SSE2__) || defined(_M_X64)
+	const char* simd = "SSE2";
+#else
+	const char* simd = "scalar";
+#endif
+	printf("animation, %u x %s (%zu nodes, %zu channels), %u frames, batches %s\n",
+		instanceCount, fox.name.c_str(), (size_t)fox.nodes.size(), channelCount, frameCount, simd);
+	printf("  %-34s %10.3f ms/frame %8.3f us/instance\n", "binary search + glm slerp", legacyMs, legacyMs * 1000.0 / instanceCount);
+	printf("  %-34s %10.3f ms/frame %8.3f us/instance\n", "cursors + SoA batches", cursorMs, cursorMs * 1000.0 / instanceCount);
+	printf("  speedup %.2fx, max joint position difference %g\n", legacyMs / cursorMs, maxError);
+}
+
+// ─────────────────────────────────────────────
+// Skinning: CPU side of a Fox.glb crowd
+// ─────────────────────────────────────────────
+
+// Per frame the CPU poses every instance and writes its joint palette; the
+// GPU half is printed by the app itself: VulkanRenderer --fox <count>
+static void benchSkinning(State* state) {
+	const uint32_t instanceCounts[] = { 100, 1000, 10000 };
+	const uint32_t frameCount = 120;
+	const float deltaTime = 1.0f / 60.0f;
+
+	Model fox;
+	modelLoadCpu(state, state->config.FOX_MODEL_PATH, fox);
+	if (fox.skins.empty() || fox.animations.empty()) {
+		printf("%s has no skin or animation\n", fox.path.c_str());
+		return;
+	}
+
+	printf("skinning, %s: %zu skin(s), %u joints, %zu bytes of palette per instance\n",
+		fox.name.c_str(), fox.skins.size(), fox.jointCount, fox.jointCount * sizeof(glm::mat4));
+	printf("  %-10s %14s %14s %14s %12s\n", "instances", "pose ms", "palette ms", "total ms", "upload MB");
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> phase(fox.animations[0].start, fox.animations[0].end);
+	for (uint32_t instanceCount : instanceCounts) {
+		std::vector<ModelInstance> instances(instanceCount);
+		for (ModelInstance& instance : instances) {
+			instance.animationTime = phase(rng);
+			animationPoseCreate(fox, instance);
+		}
+		// Stands in for the mapped joint buffer
+		std::vector<glm::mat4> palette((size_t)instanceCount * fox.jointCount);
+
+		double poseMs = 0.0;
+		double paletteMs = 0.0;
+		for (uint32_t frame = 0; frame < frameCount; frame++) {
+			auto start = BenchClock::now();
+			for (ModelInstance& instance : instances) animationInstanceUpdate(fox, instance, deltaTime);
+			poseMs += elapsedMs(start);
+
+			start = BenchClock::now();
+			for (uint32_t i = 0; i < instanceCount; i++) {
+				skinningInstancePalette(fox, instances[i], &palette[(size_t)i * fox.jointCount]);
+			}
+			paletteMs += elapsedMs(start);
+		}
+		poseMs /= frameCount;
+		paletteMs /= frameCount;
+		printf("  %-10u %14.3f %14.3f %14.3f %12.2f\n", instanceCount, poseMs, paletteMs, poseMs + paletteMs,
+			palette.size() * sizeof(glm::mat4) / (1024.0 * 1024.0));
+	}
+}
+
+// ─────────────────────────────────────────────
+// Parallel animation: 5000 instances, 1..N threads
+// ─────────────────────────────────────────────
+
+// The same per-frame work as animationUpdate (pose, propagation, palette)
+// run through jobParallelFor with a growing worker pool.
+static void benchAnimationScaling(State* state) {
+	const uint32_t instanceCount = 5000;
+	const uint32_t frameCount = 120;
+	const float deltaTime = 1.0f / 60.0f;
+
+	Model fox;
+	modelLoadCpu(state, state->config.FOX_MODEL_PATH, fox);
+	if (fox.animations.empty()) {
+		printf("%s has no animations\n", fox.path.c_str());
+		return;
+	}
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> phase(fox.animations[0].start, fox.animations[0].end);
+	std::vector<ModelInstance> instances(instanceCount);
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		instances[i].animationTime = phase(rng);
+		instances[i].jointBase = i * fox.jointCount;
+		animationPoseCreate(fox, instances[i]);
+	}
+	std::vector<glm::mat4> palette(std::max<size_t>((size_t)instanceCount * fox.jointCount, 1));
+
+	uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<uint32_t> threadCounts;
+	for (uint32_t t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+	threadCounts.push_back(maxThreads);
+
+	uint32_t configuredWorkers = state->config.workerThreadCount;
+	printf("animation scaling, %u x %s (%u joints), %u frames\n", instanceCount, fox.name.c_str(), fox.jointCount, frameCount);
+	printf("  %-8s %12s %10s %12s\n", "threads", "ms/frame", "speedup", "efficiency");
+
+	double serialMs = 0.0;
+	for (uint32_t threads : threadCounts) {
+		// threads = workers + the calling thread, which runs a chunk too
+		jobSystemDestroy(state);
+		if (threads > 1) {
+			state->config.workerThreadCount = threads - 1;
+			jobSystemCreate(state);
+		}
+
+		auto start = BenchClock::now();
+		for (uint32_t frame = 0; frame < frameCount; frame++) {
+			jobParallelFor(state, instanceCount, 16, [&](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; i++) {
+					animationInstanceFrame(fox, instances[i], deltaTime, fox.jointCount ? &palette[instances[i].jointBase] : nullptr);
+				}
+			});
+		}
+		double ms = elapsedMs(start) / frameCount;
+		if (threads == 1) serialMs = ms;
+		printf("  %-8u %12.3f %9.2fx %11.0f%%\n", threads, ms, serialMs / ms, 100.0 * serialMs / ms / threads);
+	}
+
+	jobSystemDestroy(state);
+	state->config.workerThreadCount = configuredWorkers;
+	jobSystemCreate(state);
+}
+
+// ─────────────────────────────────────────────
+// Animation compression: Fox.glb clips
+// ─────────────────────────────────────────────
+
+static void benchAnimationCompression(State* state) {
+	const uint32_t instanceCount = 1000;
+	const uint32_t frameCount = 300;
+	const float deltaTime = 1.0f / 60.0f;
+
+	Model raw, packed;
+	modelLoadCpu(state, state->config.FOX_MODEL_PATH, raw);
+	modelLoadCpu(state, state->config.FOX_MODEL_PATH, packed);
+	animationCompress(packed);
+	if (raw.animations.empty()) {
+		printf("%s has no animations\n", raw.path.c_str());
+		return;
+	}
+
+	printf("animation compression, %s, %u instances x %u frames per clip\n", raw.name.c_str(), instanceCount, frameCount);
+	printf("  %-12s %9s %9s %7s %10s %10s %10s\n", "clip", "raw KB", "packed KB", "keys", "raw ms", "packed ms", "max error");
+
+	auto run = [&](const Model& model, std::vector<ModelInstance>& instances) {
+		auto start = BenchClock::now();
+		for (uint32_t frame = 0; frame < frameCount; frame++) {
+			for (ModelInstance& instance : instances) animationInstanceUpdate(model, instance, deltaTime);
+		}
+		return elapsedMs(start) / frameCount;
+	};
+
+	for (uint32_t clip = 0; clip < raw.animations.size(); clip++) {
+		const Animation& rawClip = raw.animations[clip];
+		const Animation& packedClip = packed.animations[clip];
+		size_t rawKeys = 0, packedKeys = 0;
+		for (const AnimationSampler& sampler : rawClip.samplers) rawKeys += sampler.inputs.size();
+		for (const AnimationSampler& sampler : packedClip.samplers) packedKeys += sampler.inputs.size();
+
+		std::mt19937 rng(clip);
+		std::uniform_real_distribution<float> phase(rawClip.start, rawClip.end);
+		std::vector<ModelInstance> rawInstances(instanceCount), packedInstances(instanceCount);
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			rawInstances[i].animationIndex = packedInstances[i].animationIndex = clip;
+			rawInstances[i].animationTime = packedInstances[i].animationTime = phase(rng);
+			animationPoseCreate(raw, rawInstances[i]);
+			animationPoseCreate(packed, packedInstances[i]);
+		}
+		double rawMs = run(raw, rawInstances);
+		double packedMs = run(packed, packedInstances);
+
+		// Joint positions in model units (Fox.glb is authored in centimetres)
+		float maxError = 0.0f;
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			for (uint32_t n = 0; n < raw.nodes.size(); n++) {
+				maxError = std::max(maxError, glm::length(glm::vec3(rawInstances[i].pose.global[n][3] - packedInstances[i].pose.global[n][3])));
+			}
+		}
+		printf("  %-12s %9.2f %9.2f %6.0f%% %10.3f %10.3f %10.4f\n", rawClip.name.c_str(),
+			animationMemory(rawClip) / 1024.0, animationMemory(packedClip) / 1024.0, 100.0 * packedKeys / std::max<size_t>(rawKeys, 1),
+			rawMs, packedMs, maxError);
+	}
+}
+
+// ─────────────────────────────────────────────
+// Vertex animation textures: bake cost vs per-frame skinning
+// ─────────────────────────────────────────────
+
+// The VAT crowd moves all per-frame work to a few texel fetches per vertex;
+// what is left to pay is a one-off bake and texture memory.
+static void benchVat(State* state) {
+	const uint32_t instanceCount = 10000;
+	const uint32_t frameCount = 30;
+	const float deltaTime = 1.0f / 60.0f;
+	const float bakeRate = 30.0f;
+
+	Model fox;
+	modelLoadCpu(state, state->config.FOX_MODEL_PATH, fox);
+	if (fox.skins.empty() || fox.animations.empty()) {
+		printf("%s has no skin or animation\n", fox.path.c_str());
+		return;
+	}
+
+	printf("vertex animation textures, %s baked at %.0f fps\n", fox.name.c_str(), bakeRate);
+	printf("  %-12s %8s %9s %10s %10s\n", "clip", "frames", "vertices", "bake ms", "texture MB");
+	for (uint32_t clip = 0; clip < fox.animations.size(); clip++) {
+		VatBake bake;
+		double bakeMs = benchBest(3, [&] { vatBake(fox, clip, bakeRate, bake); });
+		printf("  %-12s %8u %9u %10.3f %10.2f\n", fox.animations[clip].name.c_str(), bake.frameCount, bake.width, bakeMs,
+			vatBakeMemory(bake) / (1024.0 * 1024.0));
+	}
+
+	// What the skinned path spends every frame on the same crowd
+	std::mt19937 rng(37);
+	std::uniform_real_distribution<float> phase(fox.animations[0].start, fox.animations[0].end);
+	std::vector<ModelInstance> instances(instanceCount);
+	for (ModelInstance& instance : instances) {
+		instance.animationTime = phase(rng);
+		animationPoseCreate(fox, instance);
+	}
+	std::vector<glm::mat4> palette((size_t)instanceCount * fox.jointCount);
+	auto start = BenchClock::now();
+	for (uint32_t frame = 0; frame < frameCount; frame++) {
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			animationInstanceUpdate(fox, instances[i], deltaTime);
+			skinningInstancePalette(fox, instances[i], &palette[(size_t)i * fox.jointCount]);
+		}
+	}
+	printf("  %u instances per frame: skinned %.3f ms CPU + %.2f MB palette upload, VAT 0 ms CPU + 0 MB\n",
+		instanceCount, elapsedMs(start) / frameCount, palette.size() * sizeof(glm::mat4) / (1024.0 * 1024.0));
+}
+
+// ─────────────────────────────────────────────
+// Node flattening: authored hierarchy vs collapsed static chains
+// ─────────────────────────────────────────────
+
+static void benchFlatten(State* state) {
+	const int updates = 10000;
+	const char* paths[] = { "res/models/Fox.glb", "res/models/Kobold.glb", "res/models/GlassBrokenWindow.glb",
+		"res/models/EmissiveStrengthTest.glb", "res/models/MultiUVTest.glb" };
+
+	bool sceneFlatten = state->config.sceneFlatten;
+	printf("  %-26s %8s %8s %14s %14s %10s\n", "model", "nodes", "flat", "globals ms", "flat ms", "max error");
+	for (const char* path : paths) {
+		Model authored, flat;
+		state->config.sceneFlatten = false;
+		modelLoadCpu(state, path, authored);
+		state->config.sceneFlatten = true;
+		modelLoadCpu(state, path, flat);
+
+		// Every glTF node that survived must resolve to the same global matrix
+		float maxError = 0.0f;
+		for (size_t i = 0; i < flat.nodeFromGltf.size(); i++) {
+			uint32_t a = authored.nodeFromGltf[i], f = flat.nodeFromGltf[i];
+			if (a == NODE_NONE || f == NODE_NONE) continue;
+			for (int c = 0; c < 4; c++)
+				for (int r = 0; r < 4; r++)
+					maxError = std::max(maxError, std::fabs(authored.nodes.global[a][c][r] - flat.nodes.global[f][c][r]));
+		}
+
+		double authoredMs = benchBest(3, [&] { for (int i = 0; i < updates; i++) authored.nodes.updateGlobals(); });
+		double flatMs = benchBest(3, [&] { for (int i = 0; i < updates; i++) flat.nodes.updateGlobals(); });
+		printf("  %-26s %8u %8u %14.3f %14.3f %10.2e\n", authored.name.c_str(), authored.nodes.size(), flat.nodes.size(),
+			authoredMs, flatMs, maxError);
+	}
+	state->config.sceneFlatten = sceneFlatten;
+	printf("  globals: %d full hierarchy updates per model\n", updates);
+}
+
+// ─────────────────────────────────────────────
+// Morph targets: sparse deltas vs dense blend
+// ─────────────────────────────────────────────
+
+// morph.comp over the same mesh and weights on a headless device: one
+// instance, one submit per frame, timed by the "morph" GPU profiler scope.
+// Returns the mean ms per frame, or a negative value without timestamps.
+static double benchMorphGpu(const State* state, const Mesh& source, const std::vector<std::vector<float>>& weights, uint64_t& deltasApplied) {
+	auto scratch = std::make_unique<State>();
+	State* gpu = scratch.get();
+	gpu->config = state->config;
+	gpu->config.gpuStatistics = false;
+	instanceCreate(gpu);
+	deviceCreate(gpu);
+	commandPoolCreate(gpu);
+	commandBufferGet(gpu);
+	gpuProfilerCreate(gpu);
+
+	Model& model = gpu->scene.models.emplace_back();
+	model.name = model.path = "bench://morph";
+	model.refCount = 1;
+	model.meshes.push_back(source);
+	Mesh& mesh = model.meshes[0];
+	mesh.morphWeightFirst = 0;
+	vertexBufferCreateForMesh(gpu, mesh.vertices, mesh.vertexBuffer, mesh.vertexMemory);
+	storageBufferCreate(gpu, mesh.morphDeltas.data(), mesh.morphDeltas.size() * sizeof(MorphDelta), mesh.morphDeltaBuffer, mesh.morphDeltaMemory);
+	gpu->scene.instances.emplace_back().model = ModelHandle{ 0, 0 };
+	morphCreate(gpu);
+
+	const CommandTable& vk = gpu->context.vk;
+	VkCommandBuffer cmd = gpu->buffers.commandBuffer[0];
+	double gpuMs = 0.0;
+	deltasApplied = 0;
+	for (const std::vector<float>& frameWeights : weights) {
+		model.morphWeights = frameWeights;
+		vkResetCommandBuffer(cmd, 0);
+		VkCommandBufferBeginInfo beginInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		vk.beginCommandBuffer(cmd, &beginInfo);
+		gpuProfilerFrameBegin(gpu, cmd);
+		uint32_t scope = gpuScopeBegin(gpu, cmd, "morph", false);
+		morphRecord(gpu, cmd);
+		gpuScopeEnd(gpu, cmd, scope);
+		vk.endCommandBuffer(cmd);
+
+		VkSubmitInfo submitInfo{ .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO, .commandBufferCount = 1, .pCommandBuffers = &cmd };
+		PANIC(vk.queueSubmit(gpu->context.queue, 1, &submitInfo, VK_NULL_HANDLE), "Failed To Submit Queue");
+		morphSubmitted(gpu);
+		vk.queueWaitIdle(gpu->context.queue);
+		gpuProfilerCollect(gpu);
+		gpuMs += gpuScopeMs(gpu, "morph");
+		deltasApplied += gpu->renderer.morphDeltasApplied;
+	}
+	bool timed = gpu->renderer.profiler.timestampPool != VK_NULL_HANDLE;
+
+	morphDestroy(gpu);
+	vkDestroyBuffer(gpu->context.device, mesh.vertexBuffer, nullptr);
+	vkFreeMemory(gpu->context.device, mesh.vertexMemory, nullptr);
+	vkDestroyBuffer(gpu->context.device, mesh.morphDeltaBuffer, nullptr);
+	vkFreeMemory(gpu->context.device, mesh.morphDeltaMemory, nullptr);
+	gpuProfilerDestroy(gpu);
+	vk.freeCommandBuffers(gpu->context.device, gpu->renderer.commandPool, gpu->config.swapchainBuffering, gpu->buffers.commandBuffer);
+	free(gpu->buffers.commandBuffer);
+	commandPoolDestroy(gpu);
+	deviceDestroy(gpu);
+	instanceDestroy(gpu);
+	return timed ? gpuMs / weights.size() : -1.0;
+}
+
+// Face-rig-like synthetic mesh: every target moves one small patch of a
+// 256x256 grid and only a few weights are non-zero in any frame. No asset
+// in res/models has morph targets. With --headless the compute pass is
+// timed on the GPU as well.
+static void benchMorph(State* state) {
+	const uint32_t side = 256;
+	const uint32_t targetCount = 32;
+	const uint32_t activeTargets = 3;
+	const uint32_t frameCount = 120;
+	const float patchRadius = 20.0f;
+	uint32_t vertexCount = side * side;
+
+	Mesh mesh;
+	mesh.vertices.resize(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++) {
+		mesh.vertices[i].pos = glm::vec3((float)(i % side), 0.0f, (float)(i / side));
+		mesh.vertices[i].normal = glm::vec3(0.0f, 1.0f, 0.0f);
+		mesh.vertices[i].tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	// The naive layout stores every target for every vertex
+	std::mt19937 rng(38);
+	std::uniform_real_distribution<float> coordinate(patchRadius, side - patchRadius);
+	std::vector<glm::vec3> densePositions((size_t)targetCount * vertexCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> denseNormals((size_t)targetCount * vertexCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> denseTangents((size_t)targetCount * vertexCount, glm::vec3(0.0f));
+	mesh.morphTargetFirst.push_back(0);
+	for (uint32_t t = 0; t < targetCount; t++) {
+		glm::vec2 center(coordinate(rng), coordinate(rng));
+		for (uint32_t i = 0; i < vertexCount; i++) {
+			float distance = glm::length(glm::vec2(mesh.vertices[i].pos.x, mesh.vertices[i].pos.z) - center);
+			if (distance >= patchRadius) continue;
+			float height = 1.0f - distance / patchRadius;
+			MorphDelta delta{ .vertex = i, .position = { 0.0f, height, 0.0f }, .normal = { 0.0f, 0.0f, 0.1f * height }, .tangent = { 0.0f, 0.1f * height, 0.0f } };
+			mesh.morphDeltas.push_back(delta);
+			densePositions[(size_t)t * vertexCount + i] = glm::vec3(0.0f, height, 0.0f);
+			denseNormals[(size_t)t * vertexCount + i] = glm::vec3(0.0f, 0.0f, 0.1f * height);
+			denseTangents[(size_t)t * vertexCount + i] = glm::vec3(0.0f, 0.1f * height, 0.0f);
+		}
+		mesh.morphTargetFirst.push_back((uint32_t)mesh.morphDeltas.size());
+	}
+
+	// A few targets fading in and out, the rest at zero
+	std::vector<std::vector<float>> weights(frameCount, std::vector<float>(targetCount, 0.0f));
+	for (uint32_t frame = 0; frame < frameCount; frame++) {
+		for (uint32_t a = 0; a < activeTargets; a++) {
+			weights[frame][(frame / 30 + a * 7) % targetCount] = 0.5f + 0.5f * std::sin(frame * 0.1f + a);
+		}
+	}
+
+	std::vector<Vertex> out(vertexCount);
+	double denseMs = benchBest(3, [&] {
+		for (uint32_t frame = 0; frame < frameCount; frame++) {
+			const std::vector<float>& w = weights[frame];
+			for (uint32_t i = 0; i < vertexCount; i++) {
+				Vertex v = mesh.vertices[i];
+				for (uint32_t t = 0; t < targetCount; t++) {
+					size_t d = (size_t)t * vertexCount + i;
+					v.pos += w[t] * densePositions[d];
+					v.normal += w[t] * denseNormals[d];
+					v.tangent += glm::vec4(w[t] * denseTangents[d], 0.0f);
+				}
+				out[i] = v;
+			}
+		}
+	}) / frameCount;
+
+	uint64_t deltasApplied = 0;
+	double sparseMs = benchBest(3, [&] {
+		deltasApplied = 0;
+		for (uint32_t frame = 0; frame < frameCount; frame++) {
+			std::copy(mesh.vertices.begin(), mesh.vertices.end(), out.begin());
+			morphBlendSparse(mesh, weights[frame].data(), out.data());
+			for (uint32_t t = 0; t < targetCount; t++) {
+				if (weights[frame][t] != 0.0f) deltasApplied += mesh.morphTargetFirst[t + 1] - mesh.morphTargetFirst[t];
+			}
+		}
+	}) / frameCount;
+
+	size_t denseBytes = (densePositions.size() + denseNormals.size() + denseTangents.size()) * sizeof(glm::vec3);
+	size_t sparseBytes = mesh.morphDeltas.size() * sizeof(MorphDelta) + mesh.morphTargetFirst.size() * sizeof(uint32_t);
+	printf("morph targets, %u vertices x %u targets, %u non-zero per frame, %.1f%% of vertices per target\n",
+		vertexCount, targetCount, activeTargets, 100.0 * mesh.morphDeltas.size() / ((double)targetCount * vertexCount));
+	printf("  %-22s %10s %12s %12s\n", "blend", "ms/frame", "deltas/frame", "target MB");
+	printf("  %-22s %10.3f %12llu %12.2f\n", "dense, all targets", denseMs, (unsigned long long)targetCount * vertexCount, denseBytes / (1024.0 * 1024.0));
+	printf("  %-22s %10.3f %12llu %12.2f\n", "sparse, non-zero only", sparseMs, (unsigned long long)(deltasApplied / frameCount), sparseBytes / (1024.0 * 1024.0));
+	if (!state->config.headless) {
+		printf("  morph.comp runs the sparse loop one delta per invocation; --headless times it on the GPU\n");
+		return;
+	}
+	uint64_t gpuDeltas = 0;
+	double gpuMs = benchMorphGpu(state, mesh, weights, gpuDeltas);
+	if (gpuMs < 0.0) {
+		printf("  %-22s %10s, the queue has no timestamps\n", "morph.comp, GPU", "untimed");
+		return;
+	}
+	printf("  %-22s %10.3f %12llu %12.2f\n", "morph.comp, GPU", gpuMs, (unsigned long long)(gpuDeltas / frameCount), sparseBytes / (1024.0 * 1024.0));
+}
+
+// ─────────────────────────────────────────────
+// Profiler: cost of one PROFILE_ZONE
+// ─────────────────────────────────────────────
+static void benchProfiler(State* state) {
+	const uint32_t zoneCount = 1000000;
+	volatile uint32_t sink = 0;
+
+	double emptyMs = benchBest(5, [&] {
+		for (uint32_t i = 0; i < zoneCount; i++) sink = sink + i;
+	});
+	double zoneMs = benchBest(5, [&] {
+		for (uint32_t i = 0; i < zoneCount; i++) {
+			PROFILE_ZONE("bench");
+			sink = sink + i;
+		}
+	});
+
+#ifdef VR_ENABLE_PROFILER
+	const char* build = "VR_ENABLE_PROFILER";
+#else
+	const char* build = "profiler compiled out";
+#endif
+	printf("profiler zones, %u per run, %s\n", zoneCount, build);
+	printf("  %-22s %10.3f ms\n", "loop only", emptyMs);
+	printf("  %-22s %10.3f ms\n", "loop + zone", zoneMs);
+	printf("  %-22s %10.1f ns\n", "per zone", std::max(0.0, zoneMs - emptyMs) * 1e6 / zoneCount);
+}
+
+// ─────────────────────────────────────────────
+// Metrics: producer cost and exposition format
+// ─────────────────────────────────────────────
+// No exporter thread: the bench drains the ring itself through metricsSnapshot
+// and checks every snapshot with the same parser a scraper would apply.
+static void benchMetrics(State* state) {
+	const uint32_t frameCount = 100000;
+	const uint32_t drainEvery = METRICS_RING_SIZE / 2;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> frameMs(2.0f, 40.0f);
+	RenderStats& stats = state->renderer.stats;
+	stats.heapCount = 2;
+	stats.heapBudget[0] = 8ull << 30;
+	stats.heapBudget[1] = 16ull << 30;
+
+	std::string previousPath = state->metrics.path;
+	// Any path enables the producers; nothing is written without metricsCreate
+	state->metrics.path = "bench.prom";
+	state->metrics.start = std::chrono::steady_clock::now();
+
+	double pushMs = 0.0;
+	std::string problem;
+	std::string text;
+	for (uint32_t frame = 0; frame < frameCount; frame++) {
+		stats.cpuFrameMs[stats.historyHead] = frameMs(rng);
+		stats.historyHead = (stats.historyHead + 1) % RENDER_STATS_HISTORY;
+		stats.heapUsage[0] = (uint64_t)frame << 12;
+		auto start = BenchClock::now();
+		metricsFrame(state);
+		pushMs += elapsedMs(start);
+		if (frame % 5000 == 0) metricsLoad(state, "res/models/Fox \"copy\".glb", frameMs(rng) * 10.0);
+		if (frame % 20000 == 0) metricsSwapchainRecreate(state);
+		if ((frame + 1) % drainEvery == 0) {
+			text = metricsSnapshot(state);
+			if (problem.empty()) problem = metricsFormatCheck(text);
+		}
+	}
+	text = metricsSnapshot(state);
+	if (problem.empty()) problem = metricsFormatCheck(text);
+
+	printf("metrics export, %u frames, snapshot every %u\n", frameCount, drainEvery);
+	printf("  %-22s %10.1f ns\n", "per metricsFrame", pushMs * 1e6 / frameCount);
+	printf("  %-22s %10llu\n", "dropped samples", (unsigned long long)state->metrics.dropped.load());
+	printf("  %-22s %10zu bytes\n", "snapshot", text.size());
+	printf("  %-22s %10s %s\n", "format check", problem.empty() ? "pass" : "FAIL", problem.c_str());
+
+	state->metrics.path = previousPath;
+}
+
+// ─────────────────────────────────────────────
+// Null device: CPU cost of recording, no GPU
+// ─────────────────────────────────────────────
+// Stand-ins for objects the null device never looks inside
+template <typename T>
+static T benchHandle(uint64_t value) {
+	return (T)(uintptr_t)value;
+}
+
+// A model registered under path as if loaded: meshCount meshes, the last
+// transparentCount of them transparent, every handle made up
+void benchNullModelRegister(State* state, const std::string& path, uint32_t meshCount, uint32_t transparentCount) {
+	Scene& scene = state->scene;
+	if (scene.textures.empty()) scene.textures.resize(1);
+	uint32_t baseMaterial = static_cast<uint32_t>(scene.materials.size());
+	scene.materials.resize(baseMaterial + meshCount);
+	for (uint32_t i = 0; i < meshCount; i++) {
+		scene.materials[baseMaterial + i].descriptorSet = benchHandle<VkDescriptorSet>(0x100 + i);
+		if (i >= meshCount - transparentCount) scene.materials[baseMaterial + i].alphaMode = "BLEND";
+	}
+
+	ModelHandle handle{ .index = static_cast<uint32_t>(scene.models.size()), .generation = 0 };
+	Model& model = scene.models.emplace_back();
+	model.name = path;
+	model.path = path;
+	model.refCount = 1;
+	model.baseMaterialIndex = baseMaterial;
+	model.materialCount = meshCount;
+	model.meshes.resize(meshCount);
+	for (uint32_t i = 0; i < meshCount; i++) {
+		Mesh& mesh = model.meshes[i];
+		mesh.indices.resize(3 * (64u << (i % 4)));
+		mesh.materialIndex = (int)(baseMaterial + i);
+		mesh.vertexBuffer = benchHandle<VkBuffer>(0x200 + i);
+		mesh.indexBuffer = benchHandle<VkBuffer>(0x300 + i);
+	}
+	for (uint32_t i = 0; i < meshCount; i++) {
+		model.drawItems.push_back(DrawItem{
+			.node = 0,
+			.mesh = &model.meshes[i],
+			.transparent = i >= meshCount - transparentCount,
+			.nodeMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.25f * i, 0.0f)),
+		});
+	}
+	scene.modelCache[path] = handle;
+}
+
+// Render pass, pipelines and per-frame objects commandBufferRecord needs
+static void benchNullTargetsCreate(State* state) {
+	uint32_t frames = state->config.swapchainBuffering;
+	Renderer& renderer = state->renderer;
+	renderer.renderPass = benchHandle<VkRenderPass>(0x400);
+	renderer.pipelineLayout = benchHandle<VkPipelineLayout>(0x401);
+	renderer.graphicsPipeline = benchHandle<VkPipeline>(0x402);
+	renderer.transparencyPipeline = benchHandle<VkPipeline>(0x403);
+	state->window.swapchain.imageExtent = { 1920, 1080 };
+	state->buffers.framebuffers = (VkFramebuffer*)malloc(frames * sizeof(VkFramebuffer));
+	for (uint32_t i = 0; i < frames; i++) {
+		state->buffers.framebuffers[i] = benchHandle<VkFramebuffer>(0x500 + i);
+		renderer.descriptorSets.push_back(benchHandle<VkDescriptorSet>(0x600 + i));
+		state->window.swapchain.images.push_back(benchHandle<VkImage>(0x700 + i));
+	}
+	commandBufferGet(state);
+}
+
+static void benchNullTargetsDestroy(State* state) {
+	state->context.vk.freeCommandBuffers(state->context.device, state->renderer.commandPool, state->config.swapchainBuffering, state->buffers.commandBuffer);
+	free(state->buffers.commandBuffer);
+	free(state->buffers.framebuffers);
+}
+
+// A scratch State on the null device. Headless, so the readback path stands
+// in for the GUI, which records outside the command table.
+std::unique_ptr<State> benchNullStateCreate(const State* state) {
+	auto scratch = std::make_unique<State>();
+	scratch->config.swapchainBuffering = state->config.swapchainBuffering;
+	scratch->config.headless = true;
+	nullDeviceCreate(scratch.get());
+	return scratch;
+}
+
+struct BenchRecording {
+	double recordMs = 0.0;            // per frame
+	double gatherMs = 0.0;            // transparent gather + sort, per frame
+	uint64_t draws = 0;               // per frame
+	uint64_t commands = 0;            // per frame
+	double indices = 0.0;             // per frame
+};
+
+// Records and submits frameCount frames; the device's counters cover exactly these
+static BenchRecording benchNullRecord(State* state, uint32_t frameCount) {
+	uint32_t frames = state->config.swapchainBuffering;
+	BenchRecording result;
+	for (uint32_t frame = 0; frame < frameCount; frame++) {
+		state->renderer.frameIndex = frame % frames;
+		state->renderer.imageAquiredIndex = frame % frames;
+		auto start = BenchClock::now();
+		commandBufferRecord(state);
+		result.recordMs += elapsedMs(start);
+		result.gatherMs += state->renderer.timings.gather;
+
+		VkCommandBuffer cmd = state->buffers.commandBuffer[state->renderer.frameIndex];
+		VkSubmitInfo submitInfo{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &cmd,
+		};
+		state->context.vk.queueSubmit(state->context.queue, 1, &submitInfo, VK_NULL_HANDLE);
+	}
+
+	const NullCounters& counters = nullDeviceGet(state).submitted;
+	for (uint64_t count : counters.commands) result.commands += count;
+	result.recordMs /= frameCount;
+	result.gatherMs /= frameCount;
+	result.draws = counters.commands[NULL_CMD_DRAW_INDEXED] / frameCount;
+	result.commands /= frameCount;
+	result.indices = (double)counters.indices / frameCount;
+	return result;
+}
+
+static void benchNull(State* state) {
+	const uint32_t drawCounts[] = { 1000, 10000, 100000 };
+	const uint32_t frameCount = 60;
+	const uint32_t meshCount = 8;
+	const std::string modelPath = "null://8-meshes";
+
+	printf("null device, commandBufferRecord over synthetic scenes, %u frames each\n", frameCount);
+	printf("  %-8s %10s %10s %10s %12s %10s %8s\n", "draws", "ms/frame", "ns/draw", "sort ms", "commands", "indices M", "errors");
+	for (uint32_t drawCount : drawCounts) {
+		// A model of 8 meshes, the last two transparent, on a grid so the transparent pass has something to sort
+		std::unique_ptr<State> scratch = benchNullStateCreate(state);
+		State* nullState = scratch.get();
+		benchNullModelRegister(nullState, modelPath, meshCount, 2);
+		benchNullTargetsCreate(nullState);
+		SceneGenerator generator{ .count = drawCount / meshCount, .models = { modelPath }, .spacing = 2.0f };
+		SceneDescription description;
+		sceneGenerate(generator, description);
+		sceneInstantiate(nullState, description);
+
+		BenchRecording recording = benchNullRecord(nullState, frameCount);
+		const NullDevice& device = nullDeviceGet(nullState);
+		printf("  %-8llu %10.3f %10.1f %10.3f %12llu %10.2f %8llu\n", (unsigned long long)recording.draws, recording.recordMs,
+			recording.recordMs * 1e6 / std::max<uint64_t>(recording.draws, 1), recording.gatherMs,
+			(unsigned long long)recording.commands, recording.indices / 1e6, (unsigned long long)device.errors);
+		if (device.firstError) printf("    first error: %s\n", device.firstError);
+
+		if (drawCount == drawCounts[0]) {
+			printf("    per frame:");
+			for (uint32_t command = 0; command < NULL_CMD_COUNT; command++) {
+				if (device.submitted.commands[command] == 0) continue;
+				printf(" %s %llu", nullCommandName((NullCommand)command) + 5, (unsigned long long)(device.submitted.commands[command] / frameCount));
+			}
+			printf("\n");
+		}
+
+		benchNullTargetsDestroy(nullState);
+		nullDeviceDestroy(nullState);
+	}
+
+	// The upload path: allocate, begin, copy, end, submit, wait, free per call
+	const uint32_t uploadCount = 100000;
+	std::unique_ptr<State> scratch = benchNullStateCreate(state);
+	State* nullState = scratch.get();
+	double uploadMs = benchBest(3, [&] {
+		for (uint32_t i = 0; i < uploadCount; i++) {
+			copyBuffer(nullState, benchHandle<VkBuffer>(0x800), benchHandle<VkBuffer>(0x801), 64);
+		}
+	});
+	const NullDevice& device = nullDeviceGet(nullState);
+	printf("  %-22s %10.1f ns per copyBuffer, %llu submits, %llu errors\n", "single-time uploads", uploadMs * 1e6 / uploadCount,
+		(unsigned long long)device.submits, (unsigned long long)device.errors);
+	nullDeviceDestroy(nullState);
+}
+
+// ─────────────────────────────────────────────
+// Scenes: generator presets swept on the null device
+// ─────────────────────────────────────────────
+static void benchScenes(State* state) {
+	const char* presets[] = { "grid", "clusters", "hierarchy", "materials", "transparent" };
+	const uint32_t counts[] = { 1000, 10000, 100000 };
+	const uint32_t frameCount = 30;
+	const std::string modelPath = "null://1-mesh";
+
+	printf("scene generator presets, 1-mesh model, null device, %u frames each\n", frameCount);
+	printf("  %-12s %8s %10s %10s %10s %10s %8s %8s\n", "preset", "count", "gen ms", "place ms", "ms/frame", "sort ms", "draws", "errors");
+	for (const char* preset : presets) {
+		for (uint32_t count : counts) {
+			std::unique_ptr<State> scratch = benchNullStateCreate(state);
+			State* nullState = scratch.get();
+			benchNullModelRegister(nullState, modelPath, 1, 0);
+			benchNullTargetsCreate(nullState);
+
+			SceneGenerator generator;
+			sceneGeneratorPreset(preset, count, modelPath, generator);
+			SceneDescription description;
+			auto start = BenchClock::now();
+			sceneGenerate(generator, description);
+			double generateMs = elapsedMs(start);
+			start = BenchClock::now();
+			sceneInstantiate(nullState, description);
+			double placeMs = elapsedMs(start);
+
+			BenchRecording recording = benchNullRecord(nullState, frameCount);
+			printf("  %-12s %8u %10.3f %10.3f %10.3f %10.3f %8llu %8llu\n", preset, count, generateMs, placeMs,
+				recording.recordMs, recording.gatherMs, (unsigned long long)recording.draws, (unsigned long long)nullDeviceGet(nullState).errors);
+
+			benchNullTargetsDestroy(nullState);
+			nullDeviceDestroy(nullState);
+		}
+	}
+}
+
+//Registry
+struct BenchmarkEntry {
+	const char* name;
+	const char* description;
+	void (*run)(State* state);
+};
+
+static const BenchmarkEntry benchmarks[] = {
+	{ "scene", "pointer node tree vs SoA NodeStore, 100k nodes", benchSceneStorage },
+	{ "animation", "1000 Fox.glb instances, cursors + SIMD batches vs binary search", benchAnimation },
+	{ "skinning", "Fox.glb crowd, CPU pose + joint palette per frame", benchSkinning },
+	{ "animation-scaling", "5000 animated Fox.glb instances on 1..N job threads", benchAnimationScaling },
+	{ "animation-compression", "Fox.glb clips: memory, sampling cost and error, raw vs packed", benchAnimationCompression },
+	{ "flatten", "authored glTF node hierarchy vs collapsed static transform chains", benchFlatten },
+	{ "morph", "sparse morph target deltas vs dense CPU blend, 64k vertices x 32 targets, GPU pass with --headless", benchMorph },
+	{ "vat", "Fox.glb clips baked to vertex animation textures vs 10000 skinned instances", benchVat },
+	{ "profiler", "cost of one PROFILE_ZONE, 1M zones on the main thread", benchProfiler },
+	{ "metrics", "metrics producer cost and Prometheus format check of the snapshots", benchMetrics },
+	{ "null", "commandBufferRecord on the null device, 1k/10k/100k draws, plus upload submits", benchNull },
+	{ "scenes", "scene generator presets at 1k/10k/100k instances: generate, place, record", benchScenes },
+};
+
+bool benchmarkRun(State* state, const std::string& name) {
+	for (const BenchmarkEntry& bench : benchmarks) {
+		if (name == bench.name || name == "all") {
+			printf("== %s ==\n", bench.name);
+			bench.run(state);
+			if (name != "all") return true;
+		}
+	}
+	return name == "all";
+}
+
+void benchmarkList() {
+	printf("available benchmarks:\n");
+	for (const BenchmarkEntry& bench : benchmarks) {
+		printf("  %-22s %s\n", bench.name, bench.description);
+	}
+}
@@ -1,4 +1,8 @@
 #include "headers/buffers.h"
+#include "headers/vat.h"
+#include "headers/headless.h"
+#include "headers/gpuProfiler.h"
+#include "headers/renderStats.h"
 //Utility
 uint32_t findMemoryType(State* state, VkMemoryRequirements memRequirements, VkMemoryPropertyFlags properties) {
 	VkPhysicalDeviceMemoryProperties memProperties;
@@ -38,6 +42,11 @@ void createBuffer(State* state, VkDeviceSize size, VkBufferUsageFlags usage, VkM
 	vkBindBufferMemory(state->context.device, buffer, bufferMemory, 0);
 }
 VkCommandBuffer beginSingleTimeCommands(State* state, VkCommandPool commandPool) {
+	// An open upload batch takes the commands, they go out with its one submit
+	if (state->renderer.uploadBatch.commandBuffer != VK_NULL_HANDLE) {
+		return state->renderer.uploadBatch.commandBuffer;
+	}
+
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -45,38 +54,118 @@ VkCommandBuffer beginSingleTimeCommands(State* state, VkCommandPool commandPool)
 	allocInfo.commandBufferCount = 1;
 
 	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(state->context.device, &allocInfo, &commandBuffer);
+	state->context.vk.allocateCommandBuffers(state->context.device, &allocInfo, &commandBuffer);
 
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	state->context.vk.beginCommandBuffer(commandBuffer, &beginInfo);
 
 	return commandBuffer;
 }
 void endSingleTimeCommands(State *state,VkCommandBuffer commandBuffer) {
-	vkEndCommandBuffer(commandBuffer);
+	PROFILE_FUNCTION();
+	if (commandBuffer == state->renderer.uploadBatch.commandBuffer) {
+		state->renderer.uploadBatch.recorded++;
+		return;
+	}
+	const CommandTable& vk = state->context.vk;
+	vk.endCommandBuffer(commandBuffer);
 
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
-	vkQueueSubmit(state->context.queue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(state->context.queue);
+	vk.queueSubmit(state->context.queue, 1, &submitInfo, VK_NULL_HANDLE);
+	auto waitStart = std::chrono::high_resolution_clock::now();
+	{
+		PROFILE_ZONE("vkQueueWaitIdle");
+		vk.queueWaitIdle(state->context.queue);
+	}
+	RenderStats& stats = state->renderer.stats;
+	stats.uploadWaitMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+	stats.uploads++;
+	stats.uploadsTotal++;
 
-	vkFreeCommandBuffers(state->context.device, state->renderer.commandPool, 1, &commandBuffer);
+	vk.freeCommandBuffers(state->context.device, state->renderer.commandPool, 1, &commandBuffer);
 }
 void copyBuffer(State* state, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+	PROFILE_FUNCTION();
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands(state, state->renderer.commandPool);
 
 	VkBufferCopy copyRegion{};
 	copyRegion.size = size;
-	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+	state->context.vk.cmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
 	endSingleTimeCommands(state, commandBuffer);
 };
+// Staging buffers read by an open batch live until its fence signals
+void stagingBufferRelease(State* state, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size) {
+	UploadBatch& batch = state->renderer.uploadBatch;
+	if (batch.commandBuffer != VK_NULL_HANDLE) {
+		batch.staging.push_back({ buffer, memory });
+		batch.stagingBytes += size;
+		return;
+	}
+	vkDestroyBuffer(state->context.device, buffer, nullptr);
+	vkFreeMemory(state->context.device, memory, nullptr);
+}
+void uploadBatchBegin(State* state) {
+	UploadBatch& batch = state->renderer.uploadBatch;
+	if (batch.commandBuffer != VK_NULL_HANDLE) {
+		throw std::runtime_error("upload batch already open!");
+	}
+	batch.commandBuffer = beginSingleTimeCommands(state, state->renderer.commandPool);
+	batch.recorded = 0;
+	batch.stagingBytes = 0;
+}
+// One submit and one fence wait for everything recorded since uploadBatchBegin
+void uploadBatchSubmit(State* state) {
+	PROFILE_FUNCTION();
+	UploadBatch& batch = state->renderer.uploadBatch;
+	if (batch.commandBuffer == VK_NULL_HANDLE) return;
+	const CommandTable& vk = state->context.vk;
+	VkCommandBuffer commandBuffer = batch.commandBuffer;
+	batch.commandBuffer = VK_NULL_HANDLE;
+	vk.endCommandBuffer(commandBuffer);
+
+	if (batch.recorded > 0) {
+		VkFenceCreateInfo fenceInfo{
+			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		};
+		PANIC(vkCreateFence(state->context.device, &fenceInfo, nullptr, &batch.fence), "Failed To Create Upload Fence");
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		PANIC(vk.queueSubmit(state->context.queue, 1, &submitInfo, batch.fence), "Failed To Submit Upload Batch");
+
+		auto waitStart = std::chrono::high_resolution_clock::now();
+		{
+			PROFILE_ZONE("vkWaitForFences");
+			PANIC(vkWaitForFences(state->context.device, 1, &batch.fence, VK_TRUE, UINT64_MAX), "Failed To Wait For Upload Fence");
+		}
+		RenderStats& stats = state->renderer.stats;
+		stats.uploadWaitMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+		stats.uploads++;
+		stats.uploadsTotal++;
+
+		vkDestroyFence(state->context.device, batch.fence, nullptr);
+		batch.fence = VK_NULL_HANDLE;
+	}
+	vk.freeCommandBuffers(state->context.device, state->renderer.commandPool, 1, &commandBuffer);
+
+	for (const auto& [buffer, memory] : batch.staging) {
+		vkDestroyBuffer(state->context.device, buffer, nullptr);
+		vkFreeMemory(state->context.device, memory, nullptr);
+	}
+	batch.staging.clear();
+	batch.stagingBytes = 0;
+	batch.recorded = 0;
+}
 
 void frameBuffersCreate(State* state) {
 	uint32_t frameBufferCount = state->window.swapchain.imageCount;
@@ -130,8 +219,9 @@ void vertexBufferCreateForMesh(State* state, const std::vector<Vertex>& vertices
 	memcpy(data, vertices.data(), (size_t)bufferSize);
 	vkUnmapMemory(state->context.device, stagingBufferMemory);
 
+	// TRANSFER_SRC: morphed instances start every blend from a copy of it
 	createBuffer(state, bufferSize,
-		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 		vertexBuffer, vertexMemory);
 
@@ -175,6 +265,31 @@ void indexBufferCreateForMesh(State* state, const std::vector<uint32_t>& indices
 	vkFreeMemory(state->context.device, stagingBufferMemory, nullptr);
 }
 
+// Device-local, read-only storage buffer filled once through a staging copy
+void storageBufferCreate(State* state, const void* contents, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) {
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	createBuffer(state, size,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		stagingBuffer, stagingBufferMemory);
+
+	void* data;
+	vkMapMemory(state->context.device, stagingBufferMemory, 0, size, 0, &data);
+	memcpy(data, contents, (size_t)size);
+	vkUnmapMemory(state->context.device, stagingBufferMemory);
+
+	createBuffer(state, size,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		buffer, memory);
+
+	copyBuffer(state, stagingBuffer, buffer, size);
+
+	vkDestroyBuffer(state->context.device, stagingBuffer, nullptr);
+	vkFreeMemory(state->context.device, stagingBufferMemory, nullptr);
+}
+
 void indexBufferDestroy(State* state) {
 	vkDestroyBuffer(state->context.device, state->buffers.indexBuffer, nullptr);
 	vkFreeMemory(state->context.device, state->buffers.indexBufferMemory, nullptr);
@@ -216,6 +331,7 @@ void uniformBuffersCreate(State* state) {
 }
 
 void uniformBuffersUpdate(State* state) {
+	PROFILE_FUNCTION();
 	static auto startTime = std::chrono::high_resolution_clock::now();
 	auto currentTime = std::chrono::high_resolution_clock::now();
 	float time = std::chrono::duration<float>(currentTime - startTime).count();
@@ -229,24 +345,21 @@ void uniformBuffersUpdate(State* state) {
 	glm::mat4 proj = state->scene.camera.getProjectionMatrix(aspect, 0.1f, 20.0f);
 	proj[1][1] *= -1.0f; // Vulkan Y flip
 
+	// Animation detail follows how large each instance is on screen
+	animationLodSelect(state, proj * view, state->scene.camera.getPosition(), std::fabs(proj[1][1]));
+
 	// Global UBO (model is identity; node transforms come from push constants)
 	UniformBufferObject ubo{};
 	ubo.model = glm::mat4(1.0f);
 	ubo.view = view;
 	ubo.proj = proj;
 
-	// Lights
-	ubo.lightPositions[0] = glm::vec4(5.0f, 5.0f, 0.0f, 0.0f);
-	ubo.lightColors[0] = glm::vec4(300.0f, 300.0f, 300.0f, 1.0f);
-
-	ubo.lightPositions[1] = glm::vec4(0.0f, 5.0f, 5.0f, 0.0f);
-	ubo.lightColors[1] = glm::vec4(0.0f, 0.0f, 300.0f, 1.0f);
-
-	ubo.lightPositions[2] = glm::vec4(5.0f, 0.0f, 5.0f, 0.0f);
-	ubo.lightColors[2] = glm::vec4(300.0f, 0.0f, 0.0f, 1.0f);
-
-	ubo.lightPositions[3] = glm::vec4(0.0f, 5.0f, 0.0f, 0.0f);
-	ubo.lightColors[3] = glm::vec4(0.0f, 300.0f, 0.0f, 1.0f);
+	// Lights, from the scene file or Scene's defaults
+	for (uint32_t i = 0; i < SCENE_LIGHTS_MAX; i++) {
+		const SceneLight& light = state->scene.lights[i];
+		ubo.lightPositions[i] = glm::vec4(light.position, light.radius);
+		ubo.lightColors[i] = glm::vec4(light.color, light.intensity);
+	}
 
 	// Camera position
 	ubo.camPos = glm::vec4(state->scene.camera.getPosition(), 1.0f);
@@ -256,6 +369,7 @@ void uniformBuffersUpdate(State* state) {
 	ubo.gamma = 1.5f;
 	ubo.prefilteredCubeMipLevels = 1.0f;
 	ubo.scaleIBLAmbient = 1.0f;
+	ubo.time = time;
 
 	// Write into the mapped global UBO buffer for this frame
 	void* data = state->renderer.uniformBuffersMapped[state->renderer.frameIndex];
@@ -278,16 +392,77 @@ void commandBufferGet(State* state) {
 		.commandBufferCount = state->config.swapchainBuffering,
 	};
 	state->buffers.commandBuffer = (VkCommandBuffer*)malloc(state->config.swapchainBuffering * sizeof(VkCommandBuffer));
-	PANIC(vkAllocateCommandBuffers(state->context.device, &allocInfo, state->buffers.commandBuffer), "Failed To Create Command Buffer");
+	PANIC(state->context.vk.allocateCommandBuffers(state->context.device, &allocInfo, state->buffers.commandBuffer), "Failed To Create Command Buffer");
 };
+// Skinned items are placed by their joints, rigid ones by the (posed) node.
+// A skinned item without a palette slot draws unskinned, so it is placed by
+// its node like a rigid mesh, which is its bind pose.
+static const glm::mat4& drawItemMatrix(const Model& model, const ModelInstance& instance, const DrawItem& item) {
+	if (item.skin >= 0 && instance.jointBase != UINT32_MAX) return item.nodeMatrix;
+	if (instance.pose.empty()) return item.skin >= 0 ? model.nodes.global[item.node] : item.nodeMatrix;
+	return instance.pose.global[item.node];
+}
+static int drawItemJointOffset(const Model& model, const ModelInstance& instance, const DrawItem& item) {
+	if (item.skin < 0 || instance.jointBase == UINT32_MAX) return -1;
+	return static_cast<int>(instance.jointBase + model.skins[item.skin].paletteOffset);
+}
+// The instance's blended copy for morphed meshes, VK_NULL_HANDLE draws the shared one
+static VkBuffer drawItemVertexBuffer(const Model& model, const ModelInstance& instance, const DrawItem& item) {
+	if (instance.morph.empty()) return VK_NULL_HANDLE;
+	return morphVertexBuffer(instance, static_cast<uint32_t>(item.mesh - model.meshes.data()));
+}
+
+// Every transparent item of every instance, sorted back-to-front
+void transparentDrawsGather(State* state, std::vector<TransparentDraw>& out)
+{
+	PROFILE_FUNCTION();
+	out.clear();
+	glm::vec3 camPos = state->scene.camera.getPosition();
+
+	for (const ModelInstance& instance : state->scene.instances)
+	{
+		const Model* model = modelGet(state, instance.model);
+		if (!model) continue;
+		for (const DrawItem& item : model->drawItems) {
+			if (!item.transparent && !instance.material.transparent) continue;
+			const glm::mat4& nodeMatrix = drawItemMatrix(*model, instance, item);
+			glm::vec3 worldPos = glm::vec3(instance.transform * nodeMatrix[3]);
+			out.push_back({ &item, &instance, &nodeMatrix, drawItemJointOffset(*model, instance, item),
+				drawItemVertexBuffer(*model, instance, item), glm::length(worldPos - camPos) });
+		}
+	}
+
+	std::sort(
+		out.begin(), out.end(),
+		[](const TransparentDraw& a, const TransparentDraw& b) {
+			return a.distanceToCamera > b.distanceToCamera;
+		}
+	);
+}
+
 void commandBufferRecord(State* state)
 {
+	PROFILE_FUNCTION();
+	const CommandTable& vk = state->context.vk;
 	VkCommandBuffer cmd = state->buffers.commandBuffer[state->renderer.frameIndex];
 
 	VkCommandBufferBeginInfo beginInfo{
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
 	};
-	vkBeginCommandBuffer(cmd, &beginInfo);
+	vk.beginCommandBuffer(cmd, &beginInfo);
+
+	renderStatsFrameBegin(state);
+
+	// GPU time per pass, read back once this frame slot comes around again
+	gpuProfilerFrameBegin(state, cmd);
+	uint32_t frameScope = gpuScopeBegin(state, cmd, "frame", false);
+
+	// Morph targets are blended on the GPU before anything reads the vertices
+	if (state->renderer.morphPipeline != VK_NULL_HANDLE) {
+		uint32_t morphScope = gpuScopeBegin(state, cmd, "morph", false);
+		morphRecord(state, cmd);
+		gpuScopeEnd(state, cmd, morphScope);
+	}
 
 	std::array<VkClearValue, 2> clearValues{};
 	clearValues[0].color = { state->config.backgroundColor.color };
@@ -305,7 +480,7 @@ void commandBufferRecord(State* state)
 		.extent = state->window.swapchain.imageExtent
 	};
 
-	vkCmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vk.cmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
 	VkViewport viewport{
 		.x = 0.0f,
@@ -315,16 +490,16 @@ void commandBufferRecord(State* state)
 		.minDepth = 0.0f,
 		.maxDepth = 1.0f,
 	};
-	vkCmdSetViewport(cmd, 0, 1, &viewport);
+	vk.cmdSetViewport(cmd, 0, 1, &viewport);
 
 	VkRect2D scissor{
 		.offset = { 0, 0 },
 		.extent = state->window.swapchain.imageExtent,
 	};
-	vkCmdSetScissor(cmd, 0, 1, &scissor);
+	vk.cmdSetScissor(cmd, 0, 1, &scissor);
 
 	// Bind global UBO (set = 0)
-	vkCmdBindDescriptorSets(
+	vk.cmdBindDescriptorSets(
 		cmd,
 		VK_PIPELINE_BIND_POINT_GRAPHICS,
 		state->renderer.pipelineLayout,
@@ -334,85 +509,54 @@ void commandBufferRecord(State* state)
 		0,
 		nullptr
 	);
+	state->renderer.stats.descriptorBinds++;
 
 	// ─────────────────────────────────────────────
-	// Per-model loop
+	// Opaque: every instance replays its asset's draw list
 	// ─────────────────────────────────────────────
-	for (Model& model : state->scene.models)
+	uint32_t opaqueScope = gpuScopeBegin(state, cmd, "opaque");
+	vk.cmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, state->renderer.graphicsPipeline);
+	state->renderer.stats.pipelineBinds++;
+	for (const ModelInstance& instance : state->scene.instances)
 	{
-		// 1. Update UBO with per-model transform
-		UniformBufferObject ubo =
-			*reinterpret_cast<UniformBufferObject*>(
-				state->renderer.uniformBuffersMapped[state->renderer.frameIndex]
-				);
-
-		ubo.model = model.transform;   // per-model matrix
-
-		memcpy(
-			state->renderer.uniformBuffersMapped[state->renderer.frameIndex],
-			&ubo,
-			sizeof(UniformBufferObject)
-		);
-
-		// 2. Gather draw items for THIS model
-		std::vector<DrawItem> items;
-		gatherDrawItems(
-			model.rootNode,
-			state->scene.camera.getPosition(),
-			state->scene.materials,
-			items
-		);
-
-		// 3. Split opaque / transparent (local vectors)
-		std::vector<DrawItem> opaqueItems;
-		std::vector<DrawItem> transparentItems;
-
-		for (const DrawItem& item : items) {
-			if (item.transparent)
-				transparentItems.push_back(item);
-			else
-				opaqueItems.push_back(item);
+		const Model* model = modelGet(state, instance.model);
+		if (!model) continue;
+		for (const DrawItem& item : model->drawItems) {
+			if (item.transparent || instance.material.transparent) continue;
+			drawMesh(state, cmd, *item.mesh, drawItemMatrix(*model, instance, item), instance.transform, drawItemJointOffset(*model, instance, item),
+				-1, 1, drawItemVertexBuffer(*model, instance, item), &instance.material);
 		}
+	}
+	vatCrowdDraw(state, cmd);
+	gpuScopeEnd(state, cmd, opaqueScope);
 
-		// 4. Draw opaque with main pipeline
-		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, state->renderer.graphicsPipeline);
-		for (const DrawItem& item : opaqueItems) {
-			glm::mat4 nodeMatrix = item.node->getGlobalMatrix();
-			drawMesh(
-				state,
-				cmd,
-				*item.mesh,
-				item.node->getGlobalMatrix(),
-				model.transform
-			);
-		}
-
-		// 5. Sort transparent back-to-front
-		std::sort(
-			transparentItems.begin(), transparentItems.end(),
-			[](const DrawItem& a, const DrawItem& b) {
-				return a.distanceToCamera > b.distanceToCamera;
-			}
-		);
-
-		// 6. Draw transparent with transparency pipeline
-		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, state->renderer.transparencyPipeline);
-		for (const DrawItem& item : transparentItems) {
-			glm::mat4 nodeMatrix = item.node->getGlobalMatrix();
-			drawMesh(
-				state,
-				cmd,
-				*item.mesh,
-				item.node->getGlobalMatrix(),
-				model.transform
-			);
-		}
+	// ─────────────────────────────────────────────
+	// Transparent: gathered across instances, sorted back-to-front
+	// ─────────────────────────────────────────────
+	auto gatherStart = std::chrono::high_resolution_clock::now();
+	std::vector<TransparentDraw> transparentDraws;
+	transparentDrawsGather(state, transparentDraws);
+	state->renderer.timings.gather = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - gatherStart).count();
+
+	uint32_t transparentScope = gpuScopeBegin(state, cmd, "transparent");
+	vk.cmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, state->renderer.transparencyPipeline);
+	state->renderer.stats.pipelineBinds++;
+	for (const TransparentDraw& draw : transparentDraws) {
+		drawMesh(state, cmd, *draw.item->mesh, *draw.nodeMatrix, draw.instance->transform, draw.jointOffset, -1, 1, draw.vertexBuffer,
+			&draw.instance->material);
 	}
+	gpuScopeEnd(state, cmd, transparentScope);
 
-	vkCmdEndRenderPass(cmd);
+	vk.cmdEndRenderPass(cmd);
 
-	guiDraw(state, cmd);
+	uint32_t overlayScope = gpuScopeBegin(state, cmd, state->config.headless ? "readback" : "gui");
+	if (state->config.headless)
+		headlessReadbackRecord(state, cmd);
+	else
+		guiDraw(state, cmd);
+	gpuScopeEnd(state, cmd, overlayScope);
 
-	PANIC(vkEndCommandBuffer(cmd), "Failed To Record Command Buffer");
+	gpuScopeEnd(state, cmd, frameScope);
+	PANIC(vk.endCommandBuffer(cmd), "Failed To Record Command Buffer");
 }
 
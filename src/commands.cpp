@@ -0,0 +1,319 @@
+#include "headers/commands.h"
+
+static const char* NULL_COMMAND_NAMES[NULL_CMD_COUNT] = {
+	"vkCmdBeginRenderPass",
+	"vkCmdEndRenderPass",
+	"vkCmdSetViewport",
+	"vkCmdSetScissor",
+	"vkCmdBindPipeline",
+	"vkCmdBindDescriptorSets",
+	"vkCmdPushConstants",
+	"vkCmdBindVertexBuffers",
+	"vkCmdBindIndexBuffer",
+	"vkCmdDrawIndexed",
+	"vkCmdDispatch",
+	"vkCmdPipelineBarrier",
+	"vkCmdCopyBuffer",
+	"vkCmdCopyBufferToImage",
+	"vkCmdCopyImageToBuffer",
+	"vkCmdBlitImage",
+	"vkCmdResetQueryPool",
+	"vkCmdWriteTimestamp",
+	"vkCmdBeginQuery",
+	"vkCmdEndQuery",
+};
+
+// The smallest maxPushConstantsSize a device may report
+static constexpr uint32_t NULL_PUSH_CONSTANTS_MAX = 128;
+
+//Validation
+static NullCommandBuffer& nullBuffer(VkCommandBuffer cmd) {
+	return *reinterpret_cast<NullCommandBuffer*>(cmd);
+}
+
+static void nullError(NullCommandBuffer& buffer, const char* message) {
+	if (buffer.counters.errors++ == 0) buffer.counters.firstError = message;
+	if (buffer.device->errors++ == 0) buffer.device->firstError = message;
+}
+
+// Every command is counted, and only legal between begin and end
+static NullCommandBuffer& nullRecord(VkCommandBuffer cmd, NullCommand command) {
+	NullCommandBuffer& buffer = nullBuffer(cmd);
+	buffer.counters.commands[command]++;
+	if (!buffer.recording) nullError(buffer, "command recorded outside begin/end");
+	return buffer;
+}
+
+// Transfers, barriers and query resets: the render pass has no self-dependency
+static NullCommandBuffer& nullRecordOutsidePass(VkCommandBuffer cmd, NullCommand command) {
+	NullCommandBuffer& buffer = nullRecord(cmd, command);
+	if (buffer.inRenderPass) nullError(buffer, "transfer, barrier or query reset inside a render pass");
+	return buffer;
+}
+
+static void nullCountersAdd(NullCounters& total, const NullCounters& counters) {
+	for (uint32_t i = 0; i < NULL_CMD_COUNT; i++) total.commands[i] += counters.commands[i];
+	total.indices += counters.indices;
+	total.workgroups += counters.workgroups;
+	total.pushConstantBytes += counters.pushConstantBytes;
+	total.errors += counters.errors;
+	if (!total.firstError) total.firstError = counters.firstError;
+}
+
+//Command buffers
+static VKAPI_ATTR VkResult VKAPI_CALL nullAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers) {
+	NullDevice* nullDevice = reinterpret_cast<NullDevice*>(device);
+	for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++) {
+		pCommandBuffers[i] = reinterpret_cast<VkCommandBuffer>(new NullCommandBuffer{ .device = nullDevice });
+	}
+	nullDevice->commandBuffersLive += pAllocateInfo->commandBufferCount;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullFreeCommandBuffers(VkDevice device, VkCommandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers) {
+	NullDevice* nullDevice = reinterpret_cast<NullDevice*>(device);
+	for (uint32_t i = 0; i < commandBufferCount; i++) {
+		if (pCommandBuffers[i] == VK_NULL_HANDLE) continue;
+		delete &nullBuffer(pCommandBuffers[i]);
+		nullDevice->commandBuffersLive--;
+	}
+}
+
+// Begin implicitly resets, as with RESET_COMMAND_BUFFER_BIT pools
+static VKAPI_ATTR VkResult VKAPI_CALL nullBeginCommandBuffer(VkCommandBuffer cmd, const VkCommandBufferBeginInfo*) {
+	NullCommandBuffer& buffer = nullBuffer(cmd);
+	if (buffer.recording) nullError(buffer, "begin on a buffer already recording");
+	buffer = NullCommandBuffer{ .device = buffer.device };
+	buffer.recording = true;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL nullEndCommandBuffer(VkCommandBuffer cmd) {
+	NullCommandBuffer& buffer = nullBuffer(cmd);
+	if (!buffer.recording) nullError(buffer, "end on a buffer not recording");
+	if (buffer.inRenderPass) nullError(buffer, "end inside a render pass");
+	if (buffer.activeQueries > 0) nullError(buffer, "end with a query still active");
+	buffer.recording = false;
+	return VK_SUCCESS;
+}
+
+//Queue
+static VKAPI_ATTR VkResult VKAPI_CALL nullQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence) {
+	NullDevice* nullDevice = reinterpret_cast<NullDevice*>(queue);
+	for (uint32_t i = 0; i < submitCount; i++) {
+		for (uint32_t j = 0; j < pSubmits[i].commandBufferCount; j++) {
+			NullCommandBuffer& buffer = nullBuffer(pSubmits[i].pCommandBuffers[j]);
+			if (buffer.recording) nullError(buffer, "submitted while still recording");
+			nullCountersAdd(nullDevice->submitted, buffer.counters);
+		}
+		nullDevice->submits++;
+	}
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL nullQueueWaitIdle(VkQueue) {
+	return VK_SUCCESS;
+}
+
+//Render pass
+static VKAPI_ATTR void VKAPI_CALL nullCmdBeginRenderPass(VkCommandBuffer cmd, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_BEGIN_RENDER_PASS);
+	if (buffer.inRenderPass) nullError(buffer, "render pass begun inside another");
+	if (pRenderPassBegin->renderPass == VK_NULL_HANDLE || pRenderPassBegin->framebuffer == VK_NULL_HANDLE)
+		nullError(buffer, "render pass begun without a render pass or framebuffer");
+	buffer.inRenderPass = true;
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdEndRenderPass(VkCommandBuffer cmd) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_END_RENDER_PASS);
+	if (!buffer.inRenderPass) nullError(buffer, "render pass ended without one begun");
+	buffer.inRenderPass = false;
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdSetViewport(VkCommandBuffer cmd, uint32_t, uint32_t viewportCount, const VkViewport* pViewports) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_SET_VIEWPORT);
+	for (uint32_t i = 0; i < viewportCount; i++) {
+		if (pViewports[i].width <= 0.0f) nullError(buffer, "viewport without a width");
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdSetScissor(VkCommandBuffer cmd, uint32_t, uint32_t, const VkRect2D*) {
+	nullRecord(cmd, NULL_CMD_SET_SCISSOR);
+}
+
+//Bindings
+static VKAPI_ATTR void VKAPI_CALL nullCmdBindPipeline(VkCommandBuffer cmd, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_BIND_PIPELINE);
+	if (pipeline == VK_NULL_HANDLE) nullError(buffer, "null pipeline bound");
+	if (pipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE)
+		buffer.computePipeline = pipeline;
+	else
+		buffer.graphicsPipeline = pipeline;
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdBindDescriptorSets(VkCommandBuffer cmd, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout,
+	uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t, const uint32_t*) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_BIND_DESCRIPTOR_SETS);
+	if (layout == VK_NULL_HANDLE) nullError(buffer, "descriptor sets bound without a layout");
+	uint32_t& bound = pipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ? buffer.computeSets : buffer.graphicsSets;
+	for (uint32_t i = 0; i < descriptorSetCount; i++) {
+		if (pDescriptorSets[i] == VK_NULL_HANDLE) nullError(buffer, "null descriptor set bound");
+		bound |= 1u << (firstSet + i);
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdPushConstants(VkCommandBuffer cmd, VkPipelineLayout layout, VkShaderStageFlags stageFlags,
+	uint32_t offset, uint32_t size, const void*) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_PUSH_CONSTANTS);
+	if (layout == VK_NULL_HANDLE || stageFlags == 0) nullError(buffer, "push constants without a layout or stages");
+	if (offset % 4 != 0 || size % 4 != 0) nullError(buffer, "push constant range not a multiple of 4");
+	if (offset + size > NULL_PUSH_CONSTANTS_MAX) nullError(buffer, "push constants past the 128 bytes every device has");
+	buffer.counters.pushConstantBytes += size;
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdBindVertexBuffers(VkCommandBuffer cmd, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize*) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_BIND_VERTEX_BUFFERS);
+	for (uint32_t i = 0; i < bindingCount; i++) {
+		if (pBuffers[i] == VK_NULL_HANDLE) nullError(buffer, "null vertex buffer bound");
+		buffer.vertexBindings |= 1u << (firstBinding + i);
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdBindIndexBuffer(VkCommandBuffer cmd, VkBuffer indexBuffer, VkDeviceSize, VkIndexType) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_BIND_INDEX_BUFFER);
+	if (indexBuffer == VK_NULL_HANDLE) nullError(buffer, "null index buffer bound");
+	buffer.indexBound = true;
+}
+
+//Work
+static VKAPI_ATTR void VKAPI_CALL nullCmdDrawIndexed(VkCommandBuffer cmd, uint32_t indexCount, uint32_t instanceCount, uint32_t, int32_t, uint32_t) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_DRAW_INDEXED);
+	if (!buffer.inRenderPass) nullError(buffer, "draw outside a render pass");
+	if (buffer.graphicsPipeline == VK_NULL_HANDLE) nullError(buffer, "draw without a graphics pipeline");
+	if (!buffer.indexBound) nullError(buffer, "indexed draw without an index buffer");
+	if (!(buffer.vertexBindings & 1u)) nullError(buffer, "draw without vertex binding 0");
+	if (!(buffer.graphicsSets & 1u)) nullError(buffer, "draw without descriptor set 0");
+	buffer.counters.indices += (uint64_t)indexCount * instanceCount;
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdDispatch(VkCommandBuffer cmd, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_DISPATCH);
+	if (buffer.inRenderPass) nullError(buffer, "dispatch inside a render pass");
+	if (buffer.computePipeline == VK_NULL_HANDLE) nullError(buffer, "dispatch without a compute pipeline");
+	if (!(buffer.computeSets & 1u)) nullError(buffer, "dispatch without descriptor set 0");
+	buffer.counters.workgroups += (uint64_t)groupCountX * groupCountY * groupCountZ;
+}
+
+//Transfers
+static VKAPI_ATTR void VKAPI_CALL nullCmdPipelineBarrier(VkCommandBuffer cmd, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask,
+	VkDependencyFlags, uint32_t, const VkMemoryBarrier*, uint32_t, const VkBufferMemoryBarrier*, uint32_t, const VkImageMemoryBarrier*) {
+	NullCommandBuffer& buffer = nullRecordOutsidePass(cmd, NULL_CMD_PIPELINE_BARRIER);
+	if (srcStageMask == 0 || dstStageMask == 0) nullError(buffer, "barrier with an empty stage mask");
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdCopyBuffer(VkCommandBuffer cmd, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* pRegions) {
+	NullCommandBuffer& buffer = nullRecordOutsidePass(cmd, NULL_CMD_COPY_BUFFER);
+	if (srcBuffer == VK_NULL_HANDLE || dstBuffer == VK_NULL_HANDLE) nullError(buffer, "buffer copy with a null buffer");
+	for (uint32_t i = 0; i < regionCount; i++) {
+		if (pRegions[i].size == 0) nullError(buffer, "buffer copy of zero bytes");
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdCopyBufferToImage(VkCommandBuffer cmd, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout, uint32_t regionCount, const VkBufferImageCopy*) {
+	NullCommandBuffer& buffer = nullRecordOutsidePass(cmd, NULL_CMD_COPY_BUFFER_TO_IMAGE);
+	if (srcBuffer == VK_NULL_HANDLE || dstImage == VK_NULL_HANDLE || regionCount == 0) nullError(buffer, "image upload without a source, target or region");
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdCopyImageToBuffer(VkCommandBuffer cmd, VkImage srcImage, VkImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy*) {
+	NullCommandBuffer& buffer = nullRecordOutsidePass(cmd, NULL_CMD_COPY_IMAGE_TO_BUFFER);
+	if (srcImage == VK_NULL_HANDLE || dstBuffer == VK_NULL_HANDLE || regionCount == 0) nullError(buffer, "image readback without a source, target or region");
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdBlitImage(VkCommandBuffer cmd, VkImage srcImage, VkImageLayout, VkImage dstImage, VkImageLayout,
+	uint32_t regionCount, const VkImageBlit*, VkFilter) {
+	NullCommandBuffer& buffer = nullRecordOutsidePass(cmd, NULL_CMD_BLIT_IMAGE);
+	if (srcImage == VK_NULL_HANDLE || dstImage == VK_NULL_HANDLE || regionCount == 0) nullError(buffer, "blit without a source, target or region");
+}
+
+//Queries
+static VKAPI_ATTR void VKAPI_CALL nullCmdResetQueryPool(VkCommandBuffer cmd, VkQueryPool queryPool, uint32_t, uint32_t) {
+	NullCommandBuffer& buffer = nullRecordOutsidePass(cmd, NULL_CMD_RESET_QUERY_POOL);
+	if (queryPool == VK_NULL_HANDLE) nullError(buffer, "null query pool reset");
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdWriteTimestamp(VkCommandBuffer cmd, VkPipelineStageFlagBits, VkQueryPool queryPool, uint32_t) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_WRITE_TIMESTAMP);
+	if (queryPool == VK_NULL_HANDLE) nullError(buffer, "timestamp written to a null query pool");
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdBeginQuery(VkCommandBuffer cmd, VkQueryPool queryPool, uint32_t, VkQueryControlFlags) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_BEGIN_QUERY);
+	if (queryPool == VK_NULL_HANDLE) nullError(buffer, "query begun on a null query pool");
+	buffer.activeQueries++;
+}
+
+static VKAPI_ATTR void VKAPI_CALL nullCmdEndQuery(VkCommandBuffer cmd, VkQueryPool, uint32_t) {
+	NullCommandBuffer& buffer = nullRecord(cmd, NULL_CMD_END_QUERY);
+	if (buffer.activeQueries == 0) nullError(buffer, "query ended without one begun");
+	else buffer.activeQueries--;
+}
+
+//Null device
+void nullDeviceCreate(State* state) {
+	Context& context = state->context;
+	NullDevice* device = new NullDevice{};
+	context.device = reinterpret_cast<VkDevice>(device);
+	context.queue = reinterpret_cast<VkQueue>(device);
+	context.vk = CommandTable{
+		.allocateCommandBuffers = nullAllocateCommandBuffers,
+		.freeCommandBuffers = nullFreeCommandBuffers,
+		.beginCommandBuffer = nullBeginCommandBuffer,
+		.endCommandBuffer = nullEndCommandBuffer,
+		.queueSubmit = nullQueueSubmit,
+		.queueWaitIdle = nullQueueWaitIdle,
+		.cmdBeginRenderPass = nullCmdBeginRenderPass,
+		.cmdEndRenderPass = nullCmdEndRenderPass,
+		.cmdSetViewport = nullCmdSetViewport,
+		.cmdSetScissor = nullCmdSetScissor,
+		.cmdBindPipeline = nullCmdBindPipeline,
+		.cmdBindDescriptorSets = nullCmdBindDescriptorSets,
+		.cmdPushConstants = nullCmdPushConstants,
+		.cmdBindVertexBuffers = nullCmdBindVertexBuffers,
+		.cmdBindIndexBuffer = nullCmdBindIndexBuffer,
+		.cmdDrawIndexed = nullCmdDrawIndexed,
+		.cmdDispatch = nullCmdDispatch,
+		.cmdPipelineBarrier = nullCmdPipelineBarrier,
+		.cmdCopyBuffer = nullCmdCopyBuffer,
+		.cmdCopyBufferToImage = nullCmdCopyBufferToImage,
+		.cmdCopyImageToBuffer = nullCmdCopyImageToBuffer,
+		.cmdBlitImage = nullCmdBlitImage,
+		.cmdResetQueryPool = nullCmdResetQueryPool,
+		.cmdWriteTimestamp = nullCmdWriteTimestamp,
+		.cmdBeginQuery = nullCmdBeginQuery,
+		.cmdEndQuery = nullCmdEndQuery,
+	};
+}
+
+void nullDeviceDestroy(State* state) {
+	Context& context = state->context;
+	const NullDevice& device = nullDeviceGet(state);
+	if (device.commandBuffersLive > 0) {
+		fprintf(stderr, "null device: %llu command buffers never freed\n", (unsigned long long)device.commandBuffersLive);
+	}
+	delete &device;
+	context.device = VK_NULL_HANDLE;
+	context.queue = VK_NULL_HANDLE;
+	context.vk = CommandTable{};
+}
+
+const NullDevice& nullDeviceGet(const State* state) {
+	return *reinterpret_cast<const NullDevice*>(state->context.device);
+}
+
+const NullCommandBuffer& nullCommandBufferGet(VkCommandBuffer cmd) {
+	return nullBuffer(cmd);
+}
+
+const char* nullCommandName(NullCommand command) {
+	return command < NULL_CMD_COUNT ? NULL_COMMAND_NAMES[command] : "unknown";
+}
@@ -1,8 +1,39 @@
 #include "headers/context.h"
 
+//Utility
+static bool instanceExtensionAvailable(const char* name) {
+	uint32_t count = 0;
+	vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr);
+	std::vector<VkExtensionProperties> extensions(count);
+	vkEnumerateInstanceExtensionProperties(nullptr, &count, extensions.data());
+	for (const VkExtensionProperties& extension : extensions) {
+		if (strcmp(extension.extensionName, name) == 0) return true;
+	}
+	return false;
+}
+
+static bool deviceExtensionAvailable(VkPhysicalDevice device, const char* name) {
+	uint32_t count = 0;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+	std::vector<VkExtensionProperties> extensions(count);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &count, extensions.data());
+	for (const VkExtensionProperties& extension : extensions) {
+		if (strcmp(extension.extensionName, name) == 0) return true;
+	}
+	return false;
+}
+
 void instanceCreate(State* state) {
-	uint32_t glfwExtensionCount;
-	const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	// Headless runs never initialize GLFW and need no surface extensions
+	uint32_t glfwExtensionCount = 0;
+	const char** glfwExtensions = state->config.headless ? nullptr : glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	std::vector<const char*> instanceExtensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+
+	// Memory budget queries go through the properties2 entry points, an extension on 1.0
+	bool properties2 = instanceExtensionAvailable(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	if (properties2) {
+		instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	}
 	VkApplicationInfo appInfo{
 		.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
 		.pApplicationName = state->config.windowTitle,
@@ -14,10 +45,13 @@ void instanceCreate(State* state) {
 	VkInstanceCreateInfo instanceCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
 		.pApplicationInfo = &appInfo,
-		.enabledExtensionCount = glfwExtensionCount,
-		.ppEnabledExtensionNames = glfwExtensions,
+		.enabledExtensionCount = static_cast<uint32_t>(instanceExtensions.size()),
+		.ppEnabledExtensionNames = instanceExtensions.data(),
 	};
 	PANIC(vkCreateInstance(&instanceCreateInfo, nullptr, &state->context.instance), "Failed To Create Instance");
+	state->context.getMemoryProperties2 = properties2
+		? (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(state->context.instance, "vkGetPhysicalDeviceMemoryProperties2KHR")
+		: nullptr;
 };
 void instanceDestroy(State* state) {
 	vkDestroyInstance(state->context.instance, nullptr);
@@ -67,7 +101,7 @@ void queueFamilySelect(State* state) {
 
 	for (uint32_t queueFamilyIndex = 0; queueFamilyIndex < count; queueFamilyIndex++) {
 		VkQueueFamilyProperties properties = queueFamilies[queueFamilyIndex];
-		if ((properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) && glfwGetPhysicalDevicePresentationSupport(state->context.instance, state->context.physicalDevice, queueFamilyIndex)) {
+		if ((properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (state->config.headless || glfwGetPhysicalDevicePresentationSupport(state->context.instance, state->context.physicalDevice, queueFamilyIndex))) {
 			state->context.queueFamilyIndex = queueFamilyIndex;
 			break;
 		};
@@ -88,23 +122,55 @@ void deviceCreate(State* state) {
 	};
 	VkDeviceQueueCreateInfo deviceQueueInfos[]{ {} };
 
-	const char* deviceExtensions{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+	std::vector<const char*> deviceExtensions;
+	if (!state->config.headless) {
+		deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
+	state->context.memoryBudget = state->context.getMemoryProperties2 != nullptr &&
+		deviceExtensionAvailable(state->context.physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	if (state->context.memoryBudget) {
+		deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(state->context.physicalDevice, &supportedFeatures);
+	state->context.textureCompressionBC = supportedFeatures.textureCompressionBC;
+	state->context.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+	state->context.textureCompressionASTC = supportedFeatures.textureCompressionASTC_LDR;
+	state->context.pipelineStatisticsQuery = state->config.gpuStatistics && supportedFeatures.pipelineStatisticsQuery;
+	if (state->config.gpuStatistics && !supportedFeatures.pipelineStatisticsQuery) {
+		printf("gpu profiler: pipeline statistics queries not supported, timestamps only\n");
+	}
+
 	VkPhysicalDeviceFeatures deviceFeatures{
 		.sampleRateShading = VK_TRUE,
 		.samplerAnisotropy = VK_TRUE,
+		.textureCompressionETC2 = supportedFeatures.textureCompressionETC2,
+		.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR,
+		.textureCompressionBC = supportedFeatures.textureCompressionBC,
+		.pipelineStatisticsQuery = state->context.pipelineStatisticsQuery,
 	};
 	VkDeviceCreateInfo deviceInfo{
 		.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
 		.queueCreateInfoCount = 1,
 		.pQueueCreateInfos = &deviceQueueInfo,
-		.enabledExtensionCount = 1,
-		.ppEnabledExtensionNames = &deviceExtensions,
+		.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
+		.ppEnabledExtensionNames = deviceExtensions.data(),
 		.pEnabledFeatures = &deviceFeatures,
 	};
 	PANIC(vkCreateDevice(state->context.physicalDevice, &deviceInfo, nullptr, &state->context.device), "Failed To Create Device");
 	vkGetDeviceQueue(state->context.device, state->context.queueFamilyIndex, 0, &state->context.queue);
 	vkGetDeviceQueue(state->context.device, state->context.presentFamilyIndex, 0, &state->context.presentQueue);
 
+	// GPU timings need timestamp support on the graphics queue
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(state->context.physicalDevice, &properties);
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(state->context.physicalDevice, &familyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> families(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(state->context.physicalDevice, &familyCount, families.data());
+	bool timestamps = families[state->context.queueFamilyIndex].timestampValidBits > 0;
+	state->context.timestampPeriod = timestamps ? properties.limits.timestampPeriod : 0.0f;
+
 };
 void deviceDestroy(State* state) {
 	vkDestroyDevice(state->context.device, nullptr);
@@ -0,0 +1,303 @@
+#include "headers/frameBench.h"
+#include "headers/window.h"
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+//Utility
+static json jsonRead(const std::string& path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open " + path);
+	}
+	return json::parse(file);
+}
+
+// { "loop": true, "keys": [ { "time": 0, "position": [x, y, z], "yaw": 90, "pitch": 0 }, ... ] }
+static void cameraPathParse(const json& camera, FrameBench& bench) {
+	bench.loop = camera.value("loop", true);
+	bench.cameraPath.clear();
+	for (const json& key : camera.at("keys")) {
+		const json& position = key.at("position");
+		bench.cameraPath.push_back({
+			key.at("time").get<float>(),
+			glm::vec3(position.at(0).get<float>(), position.at(1).get<float>(), position.at(2).get<float>()),
+			key.value("yaw", 90.0f),
+			key.value("pitch", 0.0f),
+		});
+	}
+	std::sort(bench.cameraPath.begin(), bench.cameraPath.end(),
+		[](const CameraKey& a, const CameraKey& b) { return a.time < b.time; });
+}
+
+//Description
+// {
+//   "name": "orbit", "warmupFrames": 60, "measuredFrames": 600, "timestep": 0.016667,
+//   "threshold": 0.1, "foxInstances": 1000, "vatInstances": 0,
+//   "scene": "res/scenes/stress.json",
+//   "camera": { path object } or "path/to/recorded.json"
+// }
+void frameBenchLoad(State* state) {
+	FrameBench& bench = state->frameBench;
+	json description = jsonRead(bench.path);
+
+	bench.name = description.value("name", bench.path);
+	bench.warmupFrames = description.value("warmupFrames", bench.warmupFrames);
+	bench.measuredFrames = description.value("measuredFrames", bench.measuredFrames);
+	bench.timestep = description.value("timestep", bench.timestep);
+	bench.threshold = description.value("threshold", bench.threshold);
+	state->config.foxInstanceCount = description.value("foxInstances", state->config.foxInstanceCount);
+	state->config.vatInstanceCount = description.value("vatInstances", state->config.vatInstanceCount);
+	state->config.scenePath = description.value("scene", state->config.scenePath);
+
+	if (description.contains("camera")) {
+		const json& camera = description["camera"];
+		cameraPathParse(camera.is_string() ? jsonRead(camera.get<std::string>()) : camera, bench);
+	}
+	if (bench.cameraPath.empty()) {
+		throw std::runtime_error(bench.path + ": camera path has no keys");
+	}
+	if (bench.timestep <= 0.0f) {
+		throw std::runtime_error(bench.path + ": timestep must be positive");
+	}
+}
+
+//Camera path
+// Linear between keys; yaw is not wrapped, so a path turns the way its keys are written
+void cameraPathSample(const std::vector<CameraKey>& path, bool loop, float time, Camera& camera) {
+	if (path.empty()) return;
+
+	float start = path.front().time;
+	float end = path.back().time;
+	if (loop && end > start) {
+		time = start + std::fmod(std::max(time - start, 0.0f), end - start);
+	}
+	time = std::clamp(time, start, end);
+
+	size_t k = 0;
+	while (k + 2 < path.size() && path[k + 1].time <= time) k++;
+	const CameraKey& a = path[k];
+	const CameraKey& b = path[std::min(k + 1, path.size() - 1)];
+	float t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0f;
+
+	camera.position = glm::mix(a.position, b.position, t);
+	camera.yaw = glm::mix(a.yaw, b.yaw, t);
+	camera.pitch = glm::mix(a.pitch, b.pitch, t);
+	camera.updateCameraVectors();
+}
+
+// Keys are sampled from the interactive camera at a fixed interval
+static constexpr float RECORD_INTERVAL = 0.25f;
+
+void cameraPathRecord(State* state, float deltaTime) {
+	FrameBench& bench = state->frameBench;
+	if (bench.recordPath.empty()) return;
+
+	const Camera& camera = state->scene.camera;
+	if (bench.recording.empty() || bench.recordClock - bench.recording.back().time >= RECORD_INTERVAL) {
+		bench.recording.push_back({ bench.recordClock, camera.position, camera.yaw, camera.pitch });
+	}
+	bench.recordClock += deltaTime;
+}
+
+// Written in the format cameraPathParse reads, usable as a description's "camera"
+void cameraPathSave(State* state) {
+	FrameBench& bench = state->frameBench;
+	if (bench.recordPath.empty() || bench.recording.empty()) return;
+
+	json keys = json::array();
+	for (const CameraKey& key : bench.recording) {
+		keys.push_back({
+			{ "time", key.time },
+			{ "position", { key.position.x, key.position.y, key.position.z } },
+			{ "yaw", key.yaw },
+			{ "pitch", key.pitch },
+		});
+	}
+	json path = { { "loop", false }, { "keys", keys } };
+
+	std::ofstream file(bench.recordPath);
+	if (!file.is_open()) {
+		fprintf(stderr, "camera path: cannot write %s\n", bench.recordPath.c_str());
+		return;
+	}
+	file << path.dump(2) << "\n";
+	printf("camera path: %zu keys written to %s\n", bench.recording.size(), bench.recordPath.c_str());
+}
+
+//Statistics
+// Nearest-rank percentiles
+static json seriesStats(std::vector<double> values) {
+	std::sort(values.begin(), values.end());
+	auto rank = [&](double p) {
+		size_t index = (size_t)std::ceil(p * values.size());
+		return values[std::clamp<size_t>(index, 1, values.size()) - 1];
+	};
+	double sum = 0.0;
+	for (double value : values) sum += value;
+	return {
+		{ "avg", sum / values.size() },
+		{ "p50", rank(0.50) },
+		{ "p95", rank(0.95) },
+		{ "p99", rank(0.99) },
+		{ "max", values.back() },
+	};
+}
+
+// Differences below this are noise, whatever the relative change
+static constexpr double COMPARE_NOISE_MS = 0.05;
+
+// Every p50/p95/p99 present in both files; true if any got slower than allowed
+static bool frameBenchCompare(const json& results, const std::string& baselinePath, float threshold) {
+	json baseline = jsonRead(baselinePath);
+	bool regressed = false;
+	printf("compared with %s, threshold +%.1f%%\n", baselinePath.c_str(), threshold * 100.0f);
+	for (const char* section : { "cpu", "gpu" }) {
+		if (!results.contains(section) || !baseline.contains(section)) continue;
+		for (const auto& [phase, before] : baseline[section].items()) {
+			if (!results[section].contains(phase)) continue;
+			const json& after = results[section][phase];
+			for (const char* stat : { "p50", "p95", "p99" }) {
+				double was = before.value(stat, 0.0);
+				double now = after.value(stat, 0.0);
+				bool slower = now > was * (1.0 + threshold) && now - was > COMPARE_NOISE_MS;
+				regressed = regressed || slower;
+				std::string metric = std::string(section) + "." + phase + "." + stat;
+				printf("  %-24s %9.3f -> %9.3f ms %+7.1f%%%s\n", metric.c_str(), was, now,
+					was > 0.0 ? 100.0 * (now - was) / was : 0.0, slower ? "  REGRESSED" : "");
+			}
+		}
+	}
+	printf(regressed ? "benchmark regressed\n" : "benchmark within threshold\n");
+	return regressed;
+}
+
+//Run
+// Drives the camera along the path at a fixed step, through the regular
+// windowed or headless frame, and reports every phase of the measured frames
+void frameBenchRun(State* state) {
+	using Clock = std::chrono::high_resolution_clock;
+	FrameBench& bench = state->frameBench;
+	uint32_t frameCount = bench.warmupFrames + bench.measuredFrames;
+
+	enum Phase { UPDATE, GATHER, RECORD, SUBMIT, PRESENT_WAIT, FENCE_WAIT, ACQUIRE, FRAME, PHASE_COUNT };
+	const char* phaseNames[PHASE_COUNT] = { "update", "gather", "record", "submit", "presentWait", "fenceWait", "acquire", "frame" };
+	enum Counter { DRAW_CALLS, INSTANCES, TRIANGLES, TRIANGLES_CULLED, PIPELINE_BINDS, DESCRIPTOR_BINDS, PUSH_CONSTANT_BYTES, COUNTER_COUNT };
+	const char* counterNames[COUNTER_COUNT] = { "drawCalls", "instances", "triangles", "trianglesCulled", "pipelineBinds", "descriptorBinds", "pushConstantBytes" };
+	std::array<double, COUNTER_COUNT> counters{};
+	std::array<std::vector<double>, PHASE_COUNT> cpu;
+	std::map<std::string, std::vector<double>> gpu;                                   // ms per pass scope
+	std::map<std::string, std::array<double, GPU_STAT_COUNT>> statistics;             // summed per scope
+	uint64_t framesRead = state->renderer.profiler.framesRead;
+	for (std::vector<double>& series : cpu) series.reserve(bench.measuredFrames);
+
+	printf("benchmark %s: %u warm-up + %u measured frames, %.4f s step, %ux%u%s\n", bench.name.c_str(),
+		bench.warmupFrames, bench.measuredFrames, bench.timestep, state->window.swapchain.imageExtent.width,
+		state->window.swapchain.imageExtent.height, state->config.headless ? " headless" : "");
+
+	for (uint32_t i = 0; i < frameCount; i++) {
+		if (!state->config.headless) {
+			glfwPollEvents();
+			if (glfwWindowShouldClose(state->window.handle)) break;
+		}
+		cameraPathSample(bench.cameraPath, bench.loop, i * bench.timestep, state->scene.camera);
+
+		auto frameStart = Clock::now();
+		uniformBuffersUpdate(state);
+		double uniformMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+		if (state->config.headless)
+			headlessFrameDraw(state, bench.timestep);
+		else
+			frameDraw(state, bench.timestep);
+		double frameMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+		if (i < bench.warmupFrames) continue;
+
+		const FrameTimings& timings = state->renderer.timings;
+		cpu[UPDATE].push_back(uniformMs + timings.update);
+		cpu[GATHER].push_back(timings.gather);
+		cpu[RECORD].push_back(timings.record);
+		cpu[SUBMIT].push_back(timings.submit);
+		cpu[PRESENT_WAIT].push_back(timings.wait + timings.present);
+		const RenderStats& stats = state->renderer.stats;
+		cpu[FENCE_WAIT].push_back(stats.fenceWaitMs);
+		cpu[ACQUIRE].push_back(stats.acquireMs);
+		cpu[FRAME].push_back(frameMs);
+
+		counters[DRAW_CALLS] += stats.drawCalls;
+		counters[INSTANCES] += (double)stats.instances;
+		counters[TRIANGLES] += (double)stats.triangles;
+		counters[TRIANGLES_CULLED] += (double)stats.trianglesCulled;
+		counters[PIPELINE_BINDS] += stats.pipelineBinds;
+		counters[DESCRIPTOR_BINDS] += stats.descriptorBinds;
+		counters[PUSH_CONSTANT_BYTES] += (double)stats.pushConstantBytes;
+
+		// GPU scopes are read back one lap of the frame slots later; skip the
+		// lap that still belongs to the warm-up
+		bool measuredGpu = i >= bench.warmupFrames + state->config.swapchainBuffering;
+		if (measuredGpu && state->renderer.profiler.framesRead != framesRead) {
+			framesRead = state->renderer.profiler.framesRead;
+			for (const GpuScope& scope : state->renderer.profiler.results) {
+				gpu[scope.name].push_back(scope.ms);
+				if (scope.statisticsQuery < 0) continue;
+				std::array<double, GPU_STAT_COUNT>& sum = statistics[scope.name];
+				for (uint32_t s = 0; s < GPU_STAT_COUNT; s++) sum[s] += (double)scope.statistics[s];
+			}
+		}
+	}
+	vkDeviceWaitIdle(state->context.device);
+	if (state->config.headless) headlessDumpFlush(state);
+
+	if (cpu[FRAME].empty()) {
+		printf("benchmark %s: no frames measured\n", bench.name.c_str());
+		return;
+	}
+
+	json results = {
+		{ "name", bench.name },
+		{ "frames", cpu[FRAME].size() },
+		{ "timestep", bench.timestep },
+		{ "width", state->window.swapchain.imageExtent.width },
+		{ "height", state->window.swapchain.imageExtent.height },
+		{ "headless", state->config.headless },
+		{ "instances", state->scene.instances.size() },
+		{ "vatInstances", state->scene.crowd.instanceCount },
+	};
+	for (int phase = 0; phase < PHASE_COUNT; phase++) {
+		results["cpu"][phaseNames[phase]] = seriesStats(cpu[phase]);
+	}
+	// Averages per measured frame, not compared against the baseline
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		results["counters"][counterNames[counter]] = counters[counter] / cpu[FRAME].size();
+	}
+	for (const auto& [scope, series] : gpu) {
+		results["gpu"][scope] = seriesStats(series);
+	}
+	// Averages per frame, not compared against the baseline
+	for (const auto& [scope, sum] : statistics) {
+		double frames = (double)gpu[scope].size();
+		results["gpuStatistics"][scope] = {
+			{ "vertexInvocations", sum[GPU_STAT_VERTEX_INVOCATIONS] / frames },
+			{ "clippingInvocations", sum[GPU_STAT_CLIPPING_INVOCATIONS] / frames },
+			{ "clippingPrimitives", sum[GPU_STAT_CLIPPING_PRIMITIVES] / frames },
+			{ "fragmentInvocations", sum[GPU_STAT_FRAGMENT_INVOCATIONS] / frames },
+		};
+	}
+
+	if (bench.outputPath.empty()) {
+		printf("%s\n", results.dump(2).c_str());
+	}
+	else {
+		std::ofstream file(bench.outputPath);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to write " + bench.outputPath);
+		}
+		file << results.dump(2) << "\n";
+		printf("benchmark %s: results written to %s\n", bench.name.c_str(), bench.outputPath.c_str());
+	}
+
+	if (!bench.baselinePath.empty()) {
+		bench.regressed = frameBenchCompare(results, bench.baselinePath, bench.threshold);
+	}
+}
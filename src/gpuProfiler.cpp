@@ -0,0 +1,154 @@
+#include "headers/gpuProfiler.h"
+#include "headers/buffers.h"
+
+static constexpr VkQueryPipelineStatisticFlags GPU_STATISTICS_FLAGS =
+	VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+//Pools
+void gpuProfilerCreate(State* state) {
+	GpuProfiler& profiler = state->renderer.profiler;
+	if (state->context.timestampPeriod <= 0.0f) {
+		printf("gpu profiler: queue has no timestamp support, disabled\n");
+		return;
+	}
+	uint32_t frames = state->config.swapchainBuffering;
+
+	VkQueryPoolCreateInfo timestampInfo{
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = 2 * GPU_SCOPES_MAX * frames,
+	};
+	PANIC(vkCreateQueryPool(state->context.device, &timestampInfo, nullptr, &profiler.timestampPool), "Failed To Create Timestamp Query Pool");
+
+	if (state->context.pipelineStatisticsQuery) {
+		VkQueryPoolCreateInfo statisticsInfo{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+			.queryCount = GPU_SCOPES_MAX * frames,
+			.pipelineStatistics = GPU_STATISTICS_FLAGS,
+		};
+		PANIC(vkCreateQueryPool(state->context.device, &statisticsInfo, nullptr, &profiler.statisticsPool), "Failed To Create Pipeline Statistics Query Pool");
+	}
+
+	// Queries start out uninitialized; reset once so a slot that was recorded
+	// but never submitted reads back as not ready instead of undefined
+	VkCommandBuffer cmd = beginSingleTimeCommands(state, state->renderer.commandPool);
+	state->context.vk.cmdResetQueryPool(cmd, profiler.timestampPool, 0, timestampInfo.queryCount);
+	if (profiler.statisticsPool != VK_NULL_HANDLE) {
+		state->context.vk.cmdResetQueryPool(cmd, profiler.statisticsPool, 0, GPU_SCOPES_MAX * frames);
+	}
+	endSingleTimeCommands(state, cmd);
+
+	profiler.slots.assign(frames, {});
+	profiler.slotStatistics.assign(frames, 0);
+	printf("gpu profiler: %u scopes x %u frames%s\n", GPU_SCOPES_MAX, frames,
+		profiler.statisticsPool != VK_NULL_HANDLE ? ", pipeline statistics" : "");
+}
+
+void gpuProfilerDestroy(State* state) {
+	GpuProfiler& profiler = state->renderer.profiler;
+	if (profiler.statisticsPool != VK_NULL_HANDLE) {
+		vkDestroyQueryPool(state->context.device, profiler.statisticsPool, nullptr);
+		profiler.statisticsPool = VK_NULL_HANDLE;
+	}
+	if (profiler.timestampPool != VK_NULL_HANDLE) {
+		vkDestroyQueryPool(state->context.device, profiler.timestampPool, nullptr);
+		profiler.timestampPool = VK_NULL_HANDLE;
+	}
+	profiler.slots.clear();
+	profiler.slotStatistics.clear();
+	profiler.results.clear();
+}
+
+//Recording
+void gpuProfilerFrameBegin(State* state, VkCommandBuffer cmd) {
+	GpuProfiler& profiler = state->renderer.profiler;
+	if (profiler.timestampPool == VK_NULL_HANDLE) return;
+	uint32_t frame = state->renderer.frameIndex;
+
+	profiler.slots[frame].clear();
+	profiler.slotStatistics[frame] = 0;
+	profiler.statisticsActive = false;
+	state->context.vk.cmdResetQueryPool(cmd, profiler.timestampPool, 2 * GPU_SCOPES_MAX * frame, 2 * GPU_SCOPES_MAX);
+	if (profiler.statisticsPool != VK_NULL_HANDLE) {
+		state->context.vk.cmdResetQueryPool(cmd, profiler.statisticsPool, GPU_SCOPES_MAX * frame, GPU_SCOPES_MAX);
+	}
+}
+
+uint32_t gpuScopeBegin(State* state, VkCommandBuffer cmd, const char* name, bool statistics) {
+	GpuProfiler& profiler = state->renderer.profiler;
+	if (profiler.timestampPool == VK_NULL_HANDLE) return UINT32_MAX;
+	uint32_t frame = state->renderer.frameIndex;
+	std::vector<GpuScope>& scopes = profiler.slots[frame];
+	if (scopes.size() >= GPU_SCOPES_MAX) return UINT32_MAX;
+
+	uint32_t scope = static_cast<uint32_t>(scopes.size());
+	GpuScope& entry = scopes.emplace_back(GpuScope{ .name = name });
+	state->context.vk.cmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, profiler.timestampPool, 2 * (GPU_SCOPES_MAX * frame + scope));
+
+	if (statistics && profiler.statisticsPool != VK_NULL_HANDLE && !profiler.statisticsActive) {
+		entry.statisticsQuery = static_cast<int32_t>(profiler.slotStatistics[frame]++);
+		profiler.statisticsActive = true;
+		state->context.vk.cmdBeginQuery(cmd, profiler.statisticsPool, GPU_SCOPES_MAX * frame + entry.statisticsQuery, 0);
+	}
+	return scope;
+}
+
+void gpuScopeEnd(State* state, VkCommandBuffer cmd, uint32_t scope) {
+	GpuProfiler& profiler = state->renderer.profiler;
+	if (scope == UINT32_MAX) return;
+	uint32_t frame = state->renderer.frameIndex;
+	const GpuScope& entry = profiler.slots[frame][scope];
+
+	if (entry.statisticsQuery >= 0) {
+		state->context.vk.cmdEndQuery(cmd, profiler.statisticsPool, GPU_SCOPES_MAX * frame + entry.statisticsQuery);
+		profiler.statisticsActive = false;
+	}
+	state->context.vk.cmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, profiler.timestampPool, 2 * (GPU_SCOPES_MAX * frame + scope) + 1);
+}
+
+//Readback
+// No wait flag: the fence already covers the slot, and a slot that never
+// reached the queue (the first recording in windowCreate) reports not ready
+void gpuProfilerCollect(State* state) {
+	GpuProfiler& profiler = state->renderer.profiler;
+	if (profiler.timestampPool == VK_NULL_HANDLE) return;
+	uint32_t frame = state->renderer.frameIndex;
+	std::vector<GpuScope>& scopes = profiler.slots[frame];
+	if (scopes.empty()) return;
+
+	std::array<uint64_t, 2 * GPU_SCOPES_MAX> ticks;
+	uint32_t count = static_cast<uint32_t>(scopes.size());
+	if (vkGetQueryPoolResults(state->context.device, profiler.timestampPool, 2 * GPU_SCOPES_MAX * frame, 2 * count,
+		sizeof(ticks), ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+		return;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		scopes[i].ms = (ticks[2 * i + 1] - ticks[2 * i]) * state->context.timestampPeriod / 1e6;
+	}
+
+	uint32_t statisticsCount = profiler.slotStatistics[frame];
+	if (statisticsCount > 0) {
+		std::array<uint64_t, GPU_STAT_COUNT * GPU_SCOPES_MAX> values;
+		if (vkGetQueryPoolResults(state->context.device, profiler.statisticsPool, GPU_SCOPES_MAX * frame, statisticsCount,
+			sizeof(values), values.data(), GPU_STAT_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+			for (GpuScope& scope : scopes) {
+				if (scope.statisticsQuery < 0) continue;
+				std::copy_n(values.begin() + GPU_STAT_COUNT * scope.statisticsQuery, GPU_STAT_COUNT, scope.statistics.begin());
+			}
+		}
+	}
+
+	profiler.results = scopes;
+	profiler.framesRead++;
+}
+
+double gpuScopeMs(const State* state, const char* name) {
+	for (const GpuScope& scope : state->renderer.profiler.results) {
+		if (strcmp(scope.name, name) == 0) return scope.ms;
+	}
+	return 0.0;
+}
@@ -129,7 +129,7 @@ void tranparencyPipelineCreate(State* state) {
 			.subpass = 0,
 			.basePipelineHandle = VK_NULL_HANDLE, // Optional
 		};
-		PANIC(vkCreateGraphicsPipelines(state->context.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &state->renderer.transparencyPipeline), "Failed To Create GraphicsPipeline");
+		PANIC(pipelineGraphicsCreate(state, pipelineInfo, &state->renderer.transparencyPipeline), "Failed To Create GraphicsPipeline");
 };
 
 void tranparencyPipelineDestroy(State* state) {
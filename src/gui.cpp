@@ -1,4 +1,6 @@
 #include "headers/gui.h"
+#include "headers/gpuProfiler.h"
+#include "headers/renderStats.h"
 void guiDescriptorPoolCreate(State* state) {
     VkDescriptorPoolSize pool_sizes[] =
     {
@@ -100,6 +102,7 @@ void guiInit(State* state) {
     initInfo.QueueFamily    = state->context.queueFamilyIndex;
     initInfo.Queue          = state->context.queue;
     initInfo.DescriptorPool = state->gui.descriptorPool;
+    initInfo.PipelineCache  = state->context.pipelineCache;
     initInfo.MinImageCount  = state->window.swapchain.imageCount;
     initInfo.ImageCount     = state->window.swapchain.imageCount;
     initInfo.UseDynamicRendering = false;
@@ -135,6 +138,41 @@ void guiInit(State* state) {
 	state->gui.style = style;
 }
 
+// Counters of the frame being recorded; ImGui's own draws are not included
+static void guiStatsWindow(State* state) {
+    const RenderStats& stats = state->renderer.stats;
+    const double MB = 1024.0 * 1024.0;
+
+    ImGui::Begin("Render Stats");
+    ImGui::Text("draws       %u, %u dispatches", stats.drawCalls, stats.dispatches);
+    ImGui::Text("instances   %llu", (unsigned long long)stats.instances);
+    ImGui::Text("triangles   %llu", (unsigned long long)stats.triangles);
+    if (state->renderer.profiler.statisticsPool != VK_NULL_HANDLE)
+        ImGui::Text("  clipped   %llu", (unsigned long long)stats.trianglesCulled);
+    ImGui::Text("binds       %u pipeline, %u descriptor", stats.pipelineBinds, stats.descriptorBinds);
+    ImGui::Text("push        %llu bytes", (unsigned long long)stats.pushConstantBytes);
+    ImGui::Text("uploads     %u (%llu total), %.2f ms waiting", stats.uploads, (unsigned long long)stats.uploadsTotal, stats.uploadWaitMs);
+
+    ImGui::Separator();
+    double blocked = renderStatsBlockedFraction(state);
+    ImGui::Text("fence wait  %.3f ms", stats.fenceWaitMs);
+    ImGui::Text("acquire     %.3f ms", stats.acquireMs);
+    ImGui::Text("%s, blocked %.0f%% of the frame", blocked > 0.25 ? "GPU/present bound" : "CPU bound", blocked * 100.0);
+    ImGui::PlotLines("CPU ms", stats.cpuFrameMs.data(), RENDER_STATS_HISTORY, stats.historyHead, nullptr, 0.0f, FLT_MAX, ImVec2(0, 50));
+    if (state->renderer.profiler.timestampPool != VK_NULL_HANDLE)
+        ImGui::PlotLines("GPU ms", stats.gpuFrameMs.data(), RENDER_STATS_HISTORY, stats.historyHead, nullptr, 0.0f, FLT_MAX, ImVec2(0, 50));
+
+    ImGui::Separator();
+    for (uint32_t i = 0; i < stats.heapCount; i++) {
+        const char* kind = stats.heapDeviceLocal[i] ? "device" : "host";
+        if (state->context.memoryBudget)
+            ImGui::Text("heap %u %-6s %7.1f / %7.1f MB", i, kind, stats.heapUsage[i] / MB, stats.heapBudget[i] / MB);
+        else
+            ImGui::Text("heap %u %-6s %7.1f MB, no budget extension", i, kind, stats.heapSize[i] / MB);
+    }
+    ImGui::End();
+}
+
 void guiDraw(State* state, VkCommandBuffer cmd) {
     ImGui_ImplVulkan_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -145,6 +183,37 @@ void guiDraw(State* state, VkCommandBuffer cmd) {
     ImGui::Text("  %.1f   ", state->gui.io.Framerate);
     ImGui::End();
 
+    // Animated instances per LOD tier, counted in animationLodSelect
+    const auto& lodCounts = state->scene.animationLodCounts;
+    ImGui::Begin("Animation LOD");
+    ImGui::Text("full    %u", lodCounts[ANIMATION_LOD_FULL]);
+    ImGui::Text("1/2     %u", lodCounts[ANIMATION_LOD_HALF]);
+    ImGui::Text("1/4     %u", lodCounts[ANIMATION_LOD_QUARTER]);
+    ImGui::Text("frozen  %u", lodCounts[ANIMATION_LOD_FROZEN]);
+    ImGui::Text("VAT     %u", state->scene.crowd.instanceCount);
+    ImGui::Text("        %u joints, %.3f ms CPU", state->renderer.jointsInUse, state->renderer.animationCpuMs);
+    ImGui::Separator();
+    ImGui::Text("morph   %u blended, %u cached", state->renderer.morphBlends, state->renderer.morphCacheHits);
+    ImGui::Text("        %u deltas", state->renderer.morphDeltasApplied);
+    ImGui::End();
+
+    // Per-pass GPU time from gpuProfilerCollect, a few frames behind
+    const GpuProfiler& profiler = state->renderer.profiler;
+    if (profiler.timestampPool != VK_NULL_HANDLE) {
+        ImGui::Begin("GPU");
+        for (const GpuScope& scope : profiler.results) {
+            ImGui::Text("%-12s %7.3f ms", scope.name, scope.ms);
+            if (scope.statisticsQuery < 0) continue;
+            ImGui::Text("  vs %llu  fs %llu", (unsigned long long)scope.statistics[GPU_STAT_VERTEX_INVOCATIONS],
+                (unsigned long long)scope.statistics[GPU_STAT_FRAGMENT_INVOCATIONS]);
+            ImGui::Text("  clip %llu -> %llu prims", (unsigned long long)scope.statistics[GPU_STAT_CLIPPING_INVOCATIONS],
+                (unsigned long long)scope.statistics[GPU_STAT_CLIPPING_PRIMITIVES]);
+        }
+        ImGui::End();
+    }
+
+    guiStatsWindow(state);
+
     ImGui::Render();
 
     VkRenderPassBeginInfo rpInfo{};
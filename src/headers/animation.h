@@ -0,0 +1,10 @@
+#pragma once
+#include "stateMachine.h"
+
+void animationCompress(Model& model, const AnimationCompression& settings = {});
+size_t animationMemory(const Animation& animation);
+void animationPoseCreate(const Model& model, ModelInstance& instance);
+void animationInstanceUpdate(const Model& model, ModelInstance& instance, float deltaTime, bool skipLeafJoints = false);
+void animationLodSelect(State* state, const glm::mat4& viewProj, const glm::vec3& camPos, float focalScale);
+void animationInstanceFrame(const Model& model, ModelInstance& instance, float deltaTime, glm::mat4* palette);
+void animationUpdate(State* state, float deltaTime);
@@ -1,4 +1,5 @@
 #include "window.h"
+#include "frameBench.h"
 
 void init(State *state);
 void mainloop(State *state);
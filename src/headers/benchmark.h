@@ -0,0 +1,19 @@
+#pragma once
+#include "models.h"
+#include "skinning.h"
+#include "vat.h"
+#include "metrics.h"
+#include "commands.h"
+#include "scene.h"
+#include "context.h"
+#include "renderer.h"
+#include "gpuProfiler.h"
+
+// Offline micro-benchmarks: VulkanRenderer --bench <name>
+// Returns false when no benchmark has that name.
+bool benchmarkRun(State* state, const std::string& name);
+void benchmarkList();
+
+// Null device fixtures, shared with the micro_bench target
+std::unique_ptr<State> benchNullStateCreate(const State* state);
+void benchNullModelRegister(State* state, const std::string& path, uint32_t meshCount, uint32_t transparentCount);
@@ -10,6 +10,9 @@ void createBuffer(State* state, VkDeviceSize size, VkBufferUsageFlags usage, VkM
 VkCommandBuffer beginSingleTimeCommands(State* state, VkCommandPool commandPool);
 void endSingleTimeCommands(State* state, VkCommandBuffer commandBuffer);
 void copyBuffer(State* state, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+void stagingBufferRelease(State* state, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size);
+void uploadBatchBegin(State* state);
+void uploadBatchSubmit(State* state);
 
 void frameBuffersCreate(State* state);
 void frameBuffersDestroy(State* state);
@@ -20,9 +23,12 @@ void vertexBufferDestroy(State* state);
 void indexBufferCreateForMesh(State* state, const std::vector<uint32_t>& indices, VkBuffer& indexBuffer, VkDeviceMemory& indexMemory);
 void indexBufferDestroy(State* state);
 
+void storageBufferCreate(State* state, const void* contents, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory);
+
 void uniformBuffersCreate(State* state);
 void uniformBuffersUpdate(State* state);
 void uniformBuffersDestroy(State* state);
 
 void commandBufferGet(State* state);
 void commandBufferRecord(State* state);
+void transparentDrawsGather(State* state, std::vector<TransparentDraw>& out);
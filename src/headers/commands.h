@@ -0,0 +1,15 @@
+#pragma once
+#include "stateMachine.h"
+
+//Null device
+// Points context.device, context.queue and context.vk at a recorder that
+// counts and validates commands without a GPU. Everything else the frame
+// touches (pipelines, buffers, descriptor sets) can hold made-up handles:
+// the recorder only checks them against VK_NULL_HANDLE.
+void nullDeviceCreate(State* state);
+// Back to the loader's entry points; command buffers must be freed first
+void nullDeviceDestroy(State* state);
+
+const NullDevice& nullDeviceGet(const State* state);
+const NullCommandBuffer& nullCommandBufferGet(VkCommandBuffer cmd);
+const char* nullCommandName(NullCommand command);
@@ -0,0 +1,14 @@
+#pragma once
+#include "stateMachine.h"
+
+//Description
+// Reads state->frameBench.path; scene counts go into the config, so call before init
+void frameBenchLoad(State* state);
+
+//Camera path
+void cameraPathSample(const std::vector<CameraKey>& path, bool loop, float time, Camera& camera);
+void cameraPathRecord(State* state, float deltaTime);
+void cameraPathSave(State* state);
+
+//Run
+void frameBenchRun(State* state);
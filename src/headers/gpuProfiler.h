@@ -0,0 +1,21 @@
+#pragma once
+#include "stateMachine.h"
+
+//Pools
+// Needs the command pool; does nothing when the queue can't write timestamps
+void gpuProfilerCreate(State* state);
+void gpuProfilerDestroy(State* state);
+
+//Recording
+// Start of the frame's command buffer, outside any render pass
+void gpuProfilerFrameBegin(State* state, VkCommandBuffer cmd);
+// Scopes may nest. Statistics are taken for the outermost scope that asks for
+// them, and a scope begun inside a render pass must end in the same subpass.
+uint32_t gpuScopeBegin(State* state, VkCommandBuffer cmd, const char* name, bool statistics = true);
+void gpuScopeEnd(State* state, VkCommandBuffer cmd, uint32_t scope);
+
+//Readback
+// Call once the frame slot's fence has signalled, before it is recorded again
+void gpuProfilerCollect(State* state);
+// Last read-back time of the named scope, 0 if it was not recorded
+double gpuScopeMs(const State* state, const char* name);
@@ -1,4 +1,5 @@
 #include "stateMachine.h"
+#include "pipelineCache.h"
 
 void tranparencyPipelineCreate(State* state);
 void tranparencyPipelineDestroy(State* state);
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+#include "stateMachine.h"
+#include "textures.h"
+
+//Targets
+// Offscreen color images in place of the swapchain, sized by the config window size
+void headlessTargetsCreate(State* state);
+void headlessTargetsDestroy(State* state);
+
+//Readback
+void headlessReadbackRecord(State* state, VkCommandBuffer cmd);
+void headlessDumpFlush(State* state);
+
+//Draw
+void headlessFrameDraw(State* state, float deltaTime);
+void headlessRun(State* state);
@@ -0,0 +1,9 @@
+#pragma once
+#include "stateMachine.h"
+
+void jobSystemCreate(State* state);
+void jobSystemDestroy(State* state);
+
+void jobSubmit(State* state, std::function<void()> job);
+void jobWaitIdle(State* state);
+void jobParallelFor(State* state, uint32_t count, uint32_t minChunk, const std::function<void(uint32_t, uint32_t)>& body);
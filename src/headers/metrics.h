@@ -0,0 +1,20 @@
+#pragma once
+#include "stateMachine.h"
+
+//Exporter
+// Starts the exporter thread when state->metrics.path is set
+void metricsCreate(State* state);
+// Stops the thread and writes the file one last time
+void metricsDestroy(State* state);
+
+//Producer, main thread only; never blocks, drops the sample if the ring is full
+void metricsFrame(State* state);
+void metricsLoad(State* state, const std::string& modelPath, double ms);
+void metricsSwapchainRecreate(State* state);
+
+//Consumer
+// Drains the ring into the aggregate and renders it in the Prometheus text
+// format. The exporter thread calls it; without one, any single caller may.
+std::string metricsSnapshot(State* state);
+// Empty if text is well-formed exposition format, else the first problem found
+std::string metricsFormatCheck(const std::string& text);
@@ -1,15 +1,33 @@
 #include "textures.h"
+#include "jobs.h"
+#include "animation.h"
+#include "morph.h"
 
+namespace tinygltf { class Model; }
 
-Model* modelLoad(State* state, std::string modelPath);
+
+ModelHandle modelLoad(State* state, std::string modelPath);
+Model* modelGet(State* state, ModelHandle handle);
+ModelHandle modelAcquire(State* state, std::string modelPath);
+void modelRelease(State* state, ModelHandle handle);
+InstanceHandle modelInstanceCreate(State* state, std::string modelPath);
+ModelInstance* modelInstanceGet(State* state, InstanceHandle handle);
+void modelInstanceDestroy(State* state, InstanceHandle handle);
+void modelInstancesReclaim(State* state);
+void modelLoadCpu(State* state, std::string modelPath, Model& model);
+void modelLoadCpu(State* state, tinygltf::Model& gltfModel, Model& model);
+void modelCookTextures(State* state, std::string modelPath);
 void modelUnload(State* state);
 
 void drawMesh(State* state,
     VkCommandBuffer cmd,
     const Mesh& mesh,
     const glm::mat4& nodeMatrix,
-    const glm::mat4& modelTransform);
-
-void drawNode(State* state, VkCommandBuffer cmd, const Node* node);
+    const glm::mat4& modelTransform,
+    int jointOffset = -1,
+    int vatVertexBase = -1,
+    uint32_t instanceCount = 1,
+    VkBuffer vertexBuffer = VK_NULL_HANDLE,
+    const MaterialOverride* materialOverride = nullptr);
 
-void gatherDrawItems(const Node* root, const glm::vec3& camPos, const std::vector<Material>& materials, std::vector<DrawItem>& out);
+void gatherDrawItems(const Model& model, const glm::vec3& camPos, const std::vector<Material>& materials, std::vector<DrawItem>& out);
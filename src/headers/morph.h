@@ -0,0 +1,14 @@
+#pragma once
+#include "stateMachine.h"
+
+//Blend
+const float* morphWeights(const Model& model, const ModelInstance& instance);
+void morphBlendSparse(const Mesh& mesh, const float* weights, Vertex* out);
+
+//Compute
+void morphCreate(State* state);
+void morphRecord(State* state, VkCommandBuffer cmd);
+void morphSubmitted(State* state);
+VkBuffer morphVertexBuffer(const ModelInstance& instance, uint32_t mesh);
+void morphInstanceRelease(State* state, ModelInstance& instance);
+void morphDestroy(State* state);
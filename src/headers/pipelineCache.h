@@ -0,0 +1,16 @@
+#pragma once
+#include "stateMachine.h"
+
+//Cache
+// After deviceCreate, before the first pipeline: loads config.pipelineCachePath
+// when its header matches this device and driver, otherwise starts empty
+void pipelineCacheCreate(State* state);
+// Writes the data back if it changed since it was loaded or last written
+void pipelineCacheSave(State* state);
+// Saves, then destroys the cache; before deviceDestroy
+void pipelineCacheDestroy(State* state);
+
+//Pipelines
+// Every pipeline goes through these, so they share the cache and their creation time is counted
+VkResult pipelineGraphicsCreate(State* state, const VkGraphicsPipelineCreateInfo& info, VkPipeline* pipeline);
+VkResult pipelineComputeCreate(State* state, const VkComputePipelineCreateInfo& info, VkPipeline* pipeline);
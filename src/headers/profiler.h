@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include <string>
+
+// Scoped CPU zones. Built with VR_ENABLE_PROFILER every PROFILE_ZONE records
+// a begin/end pair into the calling thread's ring; without it the macros
+// expand to nothing. Zone names must outlive the program: string literals
+// or __func__.
+#ifdef VR_ENABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+
+// Raw ticks: the TSC on x86-64 (invariant on anything recent), the steady
+// clock elsewhere. The export calibrates them against the steady clock.
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+inline int64_t profilerNow() {
+	return static_cast<int64_t>(__rdtsc());
+}
+#else
+inline int64_t profilerNow() {
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+#endif
+void profilerRecord(const char* name, int64_t start, int64_t end);
+
+struct ProfileZone {
+	const char* name;
+	int64_t start;
+	explicit ProfileZone(const char* name) : name(name), start(profilerNow()) {}
+	~ProfileZone() { profilerRecord(name, start, profilerNow()); }
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+};
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
+
+//Threads
+// Shown as the track name in the trace; call once at the top of a thread
+void profilerThreadName(const std::string& name);
+
+//Export
+// Every thread's ring as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Safe while other threads keep recording; returns false if nothing was written.
+bool profilerTraceWrite(const std::string& path);
@@ -0,0 +1,15 @@
+#pragma once
+#include "stateMachine.h"
+
+//Frame
+// Clears the command counters; start of commandBufferRecord
+void renderStatsFrameBegin(State* state);
+// Once the frame is submitted: frame-time history, GPU-side culling, memory
+void renderStatsFrameEnd(State* state);
+
+//Memory
+void renderStatsMemoryUpdate(State* state);
+
+//Queries
+// Share of the last frame the host spent blocked on the GPU or the swapchain
+double renderStatsBlockedFraction(const State* state);
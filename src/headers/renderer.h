@@ -2,11 +2,13 @@
 #include "scene.h"
 #include "fstream"
 #include "vector"
+std::vector<char> shaderRead(const char* filePath);
+
 //Graphics Pipeline
 void renderPassCreate(State* state);
 void renderPassDestroy(State* state);
 
-// set 0: global UBO
+// set 0: global UBO + joint palette + crowd vertex animation textures
 void createGlobalSetLayout(State* state);
 // set 1: texture (for now, just baseColor at binding 0)
 void createTextureSetLayout(State* state);
@@ -21,6 +23,7 @@ void commandPoolDestroy(State* state);
 void descriptorPoolCreate(State* state);
 void descriptorSetsCreate(State* state);
 void createMaterialDescriptorSets(State* state);
+void materialDescriptorSetWrite(State* state, Material& mat);
 void descriptorPoolDestroy(State* state);
 
 void syncObjectsCreate(State* state);
@@ -1,3 +1,22 @@
 #include "textures.h"
 #include "models.h"
 #include "camera.h"
+
+//Description
+// Parses a scene file; "generate" blocks are expanded in place. Throws on
+// unreadable files or malformed entries.
+void sceneDescriptionLoad(const std::string& path, SceneDescription& description);
+// Entries written out one per line, generators already expanded
+void sceneDescriptionWrite(const std::string& path, const SceneDescription& description);
+
+//Generator
+// Appends generator.count entries; sets the camera if the description has none
+void sceneGenerate(const SceneGenerator& generator, SceneDescription& description);
+// Stress presets: grid, clusters, hierarchy, materials, transparent
+bool sceneGeneratorPreset(const std::string& name, uint32_t count, const std::string& model, SceneGenerator& generator);
+void sceneGeneratorPresetList();
+
+//Instances
+// Creates one instance per entry, placed under its parent, plus lights and camera
+void sceneInstantiate(State* state, const SceneDescription& description);
+void sceneLoad(State* state, const std::string& path);
@@ -0,0 +1,10 @@
+#pragma once
+#include "stateMachine.h"
+#include "buffers.h"
+
+void skinningInstancePalette(const Model& model, const ModelInstance& instance, glm::mat4* out);
+uint32_t skinningPaletteSize(State* state);
+
+void skinningCreate(State* state);
+glm::mat4* skinningPaletteReserve(State* state);
+void skinningDestroy(State* state);
@@ -0,0 +1,16 @@
+#pragma once
+#include "stateMachine.h"
+
+//Phases
+// Call at the top of main; each startupPhase closes the lap since the previous mark
+void startupBegin(State* state);
+void startupPhase(State* state, const char* name);
+// After the first submit: waits for the GPU once, prints the breakdown and
+// writes the report if one was asked for. Later frames return at once.
+void startupFirstFrame(State* state);
+
+//Benchmark
+// Relaunches exe with args, alternating cold and warm starts, and reports the
+// median of every phase. Results go to state->frameBench.outputPath if set.
+// Returns the exit code for main.
+int startupBenchRun(State* state, const std::string& exe, const std::string& args, uint32_t runs);
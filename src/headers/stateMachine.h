@@ -9,6 +9,7 @@
 #include <iostream>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <signal.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/epsilon.hpp>
@@ -16,6 +17,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include <glm/gtx/hash.hpp>
 
 #include <algorithm>
@@ -23,9 +25,17 @@
 #include <chrono>
 #include <vector>
 #include <array>
+#include <deque>
+#include <string_view>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_vulkan.h"
+#include "profiler.h"
 
 #define PANIC(ERROR, FORMAT,...){int macroErrorCode = ERROR; if(macroErrorCode){fprintf(stderr, "%s -> %s -> %i -> Error(%i):\n\t" FORMAT "\n", __FILE__, __func__, __LINE__, macroErrorCode, ##__VA_ARGS__); raise(SIGABRT);}};
 
@@ -35,6 +45,8 @@ struct Vertex {
 	glm::vec2 texCoord;
 	glm::vec3 normal;
 	glm::vec4 tangent;
+	glm::u16vec4 joints;    // JOINTS_0, indices into the node's Skin::joints
+	glm::vec4 weights;      // WEIGHTS_0, all zero for unskinned vertices
 	uint32_t  materialIndex;
 
 	static VkVertexInputBindingDescription getBindingDescription() {
@@ -46,8 +58,8 @@ struct Vertex {
 		return bindingDescription;
 	}
 
-	static std::array<VkVertexInputAttributeDescription, 5> getAttributeDescriptions() {
-		std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions{};
+	static std::array<VkVertexInputAttributeDescription, 7> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 7> attributeDescriptions{};
 
 		attributeDescriptions[0].binding = 0;
 		attributeDescriptions[0].location = 0;
@@ -74,6 +86,16 @@ struct Vertex {
 		attributeDescriptions[4].format = VK_FORMAT_R32G32B32_SFLOAT;
 		attributeDescriptions[4].offset = offsetof(Vertex, tangent);
 
+		attributeDescriptions[5].binding = 0;
+		attributeDescriptions[5].location = 5;
+		attributeDescriptions[5].format = VK_FORMAT_R16G16B16A16_UINT;
+		attributeDescriptions[5].offset = offsetof(Vertex, joints);
+
+		attributeDescriptions[6].binding = 0;
+		attributeDescriptions[6].location = 6;
+		attributeDescriptions[6].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescriptions[6].offset = offsetof(Vertex, weights);
+
 		return attributeDescriptions;
 
 	}
@@ -193,6 +215,7 @@ struct UniformBufferObject {
 	float gamma = 1.0f;            // Gamma correction value
 	float prefilteredCubeMipLevels = 1.0f;  // For image-based lighting
 	float scaleIBLAmbient = 1.0f; // Scale factor for ambient lighting
+	float time = 0.0f;            // Seconds since start, drives vertex animation texture playback
 };
 
 struct PushConstantBlock {
@@ -207,7 +230,8 @@ struct PushConstantBlock {
 	int emissiveTextureSet;               // Texture coordinate set for emission
 	float alphaMask;                      // Whether to use alpha masking
 	float alphaMaskCutoff;                // Alpha threshold for masking
-
+	int jointOffset;                      // First joint matrix in the palette buffer, -1 if not skinned
+	int vatVertexBase;                    // First texel column in the crowd's animation textures, -1 if not a crowd draw
 };
 
 struct TexTransformGPU {
@@ -262,72 +286,153 @@ struct Material {
 };
 
 
+// One vertex moved by one morph target, deltas already axis-swapped like the
+// vertex. std430, matches MorphDelta in morph.comp.
+struct MorphDelta {
+	uint32_t vertex;
+	float position[3];
+	float normal[3];
+	float tangent[3];
+};
+
+// Push constants of one morph.comp dispatch: one target applied to one output
+struct MorphPushConstants {
+	uint32_t firstDelta;
+	uint32_t deltaCount;
+	float weight;
+	uint32_t vertexStride;       // all in floats
+	uint32_t positionOffset;
+	uint32_t normalOffset;
+	uint32_t tangentOffset;
+};
+
 struct Mesh {
 	std::vector<Vertex>   vertices;
 	std::vector<uint32_t> indices;
 	int                   materialIndex = -1;
 
+	// Morph targets, sparse: each target lists only the vertices it moves
+	std::vector<MorphDelta> morphDeltas;        // every target back to back
+	std::vector<uint32_t> morphTargetFirst;     // target t is [first[t], first[t + 1]), empty if not morphed
+	uint32_t morphWeightFirst = UINT32_MAX;     // this mesh's weights in Model::morphWeights / AnimationPose::weights
+
 	VkBuffer       vertexBuffer = VK_NULL_HANDLE;
 	VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
 	VkBuffer       indexBuffer = VK_NULL_HANDLE;
 	VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+	VkBuffer       morphDeltaBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory morphDeltaMemory = VK_NULL_HANDLE;
+
+	uint32_t morphTargetCount() const { return morphTargetFirst.empty() ? 0 : static_cast<uint32_t>(morphTargetFirst.size() - 1); }
 };
 
 
-struct Node {
-	std::string name;
-	Node* parent = nullptr;
-	std::vector<Node*> children;
-	std::vector<Mesh>meshes;
-	glm::mat4 matrix = glm::mat4(1.0f);
+constexpr uint32_t NODE_NONE = UINT32_MAX;
+constexpr uint32_t STRING_NONE = UINT32_MAX;
 
-	// For animation
-	glm::vec3 translation = glm::vec3(0.0f);
-	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-	glm::vec3 scale = glm::vec3(1.0f);
+// Interned strings, compared and hashed as 32-bit ids
+struct StringTable {
+	std::deque<std::string> strings;                       // deque: the views below stay valid
+	std::unordered_map<std::string_view, uint32_t> ids;
 
+	uint32_t intern(std::string_view str) {
+		auto it = ids.find(str);
+		if (it != ids.end()) return it->second;
+		uint32_t id = static_cast<uint32_t>(strings.size());
+		strings.emplace_back(str);
+		ids.emplace(strings.back(), id);
+		return id;
+	}
+	uint32_t find(std::string_view str) const {
+		auto it = ids.find(str);
+		return it != ids.end() ? it->second : STRING_NONE;
+	}
+	const std::string& get(uint32_t id) const { return strings[id]; }
+};
 
-	bool hasBakedMatrix() const {
-		const float eps = 1e-6f;
-		glm::mat4 identity(1.0f);
+// Node hierarchy of one model as parallel arrays indexed by node id.
+// Nodes are appended depth-first, so a parent always precedes its children
+// and global matrices resolve in one forward pass.
+struct NodeStore {
+	std::vector<uint32_t> parent;
+	std::vector<uint32_t> firstChild;
+	std::vector<uint32_t> nextSibling;
+	std::vector<uint32_t> lastChild;      // keeps children in glTF order while building
+	std::vector<uint32_t> name;           // StringTable id
+	std::vector<uint32_t> meshFirst;      // range in Model::meshes
+	std::vector<uint32_t> meshCount;
+	std::vector<int32_t> skin;            // Model::skins index, -1 if the meshes are rigid
 
-		for (int r = 0; r < 4; r++) {
-			for (int c = 0; c < 4; c++) {
-				if (fabs(matrix[r][c] - identity[r][c]) > eps)
-					return true; // matrix differs from identity
-			}
-		}
-		return false; // matrix is effectively identity
+	// For animation
+	std::vector<glm::vec3> translation;
+	std::vector<glm::quat> rotation;
+	std::vector<glm::vec3> scale;
+	std::vector<glm::mat4> matrix;        // baked glTF matrix, used instead of TRS when set
+	std::vector<uint8_t> hasMatrix;
+
+	std::vector<glm::mat4> global;
+
+	uint32_t size() const { return static_cast<uint32_t>(parent.size()); }
+
+	// One allocation per array for the whole model
+	void reserve(size_t count) {
+		parent.reserve(count); firstChild.reserve(count); nextSibling.reserve(count); lastChild.reserve(count);
+		name.reserve(count); meshFirst.reserve(count); meshCount.reserve(count); skin.reserve(count);
+		translation.reserve(count); rotation.reserve(count); scale.reserve(count);
+		matrix.reserve(count); hasMatrix.reserve(count); global.reserve(count);
 	}
 
-
-	glm::mat4 getLocalMatrix() const {
-		// If glTF provided a meaningful baked matrix, use it
-		if (hasBakedMatrix()) {
-			return matrix;
+	uint32_t add(uint32_t parentIndex, uint32_t nameId) {
+		uint32_t index = size();
+		parent.push_back(parentIndex);
+		firstChild.push_back(NODE_NONE);
+		nextSibling.push_back(NODE_NONE);
+		lastChild.push_back(NODE_NONE);
+		name.push_back(nameId);
+		meshFirst.push_back(0);
+		meshCount.push_back(0);
+		skin.push_back(-1);
+		translation.push_back(glm::vec3(0.0f));
+		rotation.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		scale.push_back(glm::vec3(1.0f));
+		matrix.push_back(glm::mat4(1.0f));
+		hasMatrix.push_back(0);
+		global.push_back(glm::mat4(1.0f));
+
+		if (parentIndex != NODE_NONE) {
+			if (lastChild[parentIndex] == NODE_NONE)
+				firstChild[parentIndex] = index;
+			else
+				nextSibling[lastChild[parentIndex]] = index;
+			lastChild[parentIndex] = index;
 		}
+		return index;
+	}
 
-		glm::mat4 T = glm::translate(glm::mat4(1.0f), translation);
-		glm::mat4 R = glm::mat4_cast(rotation);
-		glm::mat4 S = glm::scale(glm::mat4(1.0f), scale);
+	glm::mat4 localMatrix(uint32_t i) const {
+		if (hasMatrix[i]) {
+			return matrix[i];
+		}
+		glm::mat4 T = glm::translate(glm::mat4(1.0f), translation[i]);
+		glm::mat4 R = glm::mat4_cast(rotation[i]);
+		glm::mat4 S = glm::scale(glm::mat4(1.0f), scale[i]);
 		return T * R * S;
 	}
 
-	glm::mat4 getGlobalMatrix() const {
-		if (parent)
-			return parent->getGlobalMatrix() * getLocalMatrix();
-		else
-			return getLocalMatrix();
+	void updateGlobals() {
+		for (uint32_t i = 0; i < size(); i++) {
+			global[i] = parent[i] == NODE_NONE ? localMatrix(i) : global[parent[i]] * localMatrix(i);
+		}
 	}
 
-
+	void clear() { *this = NodeStore{}; }
 };
 
 // Structure for animation keyframes
 struct AnimationChannel {
-	enum PathType { TRANSLATION, ROTATION, SCALE };
+	enum PathType { TRANSLATION, ROTATION, SCALE, WEIGHTS };
 	PathType path;
-	Node* node = nullptr;
+	uint32_t node = NODE_NONE;
 	uint32_t samplerIndex;
 };
 
@@ -336,36 +441,177 @@ struct AnimationSampler {
 	enum InterpolationType { LINEAR, STEP, CUBICSPLINE };
 	InterpolationType interpolation;
 	std::vector<float> inputs;  // Key frame timestamps
-	std::vector<glm::vec4> outputsVec4;  // Key frame values (for rotations)
+	std::vector<glm::vec4> outputsVec4;  // Key frame values (for rotations, xyzw)
 	std::vector<glm::vec3> outputsVec3;  // Key frame values (for translations and scales)
+	std::vector<float> outputsScalar;    // Key frame values (for morph weights), one per target per key
+	// CUBICSPLINE outputs hold in-tangent, value, out-tangent triplets per key
+
+	// Filled by animationCompress for LINEAR and STEP samplers, which then
+	// drop their outputs and keep only the surviving key times in inputs
+	std::vector<uint16_t> packed;        // 3 per key: smallest-three quaternion, or vec3 quantized to the range
+	glm::vec3 rangeMin = glm::vec3(0.0f);
+	glm::vec3 rangeStep = glm::vec3(0.0f);   // range extent / 65535
 };
 
-// Structure for animation
+// Key reduction tolerances for animationCompress
+struct AnimationCompression {
+	float rotationError = 0.0005f;       // radians
+	float translationError = 0.0005f;    // fraction of the track's value range
+	float scaleError = 0.0005f;          // fraction of the track's value range
+};
+
+// Structure for animation. Immutable once loaded, playback state lives on the instance.
 struct Animation {
 	std::string name;
 	std::vector<AnimationSampler> samplers;
 	std::vector<AnimationChannel> channels;
 	float start = std::numeric_limits<float>::max();
-	float end = std::numeric_limits<float>::min();
-	float currentTime = 0.0f;
+	float end = std::numeric_limits<float>::lowest();
+};
+
+// Per-instance animated copy of the node TRS, plus one keyframe cursor per
+// channel so playback only ever steps forward through the keys.
+// Local TRS of every node at one sample time
+struct PoseSample {
+	std::vector<glm::vec3> translation;
+	std::vector<glm::quat> rotation;
+	std::vector<glm::vec3> scale;
+
+	bool empty() const { return rotation.empty(); }
+	void clear() { translation.clear(); rotation.clear(); scale.clear(); }
+};
+
+struct AnimationPose {
+	std::vector<glm::vec3> translation;
+	std::vector<glm::quat> rotation;
+	std::vector<glm::vec3> scale;
+	std::vector<glm::mat4> global;
+	std::vector<uint32_t> cursors;
+	PoseSample from;                  // reduced-rate LODs: the two latest samples,
+	PoseSample to;                    // the local pose is blended between them every frame
+	std::vector<float> weights;       // morph weights, laid out like Model::morphWeights
+
+	bool empty() const { return global.empty(); }
+};
+
+// Animation detail, picked every frame from the instance's projected screen size
+enum AnimationLod : uint8_t {
+	ANIMATION_LOD_FULL,       // sampled every frame
+	ANIMATION_LOD_HALF,       // sampled every 2nd frame, interpolated in between
+	ANIMATION_LOD_QUARTER,    // sampled every 4th frame, leaf joints held
+	ANIMATION_LOD_FROZEN,     // off screen: nothing sampled or skinned, time still advances
+	ANIMATION_LOD_COUNT
+};
+
+struct DrawItem {
+    uint32_t node;
+    const Mesh* mesh;
+    float distanceToCamera;
+    bool transparent;
+    glm::mat4 nodeMatrix;   // node global matrix, resolved when gathered
+    int32_t skin = -1;      // skinned items take their transform from the joint palette
 };
 
+// processNode stores glTF positions as (x, z, -y). Skinning has to happen in
+// glTF space, so the bind matrices undo the swap and skinned draws reapply it.
+inline glm::mat4 gltfAxisSwap() {
+	return glm::mat4(
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, -1.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+struct Skin {
+	std::string name;
+	std::vector<uint32_t> joints;          // NodeStore indices
+	std::vector<glm::mat4> jointBind;      // inverseBindMatrix * inverse(gltfAxisSwap()) per joint
+	uint32_t paletteOffset = 0;            // first matrix of this skin in an instance's palette
+};
+
+// Stable reference to a Scene::models slot; a stale generation means the
+// asset was released and the slot reused.
+struct ModelHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool operator==(const ModelHandle&) const = default;
+};
+
+// Shared, immutable asset: GPU geometry, materials and textures of one glTF file.
+// Placed in the world through ModelInstance.
 struct Model {
 	std::string name;
-	std::vector<Node*> nodes;
-	Node* rootNode = nullptr;
-	std::vector<Node*> linearNodes;
+	std::string path;                 // key in Scene::modelCache
+	uint32_t refCount = 0;            // instances using this asset, 0 = released slot
+	uint32_t generation = 0;          // bumped every time the slot is reused
+	NodeStore nodes;                  // node 0 is the synthetic root
+	std::vector<Mesh> meshes;         // all primitives, ranged per node
+	std::unordered_map<uint32_t, uint32_t> nodeByName;   // name id -> node
+	std::vector<uint32_t> nodeFromGltf;                  // glTF node index -> node, NODE_NONE if not in the scene
 	std::vector<Animation> animations;
-	glm::mat4 transform = glm::mat4(1.0f);
+	std::vector<Skin> skins;
+	uint32_t jointCount = 0;          // palette size per instance, all skins back to back
+	std::vector<uint8_t> leafJoint;   // per node: a joint with no joint children, skipped at low LOD
+	std::vector<float> morphWeights;          // default weights of every morphed node back to back
+	std::vector<uint32_t> morphWeightFirst;   // per node: its weights in morphWeights, UINT32_MAX if none
+	glm::vec3 boundsCenter = glm::vec3(0.0f);   // bounding sphere in instance space
+	float boundsRadius = 0.0f;
+	std::vector<DrawItem> drawItems;  // flattened once at load, shared by every instance
 
 	uint32_t baseMaterialIndex = 0;
-	uint32_t baseTextureIndex = 0;
-
-	~Model() {
-		for (auto node : linearNodes) {
-			delete node;
-		}
+	uint32_t materialCount = 0;
+	std::vector<uint32_t> textures;   // Scene::textures references held, in glTF image order
+
+	Model() = default;
+	Model(const Model&) = delete;
+	Model& operator=(const Model&) = delete;
+	Model(Model&&) = default;
+	Model& operator=(Model&&) = default;
+
+	uint32_t findNode(const StringTable& names, const std::string& name) const {
+		auto it = nodeByName.find(names.find(name));
+		return it != nodeByName.end() ? it->second : NODE_NONE;
 	}
+};
+
+// One morphed mesh of one instance: the blended copy the draw binds in place
+// of the mesh's shared vertex buffer
+struct MorphOutput {
+	uint32_t mesh;                    // Model::meshes index
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	std::vector<float> weights;       // what the buffer holds once submitted work has run, reblended only when these change
+	std::vector<float> recorded;      // blended by the latest recording, empty if it skipped this output
+};
+
+// Per-instance tweak of every material of the instance's model, applied
+// through the push constants so instances keep sharing descriptor sets
+struct MaterialOverride {
+	bool active = false;
+	glm::vec4 baseColorFactor = glm::vec4(1.0f);  // multiplies the material's
+	float metallicFactor = -1.0f;                 // replaces the material's when >= 0
+	float roughnessFactor = -1.0f;
+	bool transparent = false;                     // every item goes through the sorted transparent pass
+};
+
+// One placement of a Model in the world: only a transform and animation cursor,
+// everything heavy stays on the shared asset.
+struct ModelInstance {
+	ModelHandle model;
+	uint32_t slot = UINT32_MAX;       // Scene::instanceSlots entry that points back here
+	glm::mat4 transform = glm::mat4(1.0f);
+	uint32_t animationIndex = 0;
+	float animationTime = 0.0f;
+	float animationSpeed = 1.0f;
+	AnimationPose pose;               // empty for static models, which draw the asset's matrices
+	uint32_t jointBase = UINT32_MAX;  // this frame's palette slot in the joint buffer, UINT32_MAX = bind pose
+	AnimationLod lod = ANIMATION_LOD_FULL;
+	uint8_t lodPhase = 0;             // frames since the last sample at a reduced rate
+	float lodPendingTime = 0.0f;      // time not yet sampled while throttled or frozen
+	std::vector<MorphOutput> morph;   // one per morphed mesh, empty for models without morph targets
+	MaterialOverride material;
 
 	void translate(const glm::vec3& delta) {
 		transform = glm::translate(transform, delta);
@@ -409,58 +655,16 @@ struct Model {
 
 		transform = T * R * S;
 	}
+};
 
-	Node* findNode(const std::string& name) {
-		auto nodeIt = std::ranges::find_if(linearNodes, [&name](auto const& node) {
-			return node->name == name;
-			});
-		return (nodeIt != linearNodes.end()) ? *nodeIt : nullptr;
-	}
-
-	void updateAnimation(uint32_t index, float deltaTime) {
-		assert(!animations.empty() && index < animations.size());
-
-
-
-		Animation& animation = animations[index];
-		animation.currentTime += deltaTime;
-		if (animation.currentTime > animation.end) {
-			animation.currentTime = animation.start;
-		}
-
-		for (auto& channel : animation.channels) {
-			AnimationSampler& sampler = animation.samplers[channel.samplerIndex];
-
-			// Find the current key frame using binary search
-			auto keyFrameIt = std::ranges::lower_bound(sampler.inputs, animation.currentTime);
-			if (keyFrameIt != sampler.inputs.end() && keyFrameIt != sampler.inputs.begin()) {
-				size_t i = std::distance(sampler.inputs.begin(), keyFrameIt) - 1;
-				float t = (animation.currentTime - sampler.inputs[i]) / (sampler.inputs[i + 1] - sampler.inputs[i]);
-
-				switch (channel.path) {
-				case AnimationChannel::TRANSLATION: {
-					glm::vec3 start = sampler.outputsVec3[i];
-					glm::vec3 end = sampler.outputsVec3[i + 1];
-					channel.node->translation = glm::mix(start, end, t);
-					break;
-				}
-				case AnimationChannel::ROTATION: {
-					glm::quat start = glm::quat(sampler.outputsVec4[i].w, sampler.outputsVec4[i].x, sampler.outputsVec4[i].y, sampler.outputsVec4[i].z);
-					glm::quat end = glm::quat(sampler.outputsVec4[i + 1].w, sampler.outputsVec4[i + 1].x, sampler.outputsVec4[i + 1].y, sampler.outputsVec4[i + 1].z);
-					channel.node->rotation = glm::slerp(start, end, t);
-					break;
-				}
-				case AnimationChannel::SCALE: {
-					glm::vec3 start = sampler.outputsVec3[i];
-					glm::vec3 end = sampler.outputsVec3[i + 1];
-					channel.node->scale = glm::mix(start, end, t);
-					break;
-				}
-				}
-				break;
-			}
-		}
-	}
+// One draw of the transparent pass, gathered across instances each frame
+struct TransparentDraw {
+	const DrawItem* item;
+	const ModelInstance* instance;
+	const glm::mat4* nodeMatrix;
+	int jointOffset;
+	VkBuffer vertexBuffer;
+	float distanceToCamera;
 };
 
 typedef struct {
@@ -481,24 +685,210 @@ typedef struct {
 
 	VkDescriptorSet descriptorSet;
 	VkFormat format;
+	VkDeviceSize memorySize;            // device memory backing textureImage
+	VkDeviceSize uncompressedSize;      // RGBA8 size of the same mip chain, for comparison
+	uint64_t contentHash;               // key in Scene::textureRegistry
+	uint32_t refCount;                  // models sharing this texture, 0 = free slot
 
 }Texture;
 
-struct DrawItem {
-    const Node* node;
-    const Mesh* mesh;
-    float distanceToCamera;
-    bool transparent;
+// How a glTF image is sampled by the materials, which decides its block format
+enum struct TextureRole {
+	COLOR,          // baseColor / emissive -> BC7 sRGB
+	NORMAL,         // tangent-space normal -> BC5
+	PACKED_LINEAR,  // metallicRoughness / ORM -> BC7 UNORM
+	OCCLUSION,      // occlusion only -> BC4
+};
+
+// Everything that makes two VkSamplers interchangeable
+struct SamplerKey {
+	VkFilter magFilter = VK_FILTER_LINEAR;
+	VkFilter minFilter = VK_FILTER_LINEAR;
+	VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	VkSamplerAddressMode addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	float maxAnisotropy = 0.0f;        // 0 = anisotropy disabled
+	float mipLodBias = 0.0f;
+	float minLod = 0.0f;
+	float maxLod = VK_LOD_CLAMP_NONE;
+
+	bool operator==(const SamplerKey&) const = default;
+};
+struct SamplerKeyHash {
+	size_t operator()(const SamplerKey& key) const {
+		size_t h = 0;
+		auto mix = [&h](size_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+		mix(key.magFilter); mix(key.minFilter); mix(key.mipmapMode);
+		mix(key.addressModeU); mix(key.addressModeV); mix(key.addressModeW);
+		mix(std::hash<float>{}(key.maxAnisotropy)); mix(std::hash<float>{}(key.mipLodBias));
+		mix(std::hash<float>{}(key.minLod)); mix(std::hash<float>{}(key.maxLod));
+		return h;
+	}
+};
+
+struct SamplerCache {
+	struct Entry {
+		VkSampler sampler = VK_NULL_HANDLE;
+		uint32_t refCount = 0;
+	};
+	std::unordered_map<SamplerKey, Entry, SamplerKeyHash> entries;
+	uint32_t requested = 0;
+};
+
+// Content hash -> index into Scene::textures, so identical images are uploaded once
+// A hash hit only counts once the source bytes and tag match as well, so two
+// images that collide in 64 bits still get their own textures
+struct TextureRegistryEntry {
+	uint32_t index;                     // into Scene::textures
+	uint32_t tag;                       // what else went into the hash (the TextureRole)
+	uint64_t check;                     // textureContentCheck of the source, independent of the key
+	uint64_t size;                      // source size in bytes
 };
 
+struct TextureRegistry {
+	std::unordered_multimap<uint64_t, TextureRegistryEntry> byHash;
+	uint32_t requested = 0;
+};
+
+// Vertex animation texture: one clip pre-skinned at a fixed rate. Texel
+// (vertexBase[mesh] + vertex, frame) holds that vertex in instance space.
+struct VatBake {
+	uint32_t width = 0;                // vertices per frame, every mesh back to back
+	uint32_t frameCount = 0;
+	float frameRate = 30.0f;
+	std::vector<uint32_t> vertexBase;  // per Model::meshes entry
+	std::vector<glm::vec4> positions;  // RGBA32F, width * frameCount
+	std::vector<uint16_t> normals;     // RGBA16F, width * frameCount * 4
+};
+
+// std430, matches VatInstance in shader.vert
+struct VatInstance {
+	glm::mat4 transform;
+	glm::vec4 playback;                // x = start frame, y = frames per second
+};
+
+// Thousands of copies of one clip: placement and phase live on the GPU, the
+// CPU does no per-instance work after creation
+struct VatCrowd {
+	ModelHandle model;
+	uint32_t instanceCount = 0;
+	VatBake bake;                      // texel data is dropped after upload
+
+	VkImage positionImage = VK_NULL_HANDLE;
+	VkDeviceMemory positionMemory = VK_NULL_HANDLE;
+	VkImageView positionView = VK_NULL_HANDLE;
+	VkImage normalImage = VK_NULL_HANDLE;
+	VkDeviceMemory normalMemory = VK_NULL_HANDLE;
+	VkImageView normalView = VK_NULL_HANDLE;
+	VkSampler sampler = VK_NULL_HANDLE;
+	VkBuffer instanceBuffer = VK_NULL_HANDLE;   // VatInstance per crowd member, set 0 binding 4
+	VkDeviceMemory instanceMemory = VK_NULL_HANDLE;
+};
+
+// Point light as the shader reads it; unused slots have zero intensity
+constexpr uint32_t SCENE_LIGHTS_MAX = 4;
+
+struct SceneLight {
+	glm::vec3 position = glm::vec3(0.0f);
+	float radius = 0.0f;
+	glm::vec3 color = glm::vec3(0.0f);
+	float intensity = 0.0f;
+};
+
+// Stable reference to an instance. Scene::instances stays packed and moves
+// instances when one is destroyed, handles resolve through Scene::instanceSlots.
+struct InstanceHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool operator==(const InstanceHandle&) const = default;
+};
+
+struct InstanceSlot {
+	uint32_t instance = UINT32_MAX;   // position in Scene::instances, UINT32_MAX = free
+	uint32_t generation = 0;          // bumped every time the slot is freed
+};
+
+// Destroyed instance whose GPU resources may still be read by frames in flight
+struct InstanceRetired {
+	ModelInstance instance;
+	uint32_t framesLeft;              // fence waits until nothing in flight can reference it
+};
+
+// Run of Scene::materials a released model gave back
+struct MaterialRange {
+	uint32_t first;
+	uint32_t count;
+};
 
 struct Scene {
 	int defaultTextureIndex = 0;
 
-	std::vector<Model> models;
+	std::deque<Model> models;         // slots are reused, always reach them through a ModelHandle
+	std::unordered_map<std::string, ModelHandle> modelCache;   // path -> live asset
+	StringTable names;                // node names of every model
+	std::vector<ModelInstance> instances;   // packed, reach a specific one through an InstanceHandle
+	std::vector<InstanceSlot> instanceSlots;
+	std::vector<uint32_t> instanceSlotsFree;
+	std::vector<InstanceRetired> instancesRetired;
 	std::vector<Texture> textures;
 	std::vector<Material> materials;
+	std::vector<MaterialRange> materialRangesFree;   // sorted by first, neighbours merged
 	Camera camera;
+
+	TextureRegistry textureRegistry;
+	SamplerCache samplerCache;
+
+	std::array<uint32_t, ANIMATION_LOD_COUNT> animationLodCounts{};   // animated instances per tier, this frame
+	VatCrowd crowd;                   // empty unless config.vatInstanceCount > 0
+
+	std::array<SceneLight, SCENE_LIGHTS_MAX> lights = { {
+		{ glm::vec3(5.0f, 5.0f, 0.0f), 0.0f, glm::vec3(300.0f, 300.0f, 300.0f), 1.0f },
+		{ glm::vec3(0.0f, 5.0f, 5.0f), 0.0f, glm::vec3(0.0f, 0.0f, 300.0f), 1.0f },
+		{ glm::vec3(5.0f, 0.0f, 5.0f), 0.0f, glm::vec3(300.0f, 0.0f, 0.0f), 1.0f },
+		{ glm::vec3(0.0f, 5.0f, 0.0f), 0.0f, glm::vec3(0.0f, 300.0f, 0.0f), 1.0f },
+	} };
+};
+
+// Scene file, see scene.cpp. Parents resolve at load: instances are flat at runtime.
+struct SceneEntry {
+	std::string model;
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::vec3 rotation = glm::vec3(0.0f);   // euler degrees
+	glm::vec3 scale = glm::vec3(1.0f);
+	int32_t parent = -1;                     // earlier entry this one is placed relative to
+	MaterialOverride material;
+};
+
+enum SceneLayout : uint32_t {
+	SCENE_LAYOUT_GRID,
+	SCENE_LAYOUT_CLUSTERS,
+};
+
+// Stress scene recipe, expanded into entries by sceneGenerate
+struct SceneGenerator {
+	SceneLayout layout = SCENE_LAYOUT_GRID;
+	uint32_t count = 0;                      // instances, hierarchy links included
+	std::vector<std::string> models;         // used round-robin
+	glm::vec3 origin = glm::vec3(0.0f);
+	float spacing = 1.0f;                    // between grid cells, or cluster spread
+	float scale = 1.0f;
+	uint32_t depth = 1;                      // instances per parent chain, > 1 builds hierarchies
+	uint32_t materials = 0;                  // distinct tints handed out round-robin, 0 = the models' own
+	float transparent = 0.0f;                // fraction moved to the transparent pass at half alpha
+	uint32_t clusters = 16;
+	uint32_t seed = 1;
+};
+
+struct SceneDescription {
+	std::string name;
+	std::vector<SceneEntry> entries;
+	std::vector<SceneLight> lights;          // empty keeps Scene::lights
+	bool camera = false;                     // false keeps the current camera
+	glm::vec3 cameraPosition = glm::vec3(0.0f);
+	float cameraYaw = 90.0f;
+	float cameraPitch = 0.0f;
 };
 
 struct Input {
@@ -525,9 +915,125 @@ typedef struct {
 	const std::string KOBOLD_MODEL_PATH;
 	const std::string HOVER_BIKE_MODEL_PATH;
 	const std::string MODEL_PATH;
+	const std::string FOX_MODEL_PATH;
+	uint32_t foxInstanceCount;    // extra Fox.glb instances laid out on a grid
+	uint32_t workerThreadCount;   // 0 = hardware concurrency - 1
+	bool textureCompression;      // cook glTF images to BC formats (cached as .ktx2 next to the model)
+	bool animationCompression;    // thin and quantize glTF animation keys at load
+	uint32_t vatInstanceCount;    // Fox.glb crowd drawn from baked vertex animation textures
+	bool sceneFlatten;            // collapse static transform-only node chains at load
+	bool headless;                // no window or surface: offscreen images of windowWidth x windowHeight
+	uint32_t headlessFrameCount;  // frames drawn before a headless run exits
+	std::string headlessDumpDir;  // headless frames written here as PPM, empty = no readback
+	bool gpuStatistics;           // pipeline statistics queries next to the GPU timestamps
+	std::string tracePath;        // CPU zones written here as Chrome trace JSON on exit and on F9
+	std::string scenePath;        // instances, lights and camera loaded by windowCreate
+	bool coldStart;               // ignore on-disk caches (cooked textures, pipeline cache), as on a first run
+	std::string pipelineCachePath; // VkPipelineCache data kept between runs, empty = no cache
 
 }Config;
 
+// Entry points of everything the frame and upload paths record or submit.
+// Defaults to the loader's functions; nullDeviceCreate swaps in a recorder
+// that counts and validates without a GPU (see commands.cpp).
+struct CommandTable {
+	PFN_vkAllocateCommandBuffers allocateCommandBuffers = vkAllocateCommandBuffers;
+	PFN_vkFreeCommandBuffers freeCommandBuffers = vkFreeCommandBuffers;
+	PFN_vkBeginCommandBuffer beginCommandBuffer = vkBeginCommandBuffer;
+	PFN_vkEndCommandBuffer endCommandBuffer = vkEndCommandBuffer;
+	PFN_vkQueueSubmit queueSubmit = vkQueueSubmit;
+	PFN_vkQueueWaitIdle queueWaitIdle = vkQueueWaitIdle;
+
+	PFN_vkCmdBeginRenderPass cmdBeginRenderPass = vkCmdBeginRenderPass;
+	PFN_vkCmdEndRenderPass cmdEndRenderPass = vkCmdEndRenderPass;
+	PFN_vkCmdSetViewport cmdSetViewport = vkCmdSetViewport;
+	PFN_vkCmdSetScissor cmdSetScissor = vkCmdSetScissor;
+	PFN_vkCmdBindPipeline cmdBindPipeline = vkCmdBindPipeline;
+	PFN_vkCmdBindDescriptorSets cmdBindDescriptorSets = vkCmdBindDescriptorSets;
+	PFN_vkCmdPushConstants cmdPushConstants = vkCmdPushConstants;
+	PFN_vkCmdBindVertexBuffers cmdBindVertexBuffers = vkCmdBindVertexBuffers;
+	PFN_vkCmdBindIndexBuffer cmdBindIndexBuffer = vkCmdBindIndexBuffer;
+	PFN_vkCmdDrawIndexed cmdDrawIndexed = vkCmdDrawIndexed;
+	PFN_vkCmdDispatch cmdDispatch = vkCmdDispatch;
+	PFN_vkCmdPipelineBarrier cmdPipelineBarrier = vkCmdPipelineBarrier;
+	PFN_vkCmdCopyBuffer cmdCopyBuffer = vkCmdCopyBuffer;
+	PFN_vkCmdCopyBufferToImage cmdCopyBufferToImage = vkCmdCopyBufferToImage;
+	PFN_vkCmdCopyImageToBuffer cmdCopyImageToBuffer = vkCmdCopyImageToBuffer;
+	PFN_vkCmdBlitImage cmdBlitImage = vkCmdBlitImage;
+	PFN_vkCmdResetQueryPool cmdResetQueryPool = vkCmdResetQueryPool;
+	PFN_vkCmdWriteTimestamp cmdWriteTimestamp = vkCmdWriteTimestamp;
+	PFN_vkCmdBeginQuery cmdBeginQuery = vkCmdBeginQuery;
+	PFN_vkCmdEndQuery cmdEndQuery = vkCmdEndQuery;
+};
+
+// Null device: the VkDevice, VkQueue and VkCommandBuffer handles point at
+// these. Commands are counted per type and checked against the state the
+// buffer is in; nothing is executed.
+enum NullCommand : uint32_t {
+	NULL_CMD_BEGIN_RENDER_PASS,
+	NULL_CMD_END_RENDER_PASS,
+	NULL_CMD_SET_VIEWPORT,
+	NULL_CMD_SET_SCISSOR,
+	NULL_CMD_BIND_PIPELINE,
+	NULL_CMD_BIND_DESCRIPTOR_SETS,
+	NULL_CMD_PUSH_CONSTANTS,
+	NULL_CMD_BIND_VERTEX_BUFFERS,
+	NULL_CMD_BIND_INDEX_BUFFER,
+	NULL_CMD_DRAW_INDEXED,
+	NULL_CMD_DISPATCH,
+	NULL_CMD_PIPELINE_BARRIER,
+	NULL_CMD_COPY_BUFFER,
+	NULL_CMD_COPY_BUFFER_TO_IMAGE,
+	NULL_CMD_COPY_IMAGE_TO_BUFFER,
+	NULL_CMD_BLIT_IMAGE,
+	NULL_CMD_RESET_QUERY_POOL,
+	NULL_CMD_WRITE_TIMESTAMP,
+	NULL_CMD_BEGIN_QUERY,
+	NULL_CMD_END_QUERY,
+	NULL_CMD_COUNT
+};
+
+struct NullCounters {
+	std::array<uint64_t, NULL_CMD_COUNT> commands{};
+	uint64_t indices = 0;             // indexCount * instanceCount over every draw
+	uint64_t workgroups = 0;
+	uint64_t pushConstantBytes = 0;
+	uint64_t errors = 0;
+	const char* firstError = nullptr; // string literal
+};
+
+struct NullDevice;
+
+struct NullCommandBuffer {
+	NullDevice* device;
+	bool recording = false;
+	bool inRenderPass = false;
+	VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+	VkPipeline computePipeline = VK_NULL_HANDLE;
+	uint32_t graphicsSets = 0;        // bit per descriptor set bound
+	uint32_t computeSets = 0;
+	uint32_t vertexBindings = 0;      // bit per vertex binding
+	bool indexBound = false;
+	uint32_t activeQueries = 0;
+	NullCounters counters;            // since vkBeginCommandBuffer
+};
+
+struct NullDevice {
+	uint64_t commandBuffersLive = 0;
+	uint64_t submits = 0;
+	NullCounters submitted;           // every submitted buffer's counters summed
+	uint64_t errors = 0;              // recorded or submitted, whether or not the buffer reached the queue
+	const char* firstError = nullptr;
+};
+
+// What the pipeline cache did for this run
+struct PipelineCacheStats {
+	uint64_t loadedBytes = 0;         // 0 = started empty
+	uint64_t savedHash = 0;           // of the data last loaded or written, to skip unchanged writes
+	uint32_t pipelines = 0;           // created through pipelineGraphicsCreate / pipelineComputeCreate
+	double createMs = 0.0;            // spent in vkCreate*Pipelines
+};
+
 typedef struct {
 	uint32_t queueFamilyIndex;
 	uint32_t presentFamilyIndex;
@@ -537,6 +1043,16 @@ typedef struct {
 	VkDevice device;
 	VkQueue queue;
 	VkQueue presentQueue;
+	bool textureCompressionBC;
+	bool textureCompressionETC2;
+	bool textureCompressionASTC;
+	float timestampPeriod;        // ns per timestamp tick, 0 if the queue can't write timestamps
+	bool pipelineStatisticsQuery; // enabled when config.gpuStatistics asked and the device has it
+	bool memoryBudget;            // VK_EXT_memory_budget enabled: per-heap usage and budget
+	PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2;  // null without properties2
+	VkPipelineCache pipelineCache; // shared by every pipeline and ImGui, VK_NULL_HANDLE without one
+	PipelineCacheStats pipelineCacheStats;
+	CommandTable vk;              // recording and submission, see CommandTable
 }Context;
 
 typedef struct {
@@ -571,6 +1087,16 @@ typedef struct {
 	bool framebufferResized;
 }Window;
 
+// Offscreen stand-in for the swapchain, see headless.cpp
+typedef struct {
+	std::vector<VkDeviceMemory> imageMemory;    // backs Swapchain::images
+	std::vector<VkBuffer> readbackBuffers;      // per frame in flight, only when dumping
+	std::vector<VkDeviceMemory> readbackMemory;
+	std::vector<void*> readbackMapped;
+	std::vector<int64_t> readbackFrame;         // frame waiting in each buffer, -1 if none
+	uint64_t frame;                             // frames submitted so far
+}Headless;
+
 typedef struct {
 	VkCommandBuffer* commandBuffer;
 	VkFramebuffer* framebuffers;
@@ -587,6 +1113,90 @@ typedef struct {
 
 
 
+// GPU profiler: begin/end timestamps around named passes, one ring slot of
+// queries per frame in flight, read back once that slot's fence has signalled
+constexpr uint32_t GPU_SCOPES_MAX = 16;             // scopes one frame can record
+
+// Pipeline statistics gathered per scope, in VkQueryPipelineStatisticFlagBits order
+enum GpuStatistic : uint32_t {
+	GPU_STAT_VERTEX_INVOCATIONS,
+	GPU_STAT_CLIPPING_INVOCATIONS,
+	GPU_STAT_CLIPPING_PRIMITIVES,
+	GPU_STAT_FRAGMENT_INVOCATIONS,
+	GPU_STAT_COUNT
+};
+
+struct GpuScope {
+	const char* name;                               // string literal, compared by content
+	int32_t statisticsQuery = -1;                   // index within the slot, -1 = timestamps only
+	double ms = 0.0;
+	std::array<uint64_t, GPU_STAT_COUNT> statistics{};
+};
+
+struct GpuProfiler {
+	VkQueryPool timestampPool = VK_NULL_HANDLE;     // 2 * GPU_SCOPES_MAX per frame in flight
+	VkQueryPool statisticsPool = VK_NULL_HANDLE;    // GPU_SCOPES_MAX per frame in flight, optional
+	std::vector<std::vector<GpuScope>> slots;       // scopes recorded into each frame slot
+	std::vector<uint32_t> slotStatistics;           // statistics queries used by each slot
+	bool statisticsActive = false;                  // one statistics query may be open at a time
+	std::vector<GpuScope> results;                  // last frame read back, in recording order
+	uint64_t framesRead = 0;
+};
+
+// CPU time per phase of one frame, in ms
+struct FrameTimings {
+	double wait = 0.0;      // in-flight fence + image acquire
+	double update = 0.0;    // animation poses and joint palettes
+	double gather = 0.0;    // transparent draws collected and sorted
+	double record = 0.0;    // the rest of command buffer recording
+	double submit = 0.0;
+	double present = 0.0;   // vkQueuePresentKHR, 0 when headless
+};
+
+// Per-frame render counters for the stats panel and the benchmark harness.
+// renderStatsFrameBegin clears them; they are bumped where commands are recorded.
+constexpr uint32_t RENDER_STATS_HISTORY = 240;      // frames in the rolling graphs
+
+struct RenderStats {
+	uint32_t drawCalls = 0;
+	uint32_t dispatches = 0;
+	uint64_t instances = 0;                         // summed instanceCount of every draw
+	uint64_t triangles = 0;                         // submitted, instances included
+	uint64_t trianglesCulled = 0;                   // clipped away on the GPU, only with pipeline statistics
+	uint32_t pipelineBinds = 0;
+	uint32_t descriptorBinds = 0;
+	uint64_t pushConstantBytes = 0;
+	uint32_t uploads = 0;                           // single-time submits since the last frame
+	uint64_t uploadsTotal = 0;
+	double uploadWaitMs = 0.0;                      // vkQueueWaitIdle / upload fence behind those submits
+	double fenceWaitMs = 0.0;                       // host blocked in vkWaitForFences
+	double acquireMs = 0.0;                         // host blocked in vkAcquireNextImageKHR
+
+	//Memory per heap, refreshed every few frames
+	uint32_t heapCount = 0;
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapSize{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapUsage{};   // 0 without VK_EXT_memory_budget
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapBudget{};  // heap size without it
+	std::array<bool, VK_MAX_MEMORY_HEAPS> heapDeviceLocal{};
+
+	//Rolling frame times, ring indexed by historyHead
+	std::array<float, RENDER_STATS_HISTORY> cpuFrameMs{};
+	std::array<float, RENDER_STATS_HISTORY> gpuFrameMs{};
+	uint32_t historyHead = 0;                       // next slot written, also the oldest
+	uint64_t frames = 0;
+	std::chrono::steady_clock::time_point lastFrameEnd{};
+};
+
+// While a batch is open the single-time helpers record into its command
+// buffer instead of submitting, and staging buffers wait for its fence
+struct UploadBatch {
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;
+	std::vector<std::pair<VkBuffer, VkDeviceMemory>> staging;
+	VkDeviceSize stagingBytes = 0;
+	uint32_t recorded = 0;                          // helper calls folded into the batch
+};
+
 struct Renderer {
 	//Sorting
 	std::vector<DrawItem> opaqueDrawItems;
@@ -606,6 +1216,28 @@ struct Renderer {
 	std::vector<VkBuffer> uniformBuffers;
 	std::vector<VkDeviceMemory> uniformBuffersMemory;
 	std::vector<void*> uniformBuffersMapped;
+
+	//Skinning: one joint palette buffer per frame in flight, set 0 binding 1
+	std::vector<VkBuffer> jointBuffers;
+	std::vector<VkDeviceMemory> jointBuffersMemory;
+	std::vector<void*> jointBuffersMapped;
+	std::vector<uint32_t> jointCapacity;              // matrices per buffer, each grows on its own frame
+	uint32_t jointsInUse = 0;                         // matrices written this frame
+	double animationCpuMs = 0.0;                      // poses + palettes on the job system, last frame
+	FrameTimings timings;                             // CPU phases of the last frame
+	GpuProfiler profiler;                             // GPU time per pass, a few frames late
+	RenderStats stats;                                // counters of the frame being recorded
+	UploadBatch uploadBatch;                          // open only while a model's textures upload
+
+	//Morph targets: compute blend into per-instance vertex buffers
+	VkShaderModule morphShaderModule = VK_NULL_HANDLE;
+	VkDescriptorSetLayout morphSetLayout = VK_NULL_HANDLE;
+	VkPipelineLayout morphPipelineLayout = VK_NULL_HANDLE;
+	VkPipeline morphPipeline = VK_NULL_HANDLE;
+	VkDescriptorPool morphDescriptorPool = VK_NULL_HANDLE;
+	uint32_t morphBlends = 0;                         // outputs reblended this frame
+	uint32_t morphCacheHits = 0;                      // outputs whose weights did not change
+	uint32_t morphDeltasApplied = 0;                  // sparse entries dispatched this frame
 	
 	//Shaders
 	VkShaderModule vertShaderModule;
@@ -625,9 +1257,117 @@ struct Renderer {
 	
 };
 
+// One point of a scripted or recorded camera path
+struct CameraKey {
+	float time;
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+};
+
+// Scripted benchmark run, loaded by frameBenchLoad from a JSON description
+struct FrameBench {
+	std::string path;                  // description file, empty = interactive run
+	std::string name;
+	std::vector<CameraKey> cameraPath;
+	bool loop = true;                  // wrap around the path instead of holding the last key
+	uint32_t warmupFrames = 60;
+	uint32_t measuredFrames = 600;
+	float timestep = 1.0f / 60.0f;
+	float threshold = 0.10f;           // allowed slowdown against the baseline, as a fraction
+	std::string outputPath;            // results JSON, printed to stdout if empty
+	std::string baselinePath;          // earlier results to compare against
+	bool regressed = false;            // set by the comparison, main exits with 1
+
+	// --record-path: the interactive camera sampled into a path file on exit
+	std::string recordPath;
+	std::vector<CameraKey> recording;
+	float recordClock = 0.0f;
+};
+
+// Worker pool shared by loaders and per-frame updates
+struct JobSystem {
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> queue;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+	uint32_t pending = 0;
+	bool stop = false;
+};
+
+// Telemetry handed from the render thread to the metrics exporter
+enum MetricsSampleType : uint32_t {
+	METRICS_FRAME,                     // value = CPU frame ms, value2 = GPU frame ms (0 if unknown)
+	METRICS_MEMORY,                    // index = heap, value = usage bytes, value2 = budget bytes
+	METRICS_LOAD,                      // label = model file, value = load ms
+	METRICS_SWAPCHAIN_RECREATE,
+};
+
+struct MetricsSample {
+	MetricsSampleType type;
+	uint32_t index = 0;
+	double value = 0.0;
+	double value2 = 0.0;
+	char label[48] = {};
+};
+
+// Single producer (the main thread), single consumer (the exporter thread)
+constexpr uint32_t METRICS_RING_SIZE = 4096;
+constexpr uint32_t METRICS_BUCKET_COUNT = 9;         // frame-time histogram, +Inf included
+
+struct MetricsHistogram {
+	std::array<uint64_t, METRICS_BUCKET_COUNT> buckets{};  // not cumulative, rendered cumulative
+	double sum = 0.0;                                      // seconds
+	uint64_t count = 0;
+};
+
+// Running totals since start, owned by whoever drains the ring
+struct MetricsAggregate {
+	MetricsHistogram cpuFrame;
+	MetricsHistogram gpuFrame;
+	uint32_t heapCount = 0;
+	std::array<double, VK_MAX_MEMORY_HEAPS> heapUsage{};
+	std::array<double, VK_MAX_MEMORY_HEAPS> heapBudget{};
+	std::vector<std::pair<std::string, double>> loads;     // model file, last load ms
+	uint64_t loadCount = 0;
+	uint64_t swapchainRecreations = 0;
+};
+
+struct Metrics {
+	std::array<MetricsSample, METRICS_RING_SIZE> ring;
+	std::atomic<uint64_t> head{ 0 };                       // written by the producer
+	std::atomic<uint64_t> tail{ 0 };                       // written by the consumer
+	std::atomic<uint64_t> dropped{ 0 };                    // samples lost to a full ring
+	MetricsAggregate aggregate;
+
+	std::string path;                                      // Prometheus text file, empty = off
+	float interval = 10.0f;                                // seconds between writes
+	std::thread exporter;
+	std::mutex mutex;                                      // guards stop, never taken per frame
+	std::condition_variable wake;
+	bool stop = false;
+	std::chrono::steady_clock::time_point start{};
+	uint64_t frames = 0;                                   // producer side, paces memory samples
+};
+
+// Time to first frame, one lap per init phase
+struct StartupPhase {
+	const char* name;
+	double ms;
+};
+struct Startup {
+	std::chrono::steady_clock::time_point start{};         // top of main
+	std::chrono::steady_clock::time_point lap{};           // end of the last phase
+	std::vector<StartupPhase> phases;
+	double firstFrameMs = 0.0;                             // 0 until the first frame finished on the GPU
+	std::string reportPath;                                // phases written here as JSON, then the app exits
+};
+
 typedef struct {
 	Config config;
 	Window window;
+	Headless headless;
 	Context context;
 	Renderer renderer;
 	Buffers buffers;
@@ -635,6 +1375,10 @@ typedef struct {
 	Texture texture;
 	Mesh mesh;
 	Gui gui;
+	JobSystem jobs;
+	FrameBench frameBench;
+	Metrics metrics;
+	Startup startup;
 }State;
 
 enum SwapchainBuffering {
@@ -1,16 +1,20 @@
 #include "buffers.h"
+#include <ktx.h>
 //Utility
 VkFormat findSupportedFormat(State *state, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 VkFormat findDepthFormat(State* state);
 bool hasStencilComponent(VkFormat format);
+bool textureFormatSupported(State* state, VkFormat format);
 //Textures
 void imageCreate(State* state, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, uint32_t mipLevels, VkSampleCountFlagBits numSamples);
 
 void transitionImageLayout(State* state, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels);
 void transitionSwapchainImagesToPresent(State* state);
 void copyBufferToImage(State * state, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+void copyBufferToImageLevels(State* state, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions);
 
 void textureImageCreate(State* state, std::string texturePath);
+void textureUploadKtx(State* state, ktxTexture* kTexture, Texture& outTex);
 void textureImageDestroy(State* state);
 
 VkImageView imageViewCreate(State* state, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
@@ -21,7 +25,20 @@ void textureImageViewDestroy(State* state);
 void textureSamplerCreate(State* state);
 void textureSamplerDestroy(State* state);
 
+//Sampler cache
+VkSampler samplerAcquire(State* state, const SamplerKey& key);
+void samplerRelease(State* state, VkSampler sampler);
+void samplerCacheDestroy(State* state);
+
+//Texture registry
+uint64_t textureContentHash(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+uint64_t textureContentCheck(const void* data, size_t size);
+int textureRegistryAcquire(State* state, uint64_t hash, uint64_t check, size_t size, uint32_t tag);
+uint32_t textureRegistryInsert(State* state, uint64_t hash, uint64_t check, size_t size, uint32_t tag, const Texture& texture);
+void textureRelease(State* state, uint32_t index);
+
 void createTextureFromMemory(State* state,const unsigned char* pixels, size_t size, int width, int height, int channels, Texture& outTex);
+void createTextureFromKtx(State* state, ktxTexture* kTexture, Texture& outTex);
 void destroyTextures(State* state); 
 
 
@@ -31,4 +48,12 @@ void colorResourceDestroy(State* state);
 void depthResourceCreate(State* state);
 void depthBufferDestroy(State* state);
 
+//Block compression
+VkFormat textureRoleFormat(TextureRole role);
+const char* textureRoleName(TextureRole role);
+ktxTexture2* textureCook(const unsigned char* pixels, uint32_t width, uint32_t height, TextureRole role);
+ktx_transcode_fmt_e basisTranscodeTargetSelect(State* state);
+bool textureTranscodeBasis(ktxTexture2* texture, ktx_transcode_fmt_e target);
+bool textureIsKtx2(const unsigned char* bytes, size_t size);
+
 void generateMipmaps(State* state, VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
\ No newline at end of file
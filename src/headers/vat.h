@@ -0,0 +1,13 @@
+#pragma once
+#include "stateMachine.h"
+#include "textures.h"
+#include "skinning.h"
+
+//Bake
+void vatBake(const Model& model, uint32_t clip, float frameRate, VatBake& out);
+size_t vatBakeMemory(const VatBake& bake);
+
+//Crowd
+void vatCrowdCreate(State* state, uint32_t instanceCount);
+void vatCrowdDraw(State* state, VkCommandBuffer cmd);
+void vatCrowdDestroy(State* state);
@@ -1,5 +1,12 @@
 #include "context.h"
 #include "renderer.h"
+#include "skinning.h"
+#include "vat.h"
+#include "headless.h"
+#include "gpuProfiler.h"
+#include "renderStats.h"
+#include "metrics.h"
+#include "startup.h"
 
 
 //Error Handling
@@ -35,7 +42,7 @@ void swapchainRecreate(State* state);
 
 //Draw
 
-void frameDraw(State* state);
+void frameDraw(State* state, float deltaTime);
 
 void updateFPS(State* state);
 void processInput(State* state);
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "headers/headless.h"
+#include "headers/gpuProfiler.h"
+#include "headers/renderStats.h"
+#include "headers/startup.h"
+#include <filesystem>
+
+//Targets
+// The images take the swapchain's place: imageViewsCreate, the framebuffers and
+// the render pass use them unchanged. One image per frame in flight, so the
+// frame's fence also guards its image and readback buffer.
+void headlessTargetsCreate(State* state) {
+	Swapchain& swapchain = state->window.swapchain;
+	Headless& headless = state->headless;
+	uint32_t count = state->config.swapchainBuffering;
+
+	// What surfaceFormatSelect prefers, so the pipelines match a windowed run
+	swapchain.handle = VK_NULL_HANDLE;
+	swapchain.format = VK_FORMAT_B8G8R8A8_SRGB;
+	swapchain.colorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
+	swapchain.imageExtent = { state->config.windowWidth, state->config.windowHeight };
+	swapchain.imageCount = count;
+	swapchain.images.resize(count);
+	headless.imageMemory.resize(count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		imageCreate(state, swapchain.imageExtent.width, swapchain.imageExtent.height, swapchain.format, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			swapchain.images[i], headless.imageMemory[i], 1, VK_SAMPLE_COUNT_1_BIT);
+	}
+
+	headless.frame = 0;
+	if (state->config.headlessDumpDir.empty()) return;
+
+	std::filesystem::create_directories(state->config.headlessDumpDir);
+	VkDeviceSize size = (VkDeviceSize)swapchain.imageExtent.width * swapchain.imageExtent.height * 4;
+	headless.readbackBuffers.resize(count);
+	headless.readbackMemory.resize(count);
+	headless.readbackMapped.resize(count);
+	headless.readbackFrame.assign(count, -1);
+	for (uint32_t i = 0; i < count; i++) {
+		createBuffer(state, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			headless.readbackBuffers[i], headless.readbackMemory[i]);
+		vkMapMemory(state->context.device, headless.readbackMemory[i], 0, size, 0, &headless.readbackMapped[i]);
+	}
+}
+
+// Image views and framebuffers go with swapchainCleanup, as in a windowed run
+void headlessTargetsDestroy(State* state) {
+	Headless& headless = state->headless;
+	for (size_t i = 0; i < headless.imageMemory.size(); i++) {
+		vkDestroyImage(state->context.device, state->window.swapchain.images[i], nullptr);
+		vkFreeMemory(state->context.device, headless.imageMemory[i], nullptr);
+	}
+	for (size_t i = 0; i < headless.readbackBuffers.size(); i++) {
+		vkUnmapMemory(state->context.device, headless.readbackMemory[i]);
+		vkDestroyBuffer(state->context.device, headless.readbackBuffers[i], nullptr);
+		vkFreeMemory(state->context.device, headless.readbackMemory[i], nullptr);
+	}
+	state->window.swapchain.images.clear();
+	headless = Headless{};
+}
+
+//Readback
+// Recorded where a windowed frame draws the GUI. The render pass leaves the
+// resolved image in TRANSFER_SRC_OPTIMAL when headless.
+void headlessReadbackRecord(State* state, VkCommandBuffer cmd) {
+	Headless& headless = state->headless;
+	if (headless.readbackBuffers.empty()) return;
+
+	uint32_t frame = state->renderer.frameIndex;
+	VkImage image = state->window.swapchain.images[state->renderer.imageAquiredIndex];
+	VkExtent2D extent = state->window.swapchain.imageExtent;
+
+	VkImageMemoryBarrier imageBarrier{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+		.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.image = image,
+		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+	};
+	state->context.vk.cmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+	VkBufferImageCopy region{
+		.bufferOffset = 0,
+		.bufferRowLength = 0,
+		.bufferImageHeight = 0,
+		.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+		.imageOffset = { 0, 0, 0 },
+		.imageExtent = { extent.width, extent.height, 1 },
+	};
+	state->context.vk.cmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, headless.readbackBuffers[frame], 1, &region);
+
+	VkBufferMemoryBarrier bufferBarrier{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.buffer = headless.readbackBuffers[frame],
+		.offset = 0,
+		.size = VK_WHOLE_SIZE,
+	};
+	state->context.vk.cmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+		0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+	headless.readbackFrame[frame] = (int64_t)headless.frame;
+}
+
+// Writes what the slot read back the last time it was submitted. Only
+// called once the slot's fence has signalled.
+static void headlessDumpWrite(State* state, uint32_t slot) {
+	Headless& headless = state->headless;
+	if (headless.readbackFrame.empty() || headless.readbackFrame[slot] < 0) return;
+
+	VkExtent2D extent = state->window.swapchain.imageExtent;
+	char path[512];
+	snprintf(path, sizeof(path), "%s/frame_%05lld.ppm", state->config.headlessDumpDir.c_str(), (long long)headless.readbackFrame[slot]);
+	headless.readbackFrame[slot] = -1;
+
+	FILE* file = fopen(path, "wb");
+	if (!file) {
+		fprintf(stderr, "headless: cannot write %s\n", path);
+		return;
+	}
+
+	// B8G8R8A8 texels to binary PPM rows
+	const uint8_t* texels = static_cast<const uint8_t*>(headless.readbackMapped[slot]);
+	std::vector<uint8_t> row(extent.width * 3);
+	fprintf(file, "P6\n%u %u\n255\n", extent.width, extent.height);
+	for (uint32_t y = 0; y < extent.height; y++) {
+		const uint8_t* src = texels + (size_t)y * extent.width * 4;
+		for (uint32_t x = 0; x < extent.width; x++) {
+			row[x * 3 + 0] = src[x * 4 + 2];
+			row[x * 3 + 1] = src[x * 4 + 1];
+			row[x * 3 + 2] = src[x * 4 + 0];
+		}
+		fwrite(row.data(), 1, row.size(), file);
+	}
+	fclose(file);
+}
+
+// Pending readbacks of every slot, once the device is idle
+void headlessDumpFlush(State* state) {
+	for (uint32_t slot = 0; slot < state->headless.readbackFrame.size(); slot++) {
+		headlessDumpWrite(state, slot);
+	}
+}
+
+//Draw
+// frameDraw without acquire and present: images rotate with the frame index
+// and nothing waits on semaphores, the per-frame fences pace the CPU.
+void headlessFrameDraw(State* state, float deltaTime) {
+	PROFILE_FUNCTION();
+	using Clock = std::chrono::high_resolution_clock;
+	FrameTimings& timings = state->renderer.timings;
+	uint32_t frame = state->renderer.frameIndex;
+
+	auto phase = Clock::now();
+	vkWaitForFences(state->context.device, 1, &state->renderer.inFlightFence[frame], VK_TRUE, UINT64_MAX);
+	modelInstancesReclaim(state);
+	timings.wait = std::chrono::duration<double, std::milli>(Clock::now() - phase).count();
+	state->renderer.stats.fenceWaitMs = timings.wait;
+	state->renderer.stats.acquireMs = 0.0;
+	headlessDumpWrite(state, frame);
+	gpuProfilerCollect(state);
+	vkResetFences(state->context.device, 1, &state->renderer.inFlightFence[frame]);
+
+	state->renderer.imageAquiredIndex = frame;
+	vkResetCommandBuffer(state->buffers.commandBuffer[frame], 0);
+	phase = Clock::now();
+	animationUpdate(state, deltaTime);
+	timings.update = std::chrono::duration<double, std::milli>(Clock::now() - phase).count();
+	phase = Clock::now();
+	commandBufferRecord(state);
+	timings.record = std::chrono::duration<double, std::milli>(Clock::now() - phase).count() - timings.gather;
+
+	VkSubmitInfo submitInfo{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &state->buffers.commandBuffer[frame],
+	};
+	phase = Clock::now();
+	PANIC(vkQueueSubmit(state->context.queue, 1, &submitInfo, state->renderer.inFlightFence[frame]), "Failed To Submit Queue");
+	morphSubmitted(state);
+	timings.submit = std::chrono::duration<double, std::milli>(Clock::now() - phase).count();
+	timings.present = 0.0;
+	renderStatsFrameEnd(state);
+	startupFirstFrame(state);
+
+	state->headless.frame++;
+	state->renderer.frameIndex = (frame + 1) % state->config.swapchainBuffering;
+}
+
+// Fixed frame count at a fixed time step, so runs are comparable across hosts
+void headlessRun(State* state) {
+	using Clock = std::chrono::high_resolution_clock;
+	const float deltaTime = 1.0f / 60.0f;
+	uint32_t frameCount = state->config.headlessFrameCount;
+
+	std::vector<double> frameMs;
+	frameMs.reserve(frameCount);
+	double gpuMsSum = 0.0;
+	double opaqueMsSum = 0.0;
+	uint32_t gpuSamples = 0;
+	uint64_t framesRead = state->renderer.profiler.framesRead;
+
+	auto runStart = Clock::now();
+	for (uint32_t i = 0; i < frameCount; i++) {
+		auto frameStart = Clock::now();
+		uniformBuffersUpdate(state);
+		headlessFrameDraw(state, deltaTime);
+		frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+
+		// Timestamps are read back one lap of the frame slots later
+		if (state->renderer.profiler.framesRead != framesRead) {
+			framesRead = state->renderer.profiler.framesRead;
+			gpuMsSum += gpuScopeMs(state, "frame");
+			opaqueMsSum += gpuScopeMs(state, "opaque");
+			gpuSamples++;
+		}
+	}
+	vkDeviceWaitIdle(state->context.device);
+	double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+
+	headlessDumpFlush(state);
+
+	if (frameMs.empty()) return;
+	std::vector<double> sorted = frameMs;
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0.0;
+	for (double ms : frameMs) sum += ms;
+
+	printf("headless: %u frames at %ux%u in %.3f s, %.1f fps\n", frameCount,
+		state->window.swapchain.imageExtent.width, state->window.swapchain.imageExtent.height, totalMs / 1000.0, frameCount * 1000.0 / totalMs);
+	printf("  frame ms  min %.3f  avg %.3f  p50 %.3f  p95 %.3f  max %.3f\n",
+		sorted.front(), sum / frameMs.size(), sorted[sorted.size() / 2], sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)], sorted.back());
+	if (gpuSamples > 0) {
+		printf("  GPU avg  frame %.3f ms, opaque pass %.3f ms\n", gpuMsSum / gpuSamples, opaqueMsSum / gpuSamples);
+	}
+	if (!state->config.headlessDumpDir.empty()) {
+		printf("  frames written to %s\n", state->config.headlessDumpDir.c_str());
+	}
+}
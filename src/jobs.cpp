@@ -0,0 +1,94 @@
+#include "headers/jobs.h"
+#include <latch>
+//utility
+static void jobWorker(JobSystem* jobs, uint32_t index) {
+	profilerThreadName("worker " + std::to_string(index));
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(jobs->mutex);
+			jobs->wake.wait(lock, [jobs] { return jobs->stop || !jobs->queue.empty(); });
+			if (jobs->stop && jobs->queue.empty()) {
+				return;
+			}
+			job = std::move(jobs->queue.front());
+			jobs->queue.pop_front();
+		}
+
+		{
+			PROFILE_ZONE("job");
+			job();
+		}
+
+		std::lock_guard<std::mutex> lock(jobs->mutex);
+		if (--jobs->pending == 0) {
+			jobs->idle.notify_all();
+		}
+	}
+}
+
+//Jobs
+void jobSystemCreate(State* state) {
+	uint32_t threadCount = state->config.workerThreadCount;
+	if (threadCount == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	state->jobs.stop = false;
+	state->jobs.workers.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; i++) {
+		state->jobs.workers.emplace_back(jobWorker, &state->jobs, i);
+	}
+	printf("Job system: %u worker threads\n", threadCount);
+};
+void jobSystemDestroy(State* state) {
+	{
+		std::lock_guard<std::mutex> lock(state->jobs.mutex);
+		state->jobs.stop = true;
+	}
+	state->jobs.wake.notify_all();
+	for (std::thread& worker : state->jobs.workers) {
+		worker.join();
+	}
+	state->jobs.workers.clear();
+};
+
+void jobSubmit(State* state, std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(state->jobs.mutex);
+		state->jobs.queue.push_back(std::move(job));
+		state->jobs.pending++;
+	}
+	state->jobs.wake.notify_one();
+};
+void jobWaitIdle(State* state) {
+	std::unique_lock<std::mutex> lock(state->jobs.mutex);
+	state->jobs.idle.wait(lock, [state] { return state->jobs.pending == 0; });
+};
+
+// Splits [0, count) into chunks of at least minChunk items, about four per
+// thread so uneven items even out. The caller runs the first chunk itself and
+// returns once every chunk is done. Main thread only: a worker waiting here
+// could starve its own chunks.
+void jobParallelFor(State* state, uint32_t count, uint32_t minChunk, const std::function<void(uint32_t, uint32_t)>& body) {
+	uint32_t threads = static_cast<uint32_t>(state->jobs.workers.size()) + 1;
+	uint32_t chunkSize = std::max(minChunk, (count + 4 * threads - 1) / (4 * threads));
+	uint32_t chunkCount = chunkSize ? (count + chunkSize - 1) / chunkSize : 0;
+	if (threads == 1 || chunkCount <= 1) {
+		if (count) body(0, count);
+		return;
+	}
+
+	std::latch done(chunkCount - 1);
+	for (uint32_t chunk = 1; chunk < chunkCount; chunk++) {
+		uint32_t begin = chunk * chunkSize;
+		uint32_t end = std::min(begin + chunkSize, count);
+		jobSubmit(state, [&body, &done, begin, end] {
+			body(begin, end);
+			done.count_down();
+		});
+	}
+	body(0, std::min(chunkSize, count));
+	done.wait();
+};
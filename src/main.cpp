@@ -1,6 +1,7 @@
 #include "headers/application.h"
+#include "headers/benchmark.h"
 
-int main() {
+int main(int argc, char** argv) {
 	State state{
 		.config{
 			.windowTitle = "Vulkan Triangle",
@@ -15,9 +16,205 @@ int main() {
 			.KOBOLD_MODEL_PATH = "res/models/Kobold.glb",
 			.HOVER_BIKE_MODEL_PATH = "res/models/hover_bike.glb",
 			.MODEL_PATH = "res/models/hover_bike.glb",
+			.FOX_MODEL_PATH = "res/models/Fox.glb",
+			.foxInstanceCount = 0,
+			.workerThreadCount = 0,
+			.textureCompression = true,
+			.animationCompression = true,
+			.vatInstanceCount = 0,
+			.sceneFlatten = true,
+			.headless = false,
+			.headlessFrameCount = 0,
+			.gpuStatistics = false,
+			.scenePath = "res/scenes/default.json",
+			.coldStart = false,
+			.pipelineCachePath = "pipeline.cache",
 		}
 	};
+	startupBegin(&state);
+
+	// Options accepted anywhere on the command line:
+	//   --no-flatten           keep every glTF node as authored
+	//   --headless [frames]    render offscreen without a window, then print timings (default 600 frames)
+	//   --size WxH             window or offscreen image size
+	//   --dump <dir>           headless frames written to dir as PPM
+	//   --benchmark <file>     scripted camera-path run from a JSON description, results as JSON
+	//   --out <file>           benchmark results written here instead of stdout
+	//   --baseline <file>      earlier results; exit code 1 if any percentile regressed
+	//   --threshold <f>        allowed regression as a fraction, overrides the description
+	//   --record-path <file>   interactive camera written as a path file on exit
+	//   --gpu-statistics       pipeline statistics queries per GPU profiler scope
+	//   --trace <file>         CPU zones as Chrome trace JSON, needs a VR_ENABLE_PROFILER build
+	//   --metrics <file>       Prometheus text-format metrics rewritten in the background
+	//   --metrics-interval <s> seconds between metrics writes (default 10)
+	//   --scene <file>         scene description loaded in place of res/scenes/default.json
+	//   --cold                 ignore on-disk caches, as on a first run
+	//   --no-pipeline-cache    compile every pipeline from scratch, nothing read or written
+	//   --startup-report <f>   init phases and time to first frame written as JSON, then exit
+	//   --startup-bench [runs] relaunch with the other options, cold and warm (default 5 each)
+	//   --fox <count>          instancing stress test, count foxes in a grid
+	//   --vat [count]          the same crowd from vertex animation textures (default 10000)
+	//   --cook <glb> [glb ...] cook the textures of each model to the .ktx2 cache, then exit
+	//   --bench <name|all>     CPU benchmarks, no window or device, then exit (with --headless some run on a device)
+	//   --generate-scene <preset> <count> <out.json> [glb]
+	//                          write a stress scene description, then exit
+	float threshold = -1.0f;
+	const char* scenePath = nullptr;
+	uint32_t startupRuns = 0;
+	std::string startupArgs;
+	std::vector<const char*> cookPaths;
+	const char* benchName = nullptr;
+	bool generateScene = false;
+	const char* generatePreset = nullptr;
+	const char* generateCount = nullptr;
+	const char* generateOut = nullptr;
+	const char* generateModel = nullptr;
+	for (int i = 1; i < argc; i++) {
+		int option = i;
+		bool countNext = i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9';
+		bool valueNext = i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0;
+		if (strcmp(argv[i], "--no-flatten") == 0) {
+			state.config.sceneFlatten = false;
+		}
+		else if (strcmp(argv[i], "--headless") == 0) {
+			state.config.headless = true;
+			state.config.headlessFrameCount = countNext ? (uint32_t)strtoul(argv[++i], nullptr, 10) : 600;
+		}
+		else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			unsigned width = 0, height = 0;
+			if (sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width > 0 && height > 0) {
+				state.config.windowWidth = width;
+				state.config.windowHeight = height;
+			}
+		}
+		else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+			state.config.headlessDumpDir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+			state.frameBench.path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			state.frameBench.outputPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+			state.frameBench.baselinePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+			threshold = strtof(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--record-path") == 0 && i + 1 < argc) {
+			state.frameBench.recordPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--gpu-statistics") == 0) {
+			state.config.gpuStatistics = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			state.config.tracePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+			state.metrics.path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+			state.metrics.interval = std::max(0.1f, strtof(argv[++i], nullptr));
+		}
+		else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+			scenePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--cold") == 0) {
+			state.config.coldStart = true;
+		}
+		else if (strcmp(argv[i], "--no-pipeline-cache") == 0) {
+			state.config.pipelineCachePath.clear();
+		}
+		else if (strcmp(argv[i], "--startup-report") == 0 && i + 1 < argc) {
+			state.startup.reportPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--startup-bench") == 0) {
+			startupRuns = countNext ? std::max(1u, (unsigned)strtoul(argv[++i], nullptr, 10)) : 5;
+			continue;
+		}
+		else if (strcmp(argv[i], "--fox") == 0 && countNext) {
+			state.config.foxInstanceCount = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--vat") == 0) {
+			state.config.vatInstanceCount = countNext ? (uint32_t)strtoul(argv[++i], nullptr, 10) : 10000;
+		}
+		else if (strcmp(argv[i], "--cook") == 0 && valueNext) {
+			while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) cookPaths.push_back(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--bench") == 0) {
+			benchName = valueNext ? argv[++i] : "";
+		}
+		else if (strcmp(argv[i], "--generate-scene") == 0) {
+			// A short argument list is reported after the loop with the preset list
+			generateScene = true;
+			if (i + 3 < argc && argv[i + 2][0] >= '0' && argv[i + 2][0] <= '9') {
+				generatePreset = argv[++i];
+				generateCount = argv[++i];
+				generateOut = argv[++i];
+				if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) generateModel = argv[++i];
+			}
+		}
+		// Every option but --startup-bench and --out is passed on to the processes a startup benchmark launches
+		if (strcmp(argv[option], "--out") != 0) {
+			for (int arg = option; arg <= i; arg++) startupArgs += std::string(" \"") + argv[arg] + "\"";
+		}
+	}
+	// Startup benchmark: VulkanRenderer --startup-bench [runs] [options...] [--out results.json]
+	if (startupRuns > 0) {
+		return startupBenchRun(&state, argv[0], startupArgs, startupRuns);
+	}
+	// Only the first frame is of interest
+	if (!state.startup.reportPath.empty() && state.config.headless) {
+		state.config.headlessFrameCount = 1;
+	}
+
+	// Offline texture cooking: VulkanRenderer --cook model.glb [more.glb ...]
+	if (!cookPaths.empty()) {
+		jobSystemCreate(&state);
+		for (const char* path : cookPaths) {
+			modelCookTextures(&state, path);
+		}
+		jobSystemDestroy(&state);
+		return 0;
+	}
+	// CPU benchmarks, no window or device: VulkanRenderer --bench <name|all>
+	// (--bench morph --headless times morph.comp on a device)
+	if (benchName) {
+		jobSystemCreate(&state);
+		bool found = benchName[0] != '\0' && benchmarkRun(&state, benchName);
+		jobSystemDestroy(&state);
+		if (!found) {
+			benchmarkList();
+			return 1;
+		}
+		return 0;
+	}
+	// Stress scenes: VulkanRenderer --generate-scene <preset> <count> <out.json> [model.glb]
+	if (generateScene) {
+		SceneGenerator generator;
+		std::string model = generateModel ? generateModel : state.config.FOX_MODEL_PATH;
+		if (!generateOut || !sceneGeneratorPreset(generatePreset, (uint32_t)strtoul(generateCount, nullptr, 10), model, generator)) {
+			sceneGeneratorPresetList();
+			return 1;
+		}
+		// Fox.glb is authored in centimetres
+		if (!generateModel) generator.scale = 0.01f;
+		SceneDescription description;
+		description.name = std::string(generatePreset) + "-" + generateCount;
+		sceneGenerate(generator, description);
+		sceneDescriptionWrite(generateOut, description);
+		printf("%s: %zu instances\n", generateOut, description.entries.size());
+		return 0;
+	}
+	// Before init: the description sets how many instances get created
+	if (!state.frameBench.path.empty()) {
+		frameBenchLoad(&state);
+		if (threshold >= 0.0f) state.frameBench.threshold = threshold;
+	}
+	if (scenePath) state.config.scenePath = scenePath;
 	init(&state);
 	mainloop(&state);
 	cleanup(&state);
+	return state.frameBench.regressed ? 1 : 0;
 };
\ No newline at end of file
@@ -0,0 +1,345 @@
+#include "headers/metrics.h"
+#include "headers/gpuProfiler.h"
+#include <cmath>
+#include <filesystem>
+#include <map>
+
+// Upper bounds in seconds; the last bucket is +Inf
+static constexpr std::array<double, METRICS_BUCKET_COUNT - 1> METRICS_BUCKETS = {
+	0.004, 0.008, 0.0125, 0.0167, 0.025, 0.0333, 0.05, 0.1,
+};
+
+// Heap usage moves slowly; one sample per heap every second or so at 60 fps
+static constexpr uint64_t METRICS_MEMORY_FRAMES = 60;
+
+//Producer
+static void metricsPush(State* state, const MetricsSample& sample) {
+	Metrics& metrics = state->metrics;
+	if (metrics.path.empty()) return;
+
+	uint64_t head = metrics.head.load(std::memory_order_relaxed);
+	if (head - metrics.tail.load(std::memory_order_acquire) >= METRICS_RING_SIZE) {
+		metrics.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	metrics.ring[head % METRICS_RING_SIZE] = sample;
+	metrics.head.store(head + 1, std::memory_order_release);
+}
+
+void metricsFrame(State* state) {
+	const RenderStats& stats = state->renderer.stats;
+	MetricsSample frame{ .type = METRICS_FRAME };
+	frame.value = stats.cpuFrameMs[(stats.historyHead + RENDER_STATS_HISTORY - 1) % RENDER_STATS_HISTORY];
+	frame.value2 = gpuScopeMs(state, "frame");
+	metricsPush(state, frame);
+
+	if (state->metrics.frames++ % METRICS_MEMORY_FRAMES == 0) {
+		for (uint32_t heap = 0; heap < stats.heapCount; heap++) {
+			metricsPush(state, { .type = METRICS_MEMORY, .index = heap,
+				.value = (double)stats.heapUsage[heap], .value2 = (double)stats.heapBudget[heap] });
+		}
+	}
+}
+
+void metricsLoad(State* state, const std::string& modelPath, double ms) {
+	MetricsSample load{ .type = METRICS_LOAD, .value = ms };
+	std::string name = std::filesystem::path(modelPath).filename().string();
+	strncpy(load.label, name.c_str(), sizeof(load.label) - 1);
+	metricsPush(state, load);
+}
+
+void metricsSwapchainRecreate(State* state) {
+	metricsPush(state, { .type = METRICS_SWAPCHAIN_RECREATE });
+}
+
+//Consumer
+static void histogramObserve(MetricsHistogram& histogram, double seconds) {
+	uint32_t bucket = 0;
+	while (bucket < METRICS_BUCKETS.size() && seconds > METRICS_BUCKETS[bucket]) bucket++;
+	histogram.buckets[bucket]++;
+	histogram.sum += seconds;
+	histogram.count++;
+}
+
+static void metricsApply(MetricsAggregate& aggregate, const MetricsSample& sample) {
+	switch (sample.type) {
+	case METRICS_FRAME:
+		if (sample.value > 0.0) histogramObserve(aggregate.cpuFrame, sample.value / 1000.0);
+		if (sample.value2 > 0.0) histogramObserve(aggregate.gpuFrame, sample.value2 / 1000.0);
+		break;
+	case METRICS_MEMORY:
+		if (sample.index >= VK_MAX_MEMORY_HEAPS) break;
+		aggregate.heapCount = std::max(aggregate.heapCount, sample.index + 1);
+		aggregate.heapUsage[sample.index] = sample.value;
+		aggregate.heapBudget[sample.index] = sample.value2;
+		break;
+	case METRICS_LOAD: {
+		aggregate.loadCount++;
+		auto it = std::find_if(aggregate.loads.begin(), aggregate.loads.end(),
+			[&](const auto& load) { return load.first == sample.label; });
+		if (it == aggregate.loads.end())
+			aggregate.loads.push_back({ sample.label, sample.value });
+		else
+			it->second = sample.value;
+		break;
+	}
+	case METRICS_SWAPCHAIN_RECREATE:
+		aggregate.swapchainRecreations++;
+		break;
+	}
+}
+
+// Backslash, double quote and newline are the only escapes the format has
+static std::string labelEscape(const std::string& value) {
+	std::string escaped;
+	for (char c : value) {
+		if (c == '\\' || c == '"') escaped += '\\';
+		if (c == '\n') { escaped += "\\n"; continue; }
+		escaped += c;
+	}
+	return escaped;
+}
+
+static void histogramRender(std::string& out, const char* name, const char* help, const MetricsHistogram& histogram) {
+	char line[256];
+	snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+	out += line;
+	uint64_t cumulative = 0;
+	for (uint32_t i = 0; i < METRICS_BUCKET_COUNT; i++) {
+		cumulative += histogram.buckets[i];
+		if (i < METRICS_BUCKETS.size())
+			snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", name, METRICS_BUCKETS[i], (unsigned long long)cumulative);
+		else
+			snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)cumulative);
+		out += line;
+	}
+	snprintf(line, sizeof(line), "%s_sum %.6f\n%s_count %llu\n", name, histogram.sum, name, (unsigned long long)histogram.count);
+	out += line;
+}
+
+static void scalarRender(std::string& out, const char* name, const char* type, const char* help, double value) {
+	char line[256];
+	snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %.6f\n", name, help, name, type, name, value);
+	out += line;
+}
+
+std::string metricsSnapshot(State* state) {
+	Metrics& metrics = state->metrics;
+	MetricsAggregate& aggregate = metrics.aggregate;
+
+	uint64_t tail = metrics.tail.load(std::memory_order_relaxed);
+	uint64_t head = metrics.head.load(std::memory_order_acquire);
+	for (; tail < head; tail++) {
+		metricsApply(aggregate, metrics.ring[tail % METRICS_RING_SIZE]);
+	}
+	metrics.tail.store(tail, std::memory_order_release);
+
+	std::string out;
+	char line[256];
+	scalarRender(out, "vr_uptime_seconds", "gauge", "Seconds since the renderer started.",
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - metrics.start).count());
+	scalarRender(out, "vr_frames_total", "counter", "Frames presented.", (double)aggregate.cpuFrame.count);
+	histogramRender(out, "vr_frame_time_seconds", "CPU frame-to-frame time.", aggregate.cpuFrame);
+	if (aggregate.gpuFrame.count > 0) {
+		histogramRender(out, "vr_gpu_frame_time_seconds", "GPU time of the frame's command buffer.", aggregate.gpuFrame);
+	}
+
+	if (aggregate.heapCount > 0) {
+		out += "# HELP vr_memory_heap_usage_bytes Device memory in use per heap, 0 without VK_EXT_memory_budget.\n";
+		out += "# TYPE vr_memory_heap_usage_bytes gauge\n";
+		for (uint32_t heap = 0; heap < aggregate.heapCount; heap++) {
+			snprintf(line, sizeof(line), "vr_memory_heap_usage_bytes{heap=\"%u\"} %.0f\n", heap, aggregate.heapUsage[heap]);
+			out += line;
+		}
+		out += "# HELP vr_memory_heap_budget_bytes Memory budget per heap, the heap size without VK_EXT_memory_budget.\n";
+		out += "# TYPE vr_memory_heap_budget_bytes gauge\n";
+		for (uint32_t heap = 0; heap < aggregate.heapCount; heap++) {
+			snprintf(line, sizeof(line), "vr_memory_heap_budget_bytes{heap=\"%u\"} %.0f\n", heap, aggregate.heapBudget[heap]);
+			out += line;
+		}
+	}
+
+	if (!aggregate.loads.empty()) {
+		out += "# HELP vr_model_load_seconds Wall time of the last load of each model.\n";
+		out += "# TYPE vr_model_load_seconds gauge\n";
+		for (const auto& [model, ms] : aggregate.loads) {
+			snprintf(line, sizeof(line), "vr_model_load_seconds{model=\"%s\"} %.6f\n", labelEscape(model).c_str(), ms / 1000.0);
+			out += line;
+		}
+	}
+	scalarRender(out, "vr_model_loads_total", "counter", "Models loaded.", (double)aggregate.loadCount);
+	scalarRender(out, "vr_swapchain_recreations_total", "counter", "Swapchain rebuilds after resize or out-of-date.", (double)aggregate.swapchainRecreations);
+	scalarRender(out, "vr_metrics_dropped_samples_total", "counter", "Samples lost because the exporter fell behind.",
+		(double)metrics.dropped.load(std::memory_order_relaxed));
+	return out;
+}
+
+//Format check
+static bool metricNameValid(const std::string& name) {
+	if (name.empty() || std::isdigit((unsigned char)name[0])) return false;
+	return std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum((unsigned char)c) || c == '_' || c == ':'; });
+}
+
+static bool sampleValueParse(const std::string& text, double& value) {
+	if (text == "+Inf") { value = INFINITY; return true; }
+	if (text == "-Inf") { value = -INFINITY; return true; }
+	if (text == "NaN") { value = NAN; return true; }
+	char* end = nullptr;
+	value = strtod(text.c_str(), &end);
+	return !text.empty() && end == text.c_str() + text.size();
+}
+
+std::string metricsFormatCheck(const std::string& text) {
+	std::map<std::string, std::string> types;
+	std::map<std::string, std::vector<std::pair<double, double>>> buckets;  // family -> (le, cumulative)
+	std::map<std::string, double> counts;
+	std::vector<std::string> seen;                                           // families with samples
+	if (!text.empty() && text.back() != '\n') return "last line has no newline";
+
+	size_t lineNumber = 0;
+	size_t position = 0;
+	while (position < text.size()) {
+		size_t end = text.find('\n', position);
+		std::string line = text.substr(position, end - position);
+		position = end + 1;
+		lineNumber++;
+		std::string where = "line " + std::to_string(lineNumber) + ": ";
+		if (line.empty()) continue;
+
+		if (line[0] == '#') {
+			char keyword[8] = {}, name[128] = {}, type[16] = {};
+			if (sscanf(line.c_str(), "# %7s %127s %15s", keyword, name, type) < 2) continue;
+			if (strcmp(keyword, "TYPE") == 0) {
+				static const char* known[] = { "counter", "gauge", "histogram", "summary", "untyped" };
+				if (std::none_of(std::begin(known), std::end(known), [&](const char* k) { return strcmp(k, type) == 0; }))
+					return where + "unknown type " + type;
+				if (types.count(name)) return where + "second TYPE for " + name;
+				if (std::find(seen.begin(), seen.end(), name) != seen.end()) return where + "TYPE after samples of " + name;
+				types[name] = type;
+			}
+			else if (strcmp(keyword, "HELP") == 0 && !metricNameValid(name)) {
+				return where + "bad metric name " + name;
+			}
+			continue;
+		}
+
+		// name{label="value",...} value [timestamp]
+		size_t nameEnd = line.find_first_of("{ ");
+		if (nameEnd == std::string::npos) return where + "no value";
+		std::string name = line.substr(0, nameEnd);
+		if (!metricNameValid(name)) return where + "bad metric name " + name;
+
+		std::string le;
+		size_t cursor = nameEnd;
+		if (line[cursor] == '{') {
+			cursor++;
+			while (cursor < line.size() && line[cursor] != '}') {
+				size_t equals = line.find('=', cursor);
+				if (equals == std::string::npos || equals + 1 >= line.size() || line[equals + 1] != '"') return where + "bad label";
+				std::string key = line.substr(cursor, equals - cursor);
+				if (!metricNameValid(key) || key.find(':') != std::string::npos) return where + "bad label name " + key;
+				std::string value;
+				size_t i = equals + 2;
+				for (; i < line.size() && line[i] != '"'; i++) {
+					if (line[i] == '\\') {
+						if (++i >= line.size() || (line[i] != '\\' && line[i] != '"' && line[i] != 'n')) return where + "bad escape";
+					}
+					value += line[i];
+				}
+				if (i >= line.size()) return where + "unterminated label value";
+				if (key == "le") le = value;
+				cursor = i + 1;
+				if (cursor < line.size() && line[cursor] == ',') cursor++;
+			}
+			if (cursor >= line.size()) return where + "unterminated labels";
+			cursor++;
+		}
+		if (cursor >= line.size() || line[cursor] != ' ') return where + "no value";
+
+		std::string rest = line.substr(cursor + 1);
+		std::string valueText = rest.substr(0, rest.find(' '));
+		double value;
+		if (!sampleValueParse(valueText, value)) return where + "bad value " + valueText;
+
+		// Histogram families: name_bucket / name_sum / name_count
+		std::string family = name;
+		for (const char* suffix : { "_bucket", "_sum", "_count" }) {
+			size_t length = strlen(suffix);
+			std::string base = name.size() > length ? name.substr(0, name.size() - length) : "";
+			if (!base.empty() && name.compare(name.size() - length, length, suffix) == 0 && types.count(base) && types[base] == "histogram") {
+				family = base;
+				if (strcmp(suffix, "_bucket") == 0) {
+					double bound;
+					if (le.empty() || !sampleValueParse(le, bound)) return where + "bucket without a valid le";
+					std::vector<std::pair<double, double>>& series = buckets[base];
+					if (!series.empty() && (bound <= series.back().first || value < series.back().second))
+						return where + "buckets of " + base + " not increasing";
+					series.push_back({ bound, value });
+				}
+				if (strcmp(suffix, "_count") == 0) counts[base] = value;
+			}
+		}
+		if (std::find(seen.begin(), seen.end(), family) == seen.end()) seen.push_back(family);
+	}
+
+	for (const auto& [family, type] : types) {
+		if (type != "histogram") continue;
+		const std::vector<std::pair<double, double>>& series = buckets[family];
+		if (series.empty() || series.back().first != INFINITY) return family + ": no +Inf bucket";
+		if (!counts.count(family) || counts[family] != series.back().second) return family + ": _count differs from the +Inf bucket";
+	}
+	return "";
+}
+
+//Exporter
+// Whole file or nothing: scrapers never see a half-written snapshot
+static void metricsWrite(State* state) {
+	const std::string& path = state->metrics.path;
+	std::string text = metricsSnapshot(state);
+	std::string temporary = path + ".tmp";
+	FILE* file = fopen(temporary.c_str(), "w");
+	if (!file) {
+		fprintf(stderr, "metrics: cannot write %s\n", temporary.c_str());
+		return;
+	}
+	fwrite(text.data(), 1, text.size(), file);
+	fclose(file);
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error) {
+		fprintf(stderr, "metrics: cannot replace %s: %s\n", path.c_str(), error.message().c_str());
+	}
+}
+
+static void metricsExporter(State* state) {
+	profilerThreadName("metrics");
+	Metrics& metrics = state->metrics;
+	std::unique_lock<std::mutex> lock(metrics.mutex);
+	while (!metrics.stop) {
+		metrics.wake.wait_for(lock, std::chrono::duration<float>(metrics.interval), [&] { return metrics.stop; });
+		lock.unlock();
+		metricsWrite(state);        // the last pass after stop writes the final totals
+		lock.lock();
+	}
+}
+
+void metricsCreate(State* state) {
+	Metrics& metrics = state->metrics;
+	metrics.start = std::chrono::steady_clock::now();
+	if (metrics.path.empty()) return;
+	metrics.stop = false;
+	metrics.exporter = std::thread(metricsExporter, state);
+	printf("metrics: %s every %.1f s\n", metrics.path.c_str(), metrics.interval);
+}
+
+void metricsDestroy(State* state) {
+	Metrics& metrics = state->metrics;
+	if (!metrics.exporter.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(metrics.mutex);
+		metrics.stop = true;
+	}
+	metrics.wake.notify_all();
+	metrics.exporter.join();
+}
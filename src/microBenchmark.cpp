@@ -0,0 +1,213 @@
+#include "headers/benchmark.h"
+#include "headers/animation.h"
+#include "headers/jobs.h"
+#include <tiny_gltf.h>
+#include <benchmark/benchmark.h>
+
+// micro_bench: the CPU hot paths, one Google Benchmark case each, no window
+// or device. Results and comparisons go through the library's own flags:
+//   micro_bench --benchmark_out=micro.json --benchmark_out_format=json
+//   compare.py benchmarks before.json after.json
+
+// Config the cases read; the job system is created in main
+static State microState{
+	.config{
+		.swapchainBuffering = SWAPCHAIN_TRIPPLE_BUFFERING,
+		.FOX_MODEL_PATH = "res/models/Fox.glb",
+	}
+};
+
+// One mesh on a side x side grid laid out the way glTF exporters write it:
+// float positions, normals and UVs, normalized ubyte colors, uint32 indices
+static void microGltfGrid(uint32_t side, tinygltf::Model& gltf) {
+	uint32_t vertexCount = side * side;
+	uint32_t quadCount = (side - 1) * (side - 1);
+	tinygltf::Buffer& buffer = gltf.buffers.emplace_back();
+	// Pointers are taken only after every view exists, the buffer moves while it grows
+	auto view = [&](size_t bytes, int type, int componentType, size_t count) {
+		tinygltf::BufferView& bufferView = gltf.bufferViews.emplace_back();
+		bufferView.buffer = 0;
+		bufferView.byteOffset = buffer.data.size();
+		bufferView.byteLength = bytes;
+		buffer.data.resize(buffer.data.size() + bytes);
+		tinygltf::Accessor& accessor = gltf.accessors.emplace_back();
+		accessor.bufferView = static_cast<int>(gltf.bufferViews.size() - 1);
+		accessor.type = type;
+		accessor.componentType = componentType;
+		accessor.normalized = componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+		accessor.count = count;
+		return bufferView.byteOffset;
+	};
+	size_t positionOffset = view(12ull * vertexCount, TINYGLTF_TYPE_VEC3, TINYGLTF_COMPONENT_TYPE_FLOAT, vertexCount);
+	size_t normalOffset = view(12ull * vertexCount, TINYGLTF_TYPE_VEC3, TINYGLTF_COMPONENT_TYPE_FLOAT, vertexCount);
+	size_t uvOffset = view(8ull * vertexCount, TINYGLTF_TYPE_VEC2, TINYGLTF_COMPONENT_TYPE_FLOAT, vertexCount);
+	size_t colorOffset = view(4ull * vertexCount, TINYGLTF_TYPE_VEC4, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, vertexCount);
+	size_t indexOffset = view(24ull * quadCount, TINYGLTF_TYPE_SCALAR, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, 6ull * quadCount);
+
+	float* positions = reinterpret_cast<float*>(buffer.data.data() + positionOffset);
+	float* normals = reinterpret_cast<float*>(buffer.data.data() + normalOffset);
+	float* uvs = reinterpret_cast<float*>(buffer.data.data() + uvOffset);
+	uint8_t* colors = buffer.data.data() + colorOffset;
+	uint32_t* indices = reinterpret_cast<uint32_t*>(buffer.data.data() + indexOffset);
+	for (uint32_t y = 0; y < side; y++) {
+		for (uint32_t x = 0; x < side; x++) {
+			uint32_t v = y * side + x;
+			float u = (float)x / (side - 1), w = (float)y / (side - 1);
+			positions[3 * v + 0] = u; positions[3 * v + 1] = 0.1f * std::sin(8.0f * u); positions[3 * v + 2] = w;
+			normals[3 * v + 0] = 0.0f; normals[3 * v + 1] = 1.0f; normals[3 * v + 2] = 0.0f;
+			uvs[2 * v + 0] = u; uvs[2 * v + 1] = w;
+			colors[4 * v + 0] = (uint8_t)(255 * u); colors[4 * v + 1] = (uint8_t)(255 * w); colors[4 * v + 2] = 128; colors[4 * v + 3] = 255;
+		}
+	}
+	for (uint32_t y = 0; y + 1 < side; y++) {
+		for (uint32_t x = 0; x + 1 < side; x++) {
+			uint32_t v = y * side + x;
+			uint32_t* quad = indices + 6 * (y * (side - 1) + x);
+			quad[0] = v; quad[1] = v + side; quad[2] = v + 1;
+			quad[3] = v + 1; quad[4] = v + side; quad[5] = v + side + 1;
+		}
+	}
+
+	tinygltf::Primitive primitive;
+	primitive.attributes = { { "POSITION", 0 }, { "NORMAL", 1 }, { "TEXCOORD_0", 2 }, { "COLOR_0", 3 } };
+	primitive.indices = 4;
+	gltf.meshes.emplace_back().primitives.push_back(primitive);
+	gltf.nodes.emplace_back().mesh = 0;
+	gltf.scenes.emplace_back().nodes.push_back(0);
+	gltf.defaultScene = 0;
+}
+
+// ─────────────────────────────────────────────
+// Cases
+// ─────────────────────────────────────────────
+// Global matrices down a deep chain, what Node::getGlobalMatrix used to walk
+static void updateGlobalsChain(benchmark::State& bench) {
+	uint32_t depth = static_cast<uint32_t>(bench.range(0));
+	NodeStore store;
+	store.reserve(depth);
+	for (uint32_t i = 0; i < depth; i++) {
+		uint32_t node = store.add(i == 0 ? NODE_NONE : i - 1, 0);
+		store.translation[node] = glm::vec3(0.0f, 0.01f, 0.0f);
+		store.rotation[node] = glm::angleAxis(0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+	for (auto _ : bench) {
+		store.updateGlobals();
+		benchmark::DoNotOptimize(store.global.back());
+	}
+	bench.SetItemsProcessed(bench.iterations() * depth);
+}
+BENCHMARK(updateGlobalsChain)->Arg(64)->Arg(1024);
+
+// gatherDrawItems on a wide tree: one root, every child a mesh, half of them blended
+static void gatherDrawItemsWide(benchmark::State& bench) {
+	uint32_t width = static_cast<uint32_t>(bench.range(0));
+	Model wide;
+	std::vector<Material> materials(2);
+	materials[1].alphaMode = "BLEND";
+	wide.nodes.reserve(width + 1);
+	wide.nodes.add(NODE_NONE, 0);
+	wide.meshes.resize(width);
+	for (uint32_t i = 0; i < width; i++) {
+		uint32_t node = wide.nodes.add(0, 0);
+		wide.nodes.translation[node] = glm::vec3((float)(i % 64), 0.0f, (float)(i / 64));
+		wide.nodes.meshFirst[node] = i;
+		wide.nodes.meshCount[node] = 1;
+		wide.meshes[i].materialIndex = (int)(i % 2);
+	}
+	wide.nodes.updateGlobals();
+	std::vector<DrawItem> items;
+	for (auto _ : bench) {
+		items.clear();
+		gatherDrawItems(wide, glm::vec3(32.0f, 4.0f, -8.0f), materials, items);
+		benchmark::DoNotOptimize(items.data());
+	}
+	bench.SetItemsProcessed(bench.iterations() * width);
+}
+BENCHMARK(gatherDrawItemsWide)->Arg(4096);
+
+// Transparent gather + back-to-front sort over a generated crowd on the null device
+static void transparentDrawsGatherInstances(benchmark::State& bench) {
+	uint32_t count = static_cast<uint32_t>(bench.range(0));
+	std::unique_ptr<State> nullState = benchNullStateCreate(&microState);
+	benchNullModelRegister(nullState.get(), "null://transparent", 1, 1);
+	SceneDescription description;
+	sceneGenerate(SceneGenerator{ .layout = SCENE_LAYOUT_CLUSTERS, .count = count, .models = { "null://transparent" } }, description);
+	sceneInstantiate(nullState.get(), description);
+	std::vector<TransparentDraw> draws;
+	for (auto _ : bench) {
+		transparentDrawsGather(nullState.get(), draws);
+		benchmark::DoNotOptimize(draws.data());
+	}
+	bench.SetItemsProcessed(bench.iterations() * count);
+	nullDeviceDestroy(nullState.get());
+}
+BENCHMARK(transparentDrawsGatherInstances)->Arg(10000);
+
+// Model::updateAnimation's successor over a Fox.glb crowd
+static void animationInstanceUpdateFox(benchmark::State& bench) {
+	uint32_t count = static_cast<uint32_t>(bench.range(0));
+	Model fox;
+	modelLoadCpu(&microState, microState.config.FOX_MODEL_PATH, fox);
+	if (fox.animations.empty()) {
+		bench.SkipWithError("Fox.glb has no animations");
+		return;
+	}
+	std::vector<ModelInstance> foxes(count);
+	for (uint32_t i = 0; i < count; i++) {
+		foxes[i].animationTime = fox.animations[0].start + i * 0.01f;
+		animationPoseCreate(fox, foxes[i]);
+	}
+	for (auto _ : bench) {
+		for (ModelInstance& instance : foxes) animationInstanceUpdate(fox, instance, 1.0f / 60.0f);
+		benchmark::DoNotOptimize(foxes.back().pose.global.back());
+	}
+	bench.SetItemsProcessed(bench.iterations() * count);
+}
+BENCHMARK(animationInstanceUpdateFox)->Arg(256);
+
+// processNode's vertex conversion loop, fed from memory instead of a file
+static void processNodeVertices(benchmark::State& bench) {
+	uint32_t side = static_cast<uint32_t>(bench.range(0));
+	tinygltf::Model gltf;
+	microGltfGrid(side, gltf);
+	for (auto _ : bench) {
+		Model model;
+		modelLoadCpu(&microState, gltf, model);
+		benchmark::DoNotOptimize(model.meshes[0].vertices.data());
+	}
+	bench.SetItemsProcessed(bench.iterations() * side * side);
+}
+BENCHMARK(processNodeVertices)->Arg(256);
+
+// std::hash<Vertex> deduping the same grid expanded to a triangle soup, as an unindexed source would arrive
+static void hashVertexDedupe(benchmark::State& bench) {
+	uint32_t side = static_cast<uint32_t>(bench.range(0));
+	tinygltf::Model gltf;
+	microGltfGrid(side, gltf);
+	Model grid;
+	modelLoadCpu(&microState, gltf, grid);
+	std::vector<Vertex> soup;
+	for (uint32_t index : grid.meshes[0].indices) soup.push_back(grid.meshes[0].vertices[index]);
+	for (auto _ : bench) {
+		std::unordered_map<Vertex, uint32_t> unique;
+		unique.reserve(soup.size() / 4);
+		std::vector<uint32_t> indices;
+		indices.reserve(soup.size());
+		for (const Vertex& vertex : soup) {
+			indices.push_back(unique.try_emplace(vertex, static_cast<uint32_t>(unique.size())).first->second);
+		}
+		benchmark::DoNotOptimize(indices.data());
+	}
+	bench.SetItemsProcessed(bench.iterations() * soup.size());
+}
+BENCHMARK(hashVertexDedupe)->Arg(256);
+
+int main(int argc, char** argv) {
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+	jobSystemCreate(&microState);
+	benchmark::RunSpecifiedBenchmarks();
+	jobSystemDestroy(&microState);
+	benchmark::Shutdown();
+	return 0;
+}
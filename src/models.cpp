@@ -3,35 +3,351 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <tiny_gltf.h>
+#include <filesystem>
 #include "headers/models.h"
+#include "headers/metrics.h"
+#include "headers/renderer.h"
+//Image decoding
+// tinygltf normally runs stb_image on every image inside LoadBinaryFromFile.
+// Instead the loader callback only captures the compressed bytes, and the
+// decode happens on the job system while the meshes are processed.
+struct ImageDecodeJob {
+	int imageIndex = -1;
+	TextureRole role = TextureRole::COLOR;
+	std::vector<unsigned char> bytes;
+	unsigned char* pixels = nullptr;
+	ktxTexture2* ktx = nullptr;       // block-compressed result, from the cache or freshly cooked
+	bool fromCache = false;
+	bool basis = false;               // shipped as KTX2 (KHR_texture_basisu), transcoded instead of decoded
+	uint64_t contentHash = 0;         // bytes + role, key in Scene::textureRegistry
+	uint64_t contentCheck = 0;        // textureContentCheck of the bytes, confirms registry hits
+	size_t contentSize = 0;           // encoded size, bytes are dropped after decoding
+	int textureIndex = -1;            // Scene::textures slot once resolved
+	int aliasOf = -1;                 // same content as an earlier job of this model
+	bool uploaded = false;            // created a new scene texture rather than sharing one
+	int width = 0;
+	int height = 0;
+	double decodeMs = 0.0;
+};
+
+struct ImageDecodeQueue {
+	std::string modelPath;
+	bool compress = false;     // cook to BC formats through the .ktx2 cache
+	bool forceCook = false;    // ignore existing cache files
+	bool cacheRead = true;     // false cooks again but still refreshes the files (cold starts)
+	ktx_transcode_fmt_e basisTarget = KTX_TTF_RGBA32;   // picked on the main thread, used by the workers
+	std::vector<ImageDecodeJob> jobs;
+	size_t submitted = 0;           // jobs actually handed to the workers
+	std::vector<size_t> finished;   // job indices, in completion order
+	std::mutex mutex;
+	std::condition_variable done;
+
+	// Workers hold a reference to the queue, so it outlives every submitted
+	// job even when the load throws before the uploads drained it
+	~ImageDecodeQueue() {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait(lock, [&] { return finished.size() == submitted; });
+		}
+		for (ImageDecodeJob& job : jobs) {
+			if (job.ktx) ktxTexture_Destroy(ktxTexture(job.ktx));
+			if (job.pixels) stbi_image_free(job.pixels);
+		}
+	}
+};
+
+static bool deferImageLoad(tinygltf::Image* image, const int imageIndex, std::string* err, std::string* warn,
+	int reqWidth, int reqHeight, const unsigned char* bytes, int size, void* userData)
+{
+	auto* queue = static_cast<ImageDecodeQueue*>(userData);
+
+	ImageDecodeJob job{};
+	job.imageIndex = imageIndex;
+	job.bytes.assign(bytes, bytes + size);
+	queue->jobs.push_back(std::move(job));
+	return true;
+}
+
+// Image a glTF texture samples. KHR_texture_basisu points at the KTX2 image
+// through the extension, with `source` left as an optional PNG/JPEG fallback.
+static int textureImageSource(const tinygltf::Model& gltfModel, int textureIndex) {
+	if (textureIndex < 0 || textureIndex >= (int)gltfModel.textures.size()) return -1;
+	const tinygltf::Texture& texture = gltfModel.textures[textureIndex];
+
+	auto it = texture.extensions.find("KHR_texture_basisu");
+	if (it != texture.extensions.end() && it->second.Has("source")) {
+		return it->second.Get("source").GetNumberAsInt();
+	}
+	return texture.source;
+}
+
+// Picks the block format for every image from how the materials sample it.
+// An image shared between slots keeps the most demanding role.
+static std::vector<TextureRole> imageRolesClassify(const tinygltf::Model& gltfModel) {
+	std::vector<TextureRole> roles(gltfModel.images.size(), TextureRole::COLOR);
+	std::vector<int> rank(gltfModel.images.size(), -1);
+
+	auto assign = [&](int textureIndex, TextureRole role, int roleRank) {
+		int image = textureImageSource(gltfModel, textureIndex);
+		if (image < 0 || image >= (int)gltfModel.images.size()) return;
+		if (roleRank > rank[image]) {
+			rank[image] = roleRank;
+			roles[image] = role;
+		}
+	};
+
+	for (const auto& m : gltfModel.materials) {
+		assign(m.occlusionTexture.index, TextureRole::OCCLUSION, 0);
+		assign(m.pbrMetallicRoughness.metallicRoughnessTexture.index, TextureRole::PACKED_LINEAR, 1);
+		assign(m.pbrMetallicRoughness.baseColorTexture.index, TextureRole::COLOR, 2);
+		assign(m.emissiveTexture.index, TextureRole::COLOR, 2);
+		assign(m.normalTexture.index, TextureRole::NORMAL, 3);
+	}
+	return roles;
+}
+
+static std::string textureCachePath(const std::string& modelPath, int imageIndex, TextureRole role) {
+	std::string stem = modelPath.substr(0, modelPath.find_last_of('.'));
+	return stem + ".image" + std::to_string(imageIndex) + "." + textureRoleName(role) + ".ktx2";
+}
+static bool textureCacheFresh(const std::string& cachePath, const std::string& modelPath) {
+	std::error_code ec;
+	auto cacheTime = std::filesystem::last_write_time(cachePath, ec);
+	if (ec) return false;
+	auto sourceTime = std::filesystem::last_write_time(modelPath, ec);
+	return !ec && cacheTime >= sourceTime;
+}
+
+static void imageDecodeRun(ImageDecodeQueue& queue, ImageDecodeJob& job) {
+	PROFILE_FUNCTION();
+	// Basis Universal payloads are already GPU-ready, embedded or external alike
+	if (textureIsKtx2(job.bytes.data(), job.bytes.size())) {
+		job.basis = true;
+		if (ktxTexture2_CreateFromMemory(job.bytes.data(), job.bytes.size(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &job.ktx) != KTX_SUCCESS) {
+			job.ktx = nullptr;
+			return;
+		}
+		job.width = (int)job.ktx->baseWidth;
+		job.height = (int)job.ktx->baseHeight;
+		if (queue.forceCook) {
+			return;
+		}
+		if (!textureTranscodeBasis(job.ktx, queue.basisTarget)) {
+			ktxTexture_Destroy(ktxTexture(job.ktx));
+			job.ktx = nullptr;
+		}
+		return;
+	}
+
+	std::string cachePath;
+	if (queue.compress) {
+		cachePath = textureCachePath(queue.modelPath, job.imageIndex, job.role);
+		if (!queue.forceCook && queue.cacheRead && textureCacheFresh(cachePath, queue.modelPath) &&
+			ktxTexture2_CreateFromNamedFile(cachePath.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &job.ktx) == KTX_SUCCESS) {
+			job.fromCache = true;
+			job.width = (int)job.ktx->baseWidth;
+			job.height = (int)job.ktx->baseHeight;
+			return;
+		}
+	}
+
+	int channels = 0;
+	job.pixels = stbi_load_from_memory(job.bytes.data(), (int)job.bytes.size(), &job.width, &job.height, &channels, STBI_rgb_alpha);
+	if (!queue.compress || !job.pixels) {
+		return;
+	}
+
+	job.ktx = textureCook(job.pixels, job.width, job.height, job.role);
+	if (job.ktx) {
+		// Write next to the model; rename so a crash never leaves a torn cache file
+		std::string tempPath = cachePath + ".tmp";
+		std::error_code ec;
+		if (ktxTexture_WriteToNamedFile(ktxTexture(job.ktx), tempPath.c_str()) == KTX_SUCCESS) {
+			std::filesystem::rename(tempPath, cachePath, ec);
+		}
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+		}
+	}
+}
+
+// With dedupe set, images whose content is already a scene texture (from this
+// model or an earlier one) are resolved on the spot and never decoded.
+static void imageDecodeSubmit(State* state, ImageDecodeQueue& queue, const std::vector<TextureRole>& roles, bool dedupe) {
+	std::unordered_multimap<uint64_t, size_t> firstJob;
+
+	for (size_t i = 0; i < queue.jobs.size(); i++) {
+		ImageDecodeJob& job = queue.jobs[i];
+		if (job.imageIndex >= 0 && job.imageIndex < (int)roles.size()) {
+			job.role = roles[job.imageIndex];
+		}
+
+		if (dedupe) {
+			// The role decides the upload format, so it is part of the key
+			job.contentHash = textureContentHash(job.bytes.data(), job.bytes.size());
+			job.contentHash = textureContentHash(&job.role, sizeof(job.role), job.contentHash);
+			job.contentCheck = textureContentCheck(job.bytes.data(), job.bytes.size());
+			job.contentSize = job.bytes.size();
+
+			// Equal hashes are confirmed against the bytes, the first job still holds them
+			auto [begin, end] = firstJob.equal_range(job.contentHash);
+			for (auto first = begin; first != end; ++first) {
+				const ImageDecodeJob& earlier = queue.jobs[first->second];
+				if (earlier.role == job.role && earlier.bytes == job.bytes) {
+					job.aliasOf = (int)first->second;
+					break;
+				}
+			}
+			if (job.aliasOf >= 0) {
+				job.bytes.clear();
+				job.bytes.shrink_to_fit();
+				continue;
+			}
+			job.textureIndex = textureRegistryAcquire(state, job.contentHash, job.contentCheck, job.contentSize, (uint32_t)job.role);
+			if (job.textureIndex >= 0) {
+				job.bytes.clear();
+				job.bytes.shrink_to_fit();
+				continue;
+			}
+			firstJob.emplace(job.contentHash, i);
+		}
+		queue.submitted++;
+
+		jobSubmit(state, [&queue, i]() {
+			ImageDecodeJob& job = queue.jobs[i];
+			auto start = std::chrono::high_resolution_clock::now();
+			imageDecodeRun(queue, job);
+			job.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.finished.push_back(i);
+			queue.done.notify_one();
+		});
+	}
+}
+
+// Staging memory a batch may hold before it is submitted early
+static constexpr VkDeviceSize UPLOAD_BATCH_STAGING_BYTES = 256ull << 20;
+
+// Keeps an upload batch open for a scope and submits what it recorded, also
+// when an upload throws halfway
+struct UploadBatchScope {
+	State* state;
+	explicit UploadBatchScope(State* state) : state(state) { uploadBatchBegin(state); }
+	~UploadBatchScope() { uploadBatchSubmit(state); }
+};
+
+// Records every submitted image of the model as soon as its decode job
+// completes, all into one upload batch that is submitted and waited on once
+// (or each time its staging memory passes UPLOAD_BATCH_STAGING_BYTES), then
+// fills model.textures in glTF image order.
+// Returns the summed decode time across all jobs.
+static double imageUploadAsDecoded(State* state, ImageDecodeQueue& queue, const tinygltf::Model& gltfModel, Model& model) {
+	PROFILE_FUNCTION();
+	double decodeTotalMs = 0.0;
+	UploadBatchScope batch(state);
+
+	for (size_t uploaded = 0; uploaded < queue.submitted; uploaded++) {
+		size_t jobIndex;
+		{
+			std::unique_lock<std::mutex> lock(queue.mutex);
+			queue.done.wait(lock, [&] { return queue.finished.size() > uploaded; });
+			jobIndex = queue.finished[uploaded];
+		}
+
+		ImageDecodeJob& job = queue.jobs[jobIndex];
+		const tinygltf::Image& image = gltfModel.images[job.imageIndex];
+
+		Texture tex{};
+		tex.name = image.name;
+		const char* source = "rgba8";
+		if (job.ktx) {
+			createTextureFromKtx(state, ktxTexture(job.ktx), tex);
+			ktxTexture_Destroy(ktxTexture(job.ktx));
+			job.ktx = nullptr;
+			source = job.basis ? "basisu" : job.fromCache ? "cache" : "cooked";
+		}
+		else {
+			PANIC(job.basis, "Failed To Transcode KTX2 Image %i (%s)", job.imageIndex, image.name.c_str());
+			PANIC(!job.pixels, "Failed To Decode Image %i (%s): %s", job.imageIndex, image.name.c_str(), stbi_failure_reason());
+			createTextureFromMemory(
+				state,
+				job.pixels,
+				(size_t)job.width * job.height * 4,
+				job.width,
+				job.height,
+				4,
+				tex
+			);
+		}
+		job.textureIndex = (int)textureRegistryInsert(state, job.contentHash, job.contentCheck, job.contentSize, (uint32_t)job.role, tex);
+		job.uploaded = true;
+
+		std::cout << "  image " << job.imageIndex << " \"" << image.name << "\" "
+			<< job.width << "x" << job.height << " " << source << " in " << job.decodeMs << " ms\n";
+
+		decodeTotalMs += job.decodeMs;
+		if (job.pixels) {
+			stbi_image_free(job.pixels);
+			job.pixels = nullptr;
+		}
+		job.bytes.clear();
+		job.bytes.shrink_to_fit();
+
+		if (state->renderer.uploadBatch.stagingBytes >= UPLOAD_BATCH_STAGING_BYTES) {
+			uploadBatchSubmit(state);
+			uploadBatchBegin(state);
+		}
+	}
+	uploadBatchSubmit(state);
+
+	model.textures.assign(gltfModel.images.size(), 0);
+	for (ImageDecodeJob& job : queue.jobs) {
+		if (job.aliasOf >= 0) {
+			job.textureIndex = queue.jobs[job.aliasOf].textureIndex;
+			state->scene.textures[job.textureIndex].refCount++;
+			state->scene.textureRegistry.requested++;
+		}
+		model.textures[job.imageIndex] = (uint32_t)job.textureIndex;
+	}
+	return decodeTotalMs;
+}
+
+static bool blockCompressionAvailable(State* state) {
+	if (!state->context.textureCompressionBC) return false;
+	for (TextureRole role : { TextureRole::COLOR, TextureRole::NORMAL, TextureRole::PACKED_LINEAR, TextureRole::OCCLUSION }) {
+		if (!textureFormatSupported(state, textureRoleFormat(role))) return false;
+	}
+	return true;
+}
+
 //utility
-static void processNode(tinygltf::Model& gltfModel, tinygltf::Node& node, Node* parent, const std::string& baseDir, Model& model)
+static std::vector<float> accessorReadFloats(const tinygltf::Model& gltfModel, int accessorIndex, int components);
+
+static void processNode(tinygltf::Model& gltfModel, const tinygltf::Node& node, uint32_t parent, const std::string& baseDir, Model& model, StringTable& names)
 {
-	Node* newNode = new Node();
-	newNode->name = node.name;
+	PROFILE_FUNCTION();
+	NodeStore& nodes = model.nodes;
+	uint32_t newNode = nodes.add(parent, names.intern(node.name));
+	model.nodeByName.emplace(nodes.name[newNode], newNode);
+	model.nodeFromGltf[&node - gltfModel.nodes.data()] = newNode;
+	model.morphWeightFirst.resize(nodes.size(), UINT32_MAX);
 
 	// ─────────────────────────────────────────────
 	// Node transform
 	// ─────────────────────────────────────────────
 
 	if (!node.matrix.empty()) {
-		newNode->matrix = glm::make_mat4(node.matrix.data());
-		newNode->translation = glm::vec3(0.0f);
-		newNode->rotation = glm::quat(1, 0, 0, 0);
-		newNode->scale = glm::vec3(1.0f);
+		nodes.matrix[newNode] = glm::make_mat4(node.matrix.data());
+		nodes.hasMatrix[newNode] = 1;
 	}
 	else {
 		if (!node.translation.empty())
-			newNode->translation = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
+			nodes.translation[newNode] = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
 		if (!node.rotation.empty())
-			newNode->rotation = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
+			nodes.rotation[newNode] = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
 		if (!node.scale.empty())
-			newNode->scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
-	}
-
-	if (parent) {
-		newNode->parent = parent;
-		parent->children.push_back(newNode);
+			nodes.scale[newNode] = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
 	}
 
 	// ─────────────────────────────────────────────
@@ -58,9 +374,23 @@ static void processNode(tinygltf::Model& gltfModel, tinygltf::Node& node, Node*
 	// ─────────────────────────────────────────────
 	if (node.mesh >= 0) {
 		const tinygltf::Mesh& mesh = gltfModel.meshes[node.mesh];
+		nodes.meshFirst[newNode] = static_cast<uint32_t>(model.meshes.size());
+		nodes.meshCount[newNode] = static_cast<uint32_t>(mesh.primitives.size());
+		nodes.skin[newNode] = node.skin;   // skinsLoad keeps glTF skin order
+
+		// Morph weights: every primitive has the same targets, the node's weights override the mesh's
+		size_t targetCount = mesh.primitives.empty() ? 0 : mesh.primitives[0].targets.size();
+		if (targetCount > 0) {
+			model.morphWeightFirst[newNode] = static_cast<uint32_t>(model.morphWeights.size());
+			const std::vector<double>& defaults = !node.weights.empty() ? node.weights : mesh.weights;
+			for (size_t t = 0; t < targetCount; t++) {
+				model.morphWeights.push_back(t < defaults.size() ? static_cast<float>(defaults[t]) : 0.0f);
+			}
+		}
 
 		for (const auto& primitive : mesh.primitives) {
 			Mesh newMesh;
+			newMesh.morphWeightFirst = model.morphWeightFirst[newNode];
 
 			// ─────────────────────────────────────────────
 			// Index buffer
@@ -199,6 +529,41 @@ static void processNode(tinygltf::Model& gltfModel, tinygltf::Node& node, Node*
 					4 * sizeof(float);
 			}
 
+			// ─────────────────────────────────────────────
+			// JOINTS_0 (ubyte or ushort) + WEIGHTS_0 (float or normalized int)
+			// ─────────────────────────────────────────────
+			bool hasSkin = primitive.attributes.count("JOINTS_0") && primitive.attributes.count("WEIGHTS_0");
+			const tinygltf::Accessor* jointAccessor = nullptr;
+			const tinygltf::BufferView* jointBufferView = nullptr;
+			const tinygltf::Buffer* jointBuffer = nullptr;
+			size_t jointStride = 0;
+			const tinygltf::Accessor* weightAccessor = nullptr;
+			const tinygltf::BufferView* weightBufferView = nullptr;
+			const tinygltf::Buffer* weightBuffer = nullptr;
+			size_t weightStride = 0;
+			size_t weightComponentSize = 0;
+
+			if (hasSkin) {
+				jointAccessor = &gltfModel.accessors[primitive.attributes.at("JOINTS_0")];
+				if (jointAccessor->componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE &&
+					jointAccessor->componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+					throw std::runtime_error("JOINTS_0 must be UNSIGNED_BYTE or UNSIGNED_SHORT");
+
+				jointBufferView = &gltfModel.bufferViews[jointAccessor->bufferView];
+				jointBuffer = &gltfModel.buffers[jointBufferView->buffer];
+				jointStride = jointBufferView->byteStride ?
+					jointBufferView->byteStride :
+					4 * tinygltf::GetComponentSizeInBytes(jointAccessor->componentType);
+
+				weightAccessor = &gltfModel.accessors[primitive.attributes.at("WEIGHTS_0")];
+				weightBufferView = &gltfModel.bufferViews[weightAccessor->bufferView];
+				weightBuffer = &gltfModel.buffers[weightBufferView->buffer];
+				weightComponentSize = tinygltf::GetComponentSizeInBytes(weightAccessor->componentType);
+				weightStride = weightBufferView->byteStride ?
+					weightBufferView->byteStride :
+					4 * weightComponentSize;
+			}
+
 			// ─────────────────────────────────────────────
 			// Vertex loop
 			// ─────────────────────────────────────────────
@@ -280,6 +645,23 @@ static void processNode(tinygltf::Model& gltfModel, tinygltf::Node& node, Node*
 					v.tangent = { t[0], t[2], -t[1], t[3] };
 				}
 
+				// JOINTS_0 / WEIGHTS_0
+				if (hasSkin) {
+					const unsigned char* j = &jointBuffer->data[
+						jointBufferView->byteOffset + jointAccessor->byteOffset + i * jointStride];
+					for (int c = 0; c < 4; c++) {
+						v.joints[c] = jointAccessor->componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
+							? static_cast<uint16_t>(j[c])
+							: reinterpret_cast<const uint16_t*>(j)[c];
+					}
+
+					const unsigned char* w = &weightBuffer->data[
+						weightBufferView->byteOffset + weightAccessor->byteOffset + i * weightStride];
+					for (int c = 0; c < 4; c++) {
+						v.weights[c] = readFloat(w + c * weightComponentSize, weightAccessor->componentType);
+					}
+				}
+
 				newMesh.vertices.push_back(v);
 			}
 
@@ -301,11 +683,44 @@ static void processNode(tinygltf::Model& gltfModel, tinygltf::Node& node, Node*
 				newMesh.indices.push_back(baseVertex + idx);
 			}
 
+			// ─────────────────────────────────────────────
+			// Morph targets: only the vertices a target moves are kept
+			// ─────────────────────────────────────────────
+			if (!primitive.targets.empty()) {
+				newMesh.morphTargetFirst.push_back(0);
+				for (const auto& target : primitive.targets) {
+					auto readDeltas = [&](const char* attribute) {
+						auto it = target.find(attribute);
+						return it != target.end() ? accessorReadFloats(gltfModel, it->second, 3) : std::vector<float>{};
+					};
+					std::vector<float> positions = readDeltas("POSITION");
+					std::vector<float> normals = readDeltas("NORMAL");
+					std::vector<float> tangents = readDeltas("TANGENT");
+
+					// Same (x, z, -y) swap as the vertex, reports whether anything moves
+					auto swapped = [](const std::vector<float>& deltas, size_t i, float* out) {
+						if (deltas.size() < 3 * (i + 1)) return false;
+						out[0] = deltas[3 * i];
+						out[1] = deltas[3 * i + 2];
+						out[2] = -deltas[3 * i + 1];
+						return out[0] != 0.0f || out[1] != 0.0f || out[2] != 0.0f;
+					};
+					for (size_t i = 0; i < posAccessor.count; i++) {
+						MorphDelta delta{ .vertex = baseVertex + static_cast<uint32_t>(i) };
+						bool moves = swapped(positions, i, delta.position);
+						moves |= swapped(normals, i, delta.normal);
+						moves |= swapped(tangents, i, delta.tangent);
+						if (moves) newMesh.morphDeltas.push_back(delta);
+					}
+					newMesh.morphTargetFirst.push_back(static_cast<uint32_t>(newMesh.morphDeltas.size()));
+				}
+			}
+
 			if (primitive.material >= 0)
 				newMesh.materialIndex = model.baseMaterialIndex + primitive.material;
 
 
-			newNode->meshes.push_back(newMesh);
+			model.meshes.push_back(std::move(newMesh));
 		}
 	}
 
@@ -313,29 +728,292 @@ static void processNode(tinygltf::Model& gltfModel, tinygltf::Node& node, Node*
 	// Recurse
 	// ─────────────────────────────────────────────
 	for (int child : node.children)
-		processNode(gltfModel, gltfModel.nodes[child], newNode, baseDir, model);
+		processNode(gltfModel, gltfModel.nodes[child], newNode, baseDir, model, names);
+}
+
+
+// Reads any float or normalized-integer accessor into tightly packed floats.
+// Sparse accessors (common for morph targets) start from zeros when they
+// have no buffer view, then get their listed elements replaced.
+static std::vector<float> accessorReadFloats(const tinygltf::Model& gltfModel, int accessorIndex, int components)
+{
+	const tinygltf::Accessor& accessor = gltfModel.accessors[accessorIndex];
+	size_t componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+
+	auto decode = [&](const unsigned char* src) -> float {
+		switch (accessor.componentType) {
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:          return *reinterpret_cast<const float*>(src);
+		case TINYGLTF_COMPONENT_TYPE_BYTE:           return std::max(*reinterpret_cast<const int8_t*>(src) / 127.0f, -1.0f);
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  return *src / 255.0f;
+		case TINYGLTF_COMPONENT_TYPE_SHORT:          return std::max(*reinterpret_cast<const int16_t*>(src) / 32767.0f, -1.0f);
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: return *reinterpret_cast<const uint16_t*>(src) / 65535.0f;
+		default: throw std::runtime_error("Unsupported accessor componentType");
+		}
+	};
+
+	std::vector<float> out(accessor.count * components, 0.0f);
+	if (accessor.bufferView >= 0) {
+		const tinygltf::BufferView& view = gltfModel.bufferViews[accessor.bufferView];
+		const tinygltf::Buffer& buffer = gltfModel.buffers[view.buffer];
+		size_t stride = view.byteStride ? view.byteStride : componentSize * components;
+		const unsigned char* base = &buffer.data[view.byteOffset + accessor.byteOffset];
+
+		for (size_t i = 0; i < accessor.count; i++) {
+			for (int c = 0; c < components; c++) {
+				out[i * components + c] = decode(base + i * stride + c * componentSize);
+			}
+		}
+	}
+
+	if (accessor.sparse.isSparse) {
+		const auto& sparse = accessor.sparse;
+		const tinygltf::BufferView& indexView = gltfModel.bufferViews[sparse.indices.bufferView];
+		const tinygltf::BufferView& valueView = gltfModel.bufferViews[sparse.values.bufferView];
+		const unsigned char* indices = &gltfModel.buffers[indexView.buffer].data[indexView.byteOffset + sparse.indices.byteOffset];
+		const unsigned char* values = &gltfModel.buffers[valueView.buffer].data[valueView.byteOffset + sparse.values.byteOffset];
+
+		for (int i = 0; i < sparse.count; i++) {
+			size_t element = 0;
+			switch (sparse.indices.componentType) {
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  element = indices[i]; break;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: element = reinterpret_cast<const uint16_t*>(indices)[i]; break;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   element = reinterpret_cast<const uint32_t*>(indices)[i]; break;
+			default: throw std::runtime_error("Unsupported sparse index componentType");
+			}
+			if (element >= accessor.count) continue;
+			for (int c = 0; c < components; c++) {
+				out[element * components + c] = decode(values + (i * components + c) * componentSize);
+			}
+		}
+	}
+	return out;
 }
 
+static void animationsLoad(const tinygltf::Model& gltfModel, Model& model)
+{
+	PROFILE_FUNCTION();
+	for (const tinygltf::Animation& gltfAnimation : gltfModel.animations) {
+		Animation animation{};
+		animation.name = gltfAnimation.name;
+
+		for (const tinygltf::AnimationSampler& gltfSampler : gltfAnimation.samplers) {
+			AnimationSampler sampler{};
+			if (gltfSampler.interpolation == "STEP")
+				sampler.interpolation = AnimationSampler::STEP;
+			else if (gltfSampler.interpolation == "CUBICSPLINE")
+				sampler.interpolation = AnimationSampler::CUBICSPLINE;
+			else
+				sampler.interpolation = AnimationSampler::LINEAR;
+
+			sampler.inputs = accessorReadFloats(gltfModel, gltfSampler.input, 1);
+			if (!sampler.inputs.empty()) {
+				animation.start = std::min(animation.start, sampler.inputs.front());
+				animation.end = std::max(animation.end, sampler.inputs.back());
+			}
+
+			const tinygltf::Accessor& output = gltfModel.accessors[gltfSampler.output];
+			if (output.type == TINYGLTF_TYPE_VEC4) {
+				std::vector<float> values = accessorReadFloats(gltfModel, gltfSampler.output, 4);
+				for (size_t i = 0; i < values.size(); i += 4)
+					sampler.outputsVec4.emplace_back(values[i], values[i + 1], values[i + 2], values[i + 3]);
+			}
+			else if (output.type == TINYGLTF_TYPE_VEC3) {
+				std::vector<float> values = accessorReadFloats(gltfModel, gltfSampler.output, 3);
+				for (size_t i = 0; i < values.size(); i += 3)
+					sampler.outputsVec3.emplace_back(values[i], values[i + 1], values[i + 2]);
+			}
+			else if (output.type == TINYGLTF_TYPE_SCALAR) {
+				sampler.outputsScalar = accessorReadFloats(gltfModel, gltfSampler.output, 1);
+			}
+			animation.samplers.push_back(std::move(sampler));
+		}
+
+		for (const tinygltf::AnimationChannel& gltfChannel : gltfAnimation.channels) {
+			AnimationChannel channel{};
+			if (gltfChannel.target_path == "translation")
+				channel.path = AnimationChannel::TRANSLATION;
+			else if (gltfChannel.target_path == "rotation")
+				channel.path = AnimationChannel::ROTATION;
+			else if (gltfChannel.target_path == "scale")
+				channel.path = AnimationChannel::SCALE;
+			else if (gltfChannel.target_path == "weights")
+				channel.path = AnimationChannel::WEIGHTS;
+			else
+				continue;
+
+			if (gltfChannel.target_node < 0 || gltfChannel.target_node >= (int)model.nodeFromGltf.size())
+				continue;
+			channel.node = model.nodeFromGltf[gltfChannel.target_node];
+			channel.samplerIndex = gltfChannel.sampler;
+			animation.channels.push_back(channel);
+		}
+
+		model.animations.push_back(std::move(animation));
+	}
+}
+
+static void skinsLoad(const tinygltf::Model& gltfModel, Model& model)
+{
+	glm::mat4 unswap = glm::transpose(gltfAxisSwap());
+
+	for (const tinygltf::Skin& gltfSkin : gltfModel.skins) {
+		Skin skin{};
+		skin.name = gltfSkin.name;
+		skin.paletteOffset = model.jointCount;
+
+		std::vector<float> inverseBind;
+		if (gltfSkin.inverseBindMatrices >= 0) {
+			inverseBind = accessorReadFloats(gltfModel, gltfSkin.inverseBindMatrices, 16);
+		}
+
+		for (size_t j = 0; j < gltfSkin.joints.size(); j++) {
+			int gltfNode = gltfSkin.joints[j];
+			// Joints outside the loaded scene stay at the root
+			skin.joints.push_back(gltfNode >= 0 && gltfNode < (int)model.nodeFromGltf.size() && model.nodeFromGltf[gltfNode] != NODE_NONE
+				? model.nodeFromGltf[gltfNode] : 0);
+
+			glm::mat4 bind = j * 16 < inverseBind.size() ? glm::make_mat4(&inverseBind[j * 16]) : glm::mat4(1.0f);
+			skin.jointBind.push_back(bind * unswap);
+		}
+
+		model.jointCount += static_cast<uint32_t>(skin.joints.size());
+		model.skins.push_back(std::move(skin));
+	}
+
+	// Leaf joints: the first ones dropped when animation detail is reduced
+	const NodeStore& nodes = model.nodes;
+	std::vector<uint8_t> isJoint(nodes.size(), 0);
+	for (const Skin& skin : model.skins)
+		for (uint32_t joint : skin.joints) isJoint[joint] = 1;
+
+	model.leafJoint.assign(nodes.size(), 0);
+	for (uint32_t node = 0; node < nodes.size(); node++) {
+		if (!isJoint[node]) continue;
+		bool leaf = true;
+		for (uint32_t child = nodes.firstChild[node]; child != NODE_NONE; child = nodes.nextSibling[child])
+			leaf = leaf && !isJoint[child];
+		model.leafJoint[node] = leaf;
+	}
+}
+
+// Collapses transform-only chains: a node without meshes that no animation
+// channel or skin references is dropped, and its local matrix is baked into
+// its children. Nodes with an animated child stay, since the child's TRS is
+// overwritten every frame and cannot absorb anything. Globals are unchanged.
+// Runs after animationsLoad and skinsLoad, remaps every node index they hold.
+static void nodesFlatten(Model& model)
+{
+	PROFILE_FUNCTION();
+	const NodeStore& nodes = model.nodes;
+	std::vector<uint8_t> referenced(nodes.size(), 0);
+	std::vector<uint8_t> animated(nodes.size(), 0);
+	for (const Animation& animation : model.animations)
+		for (const AnimationChannel& channel : animation.channels)
+			if (channel.node != NODE_NONE) referenced[channel.node] = animated[channel.node] = 1;
+	for (const Skin& skin : model.skins)
+		for (uint32_t joint : skin.joints) referenced[joint] = 1;
+
+	std::vector<uint8_t> keep(nodes.size(), 0);
+	for (uint32_t node = 0; node < nodes.size(); node++) {
+		keep[node] = node == 0 || nodes.meshCount[node] > 0 || referenced[node];
+		for (uint32_t child = nodes.firstChild[node]; child != NODE_NONE && !keep[node]; child = nodes.nextSibling[child])
+			keep[node] = animated[child];
+	}
+
+	// Parents precede children, so one forward pass knows each node's nearest
+	// kept ancestor and the dropped transforms in between
+	NodeStore flat;
+	flat.reserve(nodes.size());
+	std::vector<uint32_t> remap(nodes.size(), NODE_NONE);
+	std::vector<uint32_t> keptParent(nodes.size(), NODE_NONE);
+	std::vector<glm::mat4> dropped(nodes.size(), glm::mat4(1.0f));
+	std::vector<uint8_t> baked(nodes.size(), 0);
+	for (uint32_t node = 0; node < nodes.size(); node++) {
+		uint32_t parent = nodes.parent[node];
+		if (parent != NODE_NONE && !keep[parent]) {
+			keptParent[node] = keptParent[parent];
+			dropped[node] = dropped[parent] * nodes.localMatrix(parent);
+			baked[node] = 1;
+		}
+		else if (parent != NODE_NONE) {
+			keptParent[node] = remap[parent];
+		}
+		if (!keep[node]) continue;
+
+		uint32_t newNode = flat.add(keptParent[node], nodes.name[node]);
+		flat.meshFirst[newNode] = nodes.meshFirst[node];
+		flat.meshCount[newNode] = nodes.meshCount[node];
+		flat.skin[newNode] = nodes.skin[node];
+		flat.translation[newNode] = nodes.translation[node];
+		flat.rotation[newNode] = nodes.rotation[node];
+		flat.scale[newNode] = nodes.scale[node];
+		flat.matrix[newNode] = baked[node] ? dropped[node] * nodes.localMatrix(node) : nodes.matrix[node];
+		flat.hasMatrix[newNode] = baked[node] ? 1 : nodes.hasMatrix[node];
+		remap[node] = newNode;
+	}
+	if (flat.size() == nodes.size()) return;
+
+	for (Animation& animation : model.animations)
+		for (AnimationChannel& channel : animation.channels)
+			if (channel.node != NODE_NONE) channel.node = remap[channel.node];
+	for (Skin& skin : model.skins)
+		for (uint32_t& joint : skin.joints) joint = remap[joint];
+	for (uint32_t& node : model.nodeFromGltf)
+		if (node != NODE_NONE) node = remap[node];
+
+	model.nodeByName.clear();
+	std::vector<uint8_t> leafJoint(flat.size(), 0);
+	std::vector<uint32_t> morphWeightFirst(flat.size(), UINT32_MAX);
+	for (uint32_t node = 0; node < nodes.size(); node++) {
+		if (remap[node] == NODE_NONE) continue;
+		model.nodeByName.emplace(flat.name[remap[node]], remap[node]);
+		if (!model.leafJoint.empty()) leafJoint[remap[node]] = model.leafJoint[node];
+		if (!model.morphWeightFirst.empty()) morphWeightFirst[remap[node]] = model.morphWeightFirst[node];
+	}
+	model.leafJoint = std::move(leafJoint);
+	model.morphWeightFirst = std::move(morphWeightFirst);
+	model.nodes = std::move(flat);
+}
+
+// Bounding sphere of the rest pose, as drawn (skinned meshes placed by their
+// node, as in bind pose). Padded so animated limbs don't leave it.
+static void modelBoundsCompute(Model& model)
+{
+	const NodeStore& nodes = model.nodes;
+	glm::vec3 lo(std::numeric_limits<float>::max());
+	glm::vec3 hi(std::numeric_limits<float>::lowest());
+
+	for (uint32_t node = 0; node < nodes.size(); node++) {
+		const glm::mat4& M = nodes.global[node];
+		for (uint32_t m = nodes.meshFirst[node]; m < nodes.meshFirst[node] + nodes.meshCount[node]; m++) {
+			for (const Vertex& v : model.meshes[m].vertices) {
+				glm::vec3 p = glm::vec3(M * glm::vec4(v.pos, 1.0f));
+				lo = glm::min(lo, p);
+				hi = glm::max(hi, p);
+			}
+		}
+	}
+	if (lo.x > hi.x) return;
 
-void createMeshBuffers(State* state, Node* node) {
-	for (Mesh& mesh : node->meshes) {
-		std::cout << "createMeshBuffers: node=" << node->name
-			<< " verts=" << mesh.vertices.size()
-			<< " idx=" << mesh.indices.size() << "\n";
+	model.boundsCenter = 0.5f * (lo + hi);
+	model.boundsRadius = 0.5f * glm::length(hi - lo) * 1.25f;
+}
 
+void createMeshBuffers(State* state, Model& model) {
+	PROFILE_FUNCTION();
+	for (Mesh& mesh : model.meshes) {
 		if (!mesh.vertices.empty()) {
 			vertexBufferCreateForMesh(state, mesh.vertices, mesh.vertexBuffer, mesh.vertexMemory);
-			std::cout << "  -> VBO created: " << (mesh.vertexBuffer != VK_NULL_HANDLE) << "\n";
 		}
 		if (!mesh.indices.empty()) {
 			indexBufferCreateForMesh(state, mesh.indices, mesh.indexBuffer, mesh.indexMemory);
-			std::cout << "  -> IBO created: " << (mesh.indexBuffer != VK_NULL_HANDLE) << "\n";
+		}
+		if (!mesh.morphDeltas.empty()) {
+			storageBufferCreate(state, mesh.morphDeltas.data(), mesh.morphDeltas.size() * sizeof(MorphDelta), mesh.morphDeltaBuffer, mesh.morphDeltaMemory);
 		}
 	}
-
-	for (Node* child : node->children) {
-		createMeshBuffers(state, child);
-	}
+	std::cout << "createMeshBuffers: " << model.name << " meshes=" << model.meshes.size()
+		<< " nodes=" << model.nodes.size() << "\n";
 }
 
 // Base type
@@ -437,16 +1115,64 @@ static void readTextureTransform(
 
 
 //Loading
-Model* modelLoad(State *state, std::string modelPath)
+// count consecutive Scene::materials, first fit from ranges released models
+// gave back, otherwise appended
+static uint32_t materialRangeAcquire(State* state, uint32_t count)
+{
+	std::vector<MaterialRange>& ranges = state->scene.materialRangesFree;
+	for (size_t i = 0; i < ranges.size() && count > 0; i++) {
+		if (ranges[i].count < count) continue;
+		uint32_t first = ranges[i].first;
+		ranges[i].first += count;
+		ranges[i].count -= count;
+		if (ranges[i].count == 0) ranges.erase(ranges.begin() + i);
+		return first;
+	}
+	uint32_t first = static_cast<uint32_t>(state->scene.materials.size());
+	state->scene.materials.resize(first + count);
+	return first;
+}
+
+static void materialRangeRelease(State* state, MaterialRange range)
 {
+	if (range.count == 0) return;
+	std::vector<MaterialRange>& ranges = state->scene.materialRangesFree;
+	auto it = std::ranges::lower_bound(ranges, range.first, {}, &MaterialRange::first);
+	it = ranges.insert(it, range);
+	// Merge with the following range, then with the preceding one
+	if (it + 1 != ranges.end() && it->first + it->count == (it + 1)->first) {
+		it->count += (it + 1)->count;
+		ranges.erase(it + 1);
+	}
+	if (it != ranges.begin() && (it - 1)->first + (it - 1)->count == it->first) {
+		(it - 1)->count += it->count;
+		ranges.erase(it);
+	}
+}
+
+// Fills a freshly claimed slot; throws on any failure, leaving cleanup to modelLoad
+static void modelLoadSlot(State* state, const std::string& modelPath, Model& model)
+{
+	auto loadStart = std::chrono::high_resolution_clock::now();
+
 	// Use tinygltf to load the model instead of tinyobjloader
-	state->scene.models.emplace_back();
-	Model& model = state->scene.models.back();
+	model.path = modelPath;
+	model.name = modelPath.substr(modelPath.find_last_of("/\\") + 1);
 
 	tinygltf::Model    gltfModel;
 	tinygltf::TinyGLTF loader;
 	std::string        err;
 	std::string        warn;
+	ImageDecodeQueue   decodeQueue;
+
+	decodeQueue.modelPath = modelPath;
+	decodeQueue.compress = state->config.textureCompression && blockCompressionAvailable(state);
+	if (state->config.textureCompression && !decodeQueue.compress) {
+		std::cout << "BC texture formats unsupported, uploading uncompressed\n";
+	}
+	decodeQueue.cacheRead = !state->config.coldStart;
+	decodeQueue.basisTarget = basisTranscodeTargetSelect(state);
+	loader.SetImageLoader(deferImageLoad, &decodeQueue);
 
 	// Detect file extension to determine which loader to use
 	bool ret = false;
@@ -477,14 +1203,20 @@ Model* modelLoad(State *state, std::string modelPath)
 	{
 		throw std::runtime_error("Failed to load glTF model");
 	}
-	model.rootNode = new Node();
-	model.rootNode->name = "Root";
+
+	// Decode runs on the workers while the rest of the model is processed
+	imageDecodeSubmit(state, decodeQueue, imageRolesClassify(gltfModel), true);
+
+	model.nodes.reserve(gltfModel.nodes.size() + 1);
+	model.meshes.reserve(gltfModel.meshes.size());
+	model.nodes.add(NODE_NONE, state->scene.names.intern("Root"));
+	model.nodeFromGltf.assign(gltfModel.nodes.size(), NODE_NONE);
 
 	std::vector<int> textureToImage;
 	textureToImage.reserve(gltfModel.textures.size());
 
-	for (const auto& gltfTex : gltfModel.textures) {
-		textureToImage.push_back(gltfTex.source);
+	for (size_t i = 0; i < gltfModel.textures.size(); i++) {
+		textureToImage.push_back(textureImageSource(gltfModel, (int)i));
 	}
 
 	std::string baseDir = "";
@@ -493,9 +1225,9 @@ Model* modelLoad(State *state, std::string modelPath)
 		baseDir = modelPath.substr(0, lastSlashPos + 1);
 	};
 
-	model.baseMaterialIndex = static_cast<uint32_t>(state->scene.materials.size());
-	model.baseTextureIndex = static_cast<uint32_t>(state->scene.textures.size());
-	state->scene.materials.reserve(gltfModel.materials.size());
+	model.materialCount = static_cast<uint32_t>(gltfModel.materials.size());
+	model.baseMaterialIndex = materialRangeAcquire(state, model.materialCount);
+	uint32_t materialIndex = model.baseMaterialIndex;
 
 	for (const auto& m : gltfModel.materials) {
 		Material mat{};
@@ -525,9 +1257,9 @@ Model* modelLoad(State *state, std::string modelPath)
 		mat.doubleSided = m.doubleSided;
 
 		// Base color texture
-		if (m.pbrMetallicRoughness.baseColorTexture.index >= 0) {
+		if (m.pbrMetallicRoughness.baseColorTexture.index >= 0 && textureToImage[m.pbrMetallicRoughness.baseColorTexture.index] >= 0) {
 			mat.baseColorTextureIndex =
-				model.baseTextureIndex + m.pbrMetallicRoughness.baseColorTexture.index;
+				textureToImage[m.pbrMetallicRoughness.baseColorTexture.index];
 
 			readTextureTransform(
 				m.pbrMetallicRoughness.baseColorTexture,
@@ -536,9 +1268,9 @@ Model* modelLoad(State *state, std::string modelPath)
 		}
 
 		// Metallic-roughness texture
-		if (m.pbrMetallicRoughness.metallicRoughnessTexture.index >= 0) {
+		if (m.pbrMetallicRoughness.metallicRoughnessTexture.index >= 0 && textureToImage[m.pbrMetallicRoughness.metallicRoughnessTexture.index] >= 0) {
 			mat.metallicRoughnessTextureIndex =
-				model.baseTextureIndex + m.pbrMetallicRoughness.metallicRoughnessTexture.index;
+				textureToImage[m.pbrMetallicRoughness.metallicRoughnessTexture.index];
 
 			readTextureTransform(
 				m.pbrMetallicRoughness.metallicRoughnessTexture,
@@ -547,9 +1279,9 @@ Model* modelLoad(State *state, std::string modelPath)
 		}
 
 		// Normal texture
-		if (m.normalTexture.index >= 0) {
-			mat.normalTextureIndex = 
-				model.baseTextureIndex + m.normalTexture.index;
+		if (m.normalTexture.index >= 0 && textureToImage[m.normalTexture.index] >= 0) {
+			mat.normalTextureIndex =
+				textureToImage[m.normalTexture.index];
 
 			readTextureTransform(
 				m.normalTexture,
@@ -558,9 +1290,9 @@ Model* modelLoad(State *state, std::string modelPath)
 		}
 
 		// Occlusion texture
-		if (m.occlusionTexture.index >= 0) {
-			mat.occlusionTextureIndex = 
-				model.baseTextureIndex + m.occlusionTexture.index;
+		if (m.occlusionTexture.index >= 0 && textureToImage[m.occlusionTexture.index] >= 0) {
+			mat.occlusionTextureIndex =
+				textureToImage[m.occlusionTexture.index];
 
 			readTextureTransform(
 				m.occlusionTexture,
@@ -569,9 +1301,9 @@ Model* modelLoad(State *state, std::string modelPath)
 		}
 
 		// Emissive texture
-		if (m.emissiveTexture.index >= 0) {
-			mat.emissiveTextureIndex = 
-				model.baseTextureIndex + m.emissiveTexture.index;
+		if (m.emissiveTexture.index >= 0 && textureToImage[m.emissiveTexture.index] >= 0) {
+			mat.emissiveTextureIndex =
+				textureToImage[m.emissiveTexture.index];
 
 			readTextureTransform(
 				m.emissiveTexture,
@@ -584,96 +1316,416 @@ Model* modelLoad(State *state, std::string modelPath)
 		mat.metallicFactor = m.pbrMetallicRoughness.metallicFactor;
 		mat.roughnessFactor = m.pbrMetallicRoughness.roughnessFactor;
 
-		state->scene.materials.push_back(mat);
+		// A recycled slot keeps the descriptor set its previous owner allocated
+		Material& slot = state->scene.materials[materialIndex++];
+		mat.descriptorSet = slot.descriptorSet;
+		slot = mat;
 	}
 
 
 	const tinygltf::Scene& scene = gltfModel.scenes[gltfModel.defaultScene > -1 ? gltfModel.defaultScene : 0];
 	for (int nodeIndex : scene.nodes) {
-		// Process the node and its children recursively
-		// (Implementation of node processing is omitted for brevity)
-		tinygltf::Node node = gltfModel.nodes[nodeIndex];
-		std::cout << "Loaded node: " << node.name << std::endl;
-		processNode(gltfModel, node, model.rootNode, baseDir, model);
-		gltfModel.nodes[nodeIndex] = node; // Update the node in the model with any changes made during processing
+		// Process the node and its children recursively, under the synthetic root
+		processNode(gltfModel, gltfModel.nodes[nodeIndex], 0, baseDir, model, state->scene.names);
 	}
 
-	createMeshBuffers(state, model.rootNode);
+	animationsLoad(gltfModel, model);
+	if (state->config.animationCompression && !model.animations.empty()) {
+		size_t rawBytes = 0, packedBytes = 0;
+		for (const Animation& animation : model.animations) rawBytes += animationMemory(animation);
+		animationCompress(model);
+		for (const Animation& animation : model.animations) packedBytes += animationMemory(animation);
+		std::cout << "animations: " << model.animations.size() << " clips, "
+			<< rawBytes / 1024.0 << " KB -> " << packedBytes / 1024.0 << " KB compressed\n";
+	}
+	skinsLoad(gltfModel, model);
+	if (state->config.sceneFlatten) {
+		uint32_t nodeCount = model.nodes.size();
+		nodesFlatten(model);
+		std::cout << "nodes: " << nodeCount << " -> " << model.nodes.size() << " after flattening static chains\n";
+	}
+	createMeshBuffers(state, model);
 
+	// The node tree is static, so every instance reuses one flattened draw list
+	model.nodes.updateGlobals();
+	gatherDrawItems(model, glm::vec3(0.0f), state->scene.materials, model.drawItems);
+	modelBoundsCompute(model);
+
+	double decodeTotalMs = 0.0;
+	VkDeviceSize textureMemory = 0;
+	VkDeviceSize uncompressedMemory = 0;
 	if (!gltfModel.images.empty()) {
-		for (const auto& image : gltfModel.images) {
+		decodeTotalMs = imageUploadAsDecoded(state, decodeQueue, gltfModel, model);
+
+		// Materials were filled with glTF image indices, point them at the scene textures
+		for (size_t i = model.baseMaterialIndex; i < model.baseMaterialIndex + model.materialCount; i++) {
+			Material& mat = state->scene.materials[i];
+			for (int* slot : { &mat.baseColorTextureIndex, &mat.metallicRoughnessTextureIndex,
+				&mat.normalTextureIndex, &mat.occlusionTextureIndex, &mat.emissiveTextureIndex }) {
+				if (*slot >= 0 && *slot < (int)model.textures.size()) {
+					*slot = (int)model.textures[*slot];
+				}
+			}
+		}
+
+		// Only what this model added, shared textures were counted by their first owner
+		for (const ImageDecodeJob& job : decodeQueue.jobs) {
+			if (!job.uploaded) continue;
+			textureMemory += state->scene.textures[job.textureIndex].memorySize;
+			uncompressedMemory += state->scene.textures[job.textureIndex].uncompressedSize;
+		}
+	}
+	else {
+		// Fallback texture, keyed by path since the file is only read on a miss
+		std::string fallbackPath = state->config.KOBOLD_TEXTURE_PATH;
+		uint64_t hash = textureContentHash(fallbackPath.data(), fallbackPath.size());
+		uint64_t check = textureContentCheck(fallbackPath.data(), fallbackPath.size());
+		int index = textureRegistryAcquire(state, hash, check, fallbackPath.size(), 0);
+		if (index < 0) {
+			textureImageCreate(state, fallbackPath);
+			textureImageViewCreate(state);
+			textureSamplerCreate(state);
+
+			// Ownership moves to the registry
 			Texture tex{};
-			tex.name = image.name;
+			tex.name = fallbackPath;
+			tex.textureImage = state->texture.textureImage;
+			tex.textureImageMemory = state->texture.textureImageMemory;
+			tex.textureImageView = state->texture.textureImageView;
+			tex.textureSampler = state->texture.textureSampler;
+			tex.mipLevels = state->texture.mipLevels;
+			tex.format = state->texture.format;
+			tex.memorySize = state->texture.memorySize;
+			tex.uncompressedSize = state->texture.uncompressedSize;
+			state->texture.textureImage = VK_NULL_HANDLE;
+			state->texture.textureImageMemory = VK_NULL_HANDLE;
+			state->texture.textureImageView = VK_NULL_HANDLE;
+			state->texture.textureSampler = VK_NULL_HANDLE;
+
+			index = (int)textureRegistryInsert(state, hash, check, fallbackPath.size(), 0, tex);
+		}
+		model.textures.push_back((uint32_t)index);
+	}
 
-			createTextureFromMemory(
-				state,
-				image.image.data(),
-				image.image.size(),
-				image.width,
-				image.height,
-				image.component,
-				tex
-			);
+	// Every load reports, the fallback-texture path included
+	double wallMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+	std::cout << "modelLoad: " << modelPath << " images=" << gltfModel.images.size()
+		<< " decode(sum)=" << decodeTotalMs << " ms wall=" << wallMs << " ms"
+		<< " textureVRAM=" << textureMemory / (1024.0 * 1024.0) << " MB"
+		<< " (RGBA8 " << uncompressedMemory / (1024.0 * 1024.0) << " MB)\n";
+	metricsLoad(state, modelPath, wallMs);
+
+	// Loaded after startup: createMaterialDescriptorSets has already run
+	if (state->renderer.descriptorPool != VK_NULL_HANDLE) {
+		for (uint32_t i = model.baseMaterialIndex; i < model.baseMaterialIndex + model.materialCount; i++)
+			materialDescriptorSetWrite(state, state->scene.materials[i]);
+	}
 
-			state->scene.textures.push_back(tex);
+	std::cout << "textureRegistry: " << state->scene.textureRegistry.byHash.size() << " unique / "
+		<< state->scene.textureRegistry.requested << " requested textures, "
+		<< state->scene.samplerCache.entries.size() << " unique / "
+		<< state->scene.samplerCache.requested << " requested samplers\n";
+
+}
+
+ModelHandle modelLoad(State *state, std::string modelPath)
+{
+	PROFILE_FUNCTION();
+	// Reuse a released slot under a new generation, so stale handles miss
+	ModelHandle handle{};
+	for (uint32_t i = 0; i < state->scene.models.size(); i++) {
+		if (state->scene.models[i].refCount == 0 && state->scene.models[i].path.empty()) {
+			handle = { i, state->scene.models[i].generation + 1 };
+			break;
 		}
 	}
-	else {
-		// Fallback texture
-		Texture tex{};
-		textureImageCreate(state, state->config.KOBOLD_TEXTURE_PATH);
-		textureImageViewCreate(state);
-		textureSamplerCreate(state);
+	if (handle.index == UINT32_MAX) {
+		handle = { static_cast<uint32_t>(state->scene.models.size()), 0 };
+		state->scene.models.emplace_back();
+	}
+	Model& model = state->scene.models[handle.index];
+	model = Model{};
+	model.generation = handle.generation;
+
+	// A failed load releases what it created and leaves the slot free under a
+	// generation no handle was ever given, so it cannot be mistaken for a live model
+	try {
+		modelLoadSlot(state, modelPath, model);
+	}
+	catch (...) {
+		model.refCount = 1;
+		modelRelease(state, handle);
+		throw;
+	}
+	return handle;
+}
 
-		tex.textureImageView = state->texture.textureImageView;
-		tex.textureSampler = state->texture.textureSampler;
+static bool skipImageLoad(tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*)
+{
+	return true;
+}
+
+// Node hierarchy, CPU-side meshes and animations only: no device, no
+// textures. Used by the benchmarks.
+void modelLoadCpu(State* state, std::string modelPath, Model& model)
+{
+	PROFILE_FUNCTION();
+	tinygltf::Model    gltfModel;
+	tinygltf::TinyGLTF loader;
+	std::string        err;
+	std::string        warn;
 
-		state->scene.textures.push_back(tex);
+	loader.SetImageLoader(skipImageLoad, nullptr);
+	bool ret = modelPath.ends_with(".glb")
+		? loader.LoadBinaryFromFile(&gltfModel, &err, &warn, modelPath)
+		: loader.LoadASCIIFromFile(&gltfModel, &err, &warn, modelPath);
+	if (!ret) {
+		throw std::runtime_error("Failed to load glTF model: " + err);
 	}
 
-	return &model;
+	model.path = modelPath;
+	model.name = modelPath.substr(modelPath.find_last_of("/\\") + 1);
+	modelLoadCpu(state, gltfModel, model);
 }
 
-void modelUnload(State* state)
+// The part of modelLoadCpu after parsing; the micro benchmarks feed it synthetic accessors
+void modelLoadCpu(State* state, tinygltf::Model& gltfModel, Model& model)
 {
-	// 1. Destroy mesh buffers for every node in every model
-	std::function<void(Node*)> cleanupNode = [&](Node* node)
-		{
-			for (Mesh& mesh : node->meshes)
-			{
-				if (mesh.vertexBuffer) {
-					vkDestroyBuffer(state->context.device, mesh.vertexBuffer, nullptr);
-					mesh.vertexBuffer = VK_NULL_HANDLE;
-				}
-				if (mesh.vertexMemory) {
-					vkFreeMemory(state->context.device, mesh.vertexMemory, nullptr);
-					mesh.vertexMemory = VK_NULL_HANDLE;
-				}
-				if (mesh.indexBuffer) {
-					vkDestroyBuffer(state->context.device, mesh.indexBuffer, nullptr);
-					mesh.indexBuffer = VK_NULL_HANDLE;
-				}
-				if (mesh.indexMemory) {
-					vkFreeMemory(state->context.device, mesh.indexMemory, nullptr);
-					mesh.indexMemory = VK_NULL_HANDLE;
-				}
-			}
+	PROFILE_FUNCTION();
+	model.nodes.reserve(gltfModel.nodes.size() + 1);
+	model.nodes.add(NODE_NONE, state->scene.names.intern("Root"));
+	model.nodeFromGltf.assign(gltfModel.nodes.size(), NODE_NONE);
 
-			for (Node* child : node->children)
-				if (child) cleanupNode(child);
-		};
+	const tinygltf::Scene& scene = gltfModel.scenes[gltfModel.defaultScene > -1 ? gltfModel.defaultScene : 0];
+	for (int nodeIndex : scene.nodes) {
+		processNode(gltfModel, gltfModel.nodes[nodeIndex], 0, "", model, state->scene.names);
+	}
+	animationsLoad(gltfModel, model);
+	skinsLoad(gltfModel, model);
+	if (state->config.sceneFlatten) nodesFlatten(model);
+	model.nodes.updateGlobals();
+	modelBoundsCompute(model);
+}
 
-	// 2. Walk each model's node tree and clean GPU buffers ONLY
-	for (Model& model : state->scene.models)
+// Offline cooking: rebuilds every .ktx2 cache file for a model without
+// touching the GPU, so content can be shipped pre-cooked.
+void modelCookTextures(State* state, std::string modelPath)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	tinygltf::Model    gltfModel;
+	tinygltf::TinyGLTF loader;
+	std::string        err;
+	std::string        warn;
+	ImageDecodeQueue   decodeQueue;
+
+	decodeQueue.modelPath = modelPath;
+	decodeQueue.compress = true;
+	decodeQueue.forceCook = true;
+	loader.SetImageLoader(deferImageLoad, &decodeQueue);
+
+	bool ret = modelPath.ends_with(".glb")
+		? loader.LoadBinaryFromFile(&gltfModel, &err, &warn, modelPath)
+		: loader.LoadASCIIFromFile(&gltfModel, &err, &warn, modelPath);
+	if (!ret) {
+		throw std::runtime_error("Failed to load glTF model: " + err);
+	}
+
+	imageDecodeSubmit(state, decodeQueue, imageRolesClassify(gltfModel), false);
+	jobWaitIdle(state);
+
+	for (ImageDecodeJob& job : decodeQueue.jobs) {
+		std::cout << "  cooked image " << job.imageIndex << " -> " << (job.basis ? "basisu, kept as shipped" : textureRoleName(job.role))
+			<< (job.ktx ? "" : " FAILED") << " in " << job.decodeMs << " ms\n";
+		if (job.ktx) ktxTexture_Destroy(ktxTexture(job.ktx));
+		if (job.pixels) stbi_image_free(job.pixels);
+		job.ktx = nullptr;
+		job.pixels = nullptr;
+	}
+	double wallMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << "modelCookTextures: " << modelPath << " " << decodeQueue.jobs.size() << " images in " << wallMs << " ms\n";
+}
+
+static void meshBuffersDestroy(State* state, Model& model)
+{
+	for (Mesh& mesh : model.meshes)
 	{
-		if (model.rootNode)
-			cleanupNode(model.rootNode);
+		if (mesh.vertexBuffer) {
+			vkDestroyBuffer(state->context.device, mesh.vertexBuffer, nullptr);
+			mesh.vertexBuffer = VK_NULL_HANDLE;
+		}
+		if (mesh.vertexMemory) {
+			vkFreeMemory(state->context.device, mesh.vertexMemory, nullptr);
+			mesh.vertexMemory = VK_NULL_HANDLE;
+		}
+		if (mesh.indexBuffer) {
+			vkDestroyBuffer(state->context.device, mesh.indexBuffer, nullptr);
+			mesh.indexBuffer = VK_NULL_HANDLE;
+		}
+		if (mesh.indexMemory) {
+			vkFreeMemory(state->context.device, mesh.indexMemory, nullptr);
+			mesh.indexMemory = VK_NULL_HANDLE;
+		}
+		if (mesh.morphDeltaBuffer) {
+			vkDestroyBuffer(state->context.device, mesh.morphDeltaBuffer, nullptr);
+			mesh.morphDeltaBuffer = VK_NULL_HANDLE;
+		}
+		if (mesh.morphDeltaMemory) {
+			vkFreeMemory(state->context.device, mesh.morphDeltaMemory, nullptr);
+			mesh.morphDeltaMemory = VK_NULL_HANDLE;
+		}
 	}
+}
+
+//Asset cache
+Model* modelGet(State* state, ModelHandle handle)
+{
+	if (handle.index >= state->scene.models.size()) return nullptr;
+	Model& model = state->scene.models[handle.index];
+	return model.generation == handle.generation && model.refCount > 0 ? &model : nullptr;
+}
+
+// Loads a glTF the first time its path is requested, later requests share it
+ModelHandle modelAcquire(State* state, std::string modelPath)
+{
+	auto it = state->scene.modelCache.find(modelPath);
+	if (it != state->scene.modelCache.end()) {
+		state->scene.models[it->second.index].refCount++;
+		return it->second;
+	}
+
+	ModelHandle handle = modelLoad(state, modelPath);
+	state->scene.models[handle.index].refCount = 1;
+	state->scene.modelCache[modelPath] = handle;
+	return handle;
+}
+
+// Frees the asset's GPU resources once the last instance lets go. The slot
+// is kept for reuse under the next generation.
+// Callers make sure the GPU is no longer using it.
+void modelRelease(State* state, ModelHandle handle)
+{
+	Model* found = modelGet(state, handle);
+	if (!found || --found->refCount > 0) return;
+	Model& model = *found;
+
+	meshBuffersDestroy(state, model);
+
+	// The range goes back to the free list. Descriptor sets stay in their
+	// slots and are rewritten by whichever model gets the range next.
+	for (uint32_t i = model.baseMaterialIndex; i < model.baseMaterialIndex + model.materialCount; i++) {
+		Material& mat = state->scene.materials[i];
+		if (mat.materialBuffer) {
+			vkDestroyBuffer(state->context.device, mat.materialBuffer, nullptr);
+		}
+		if (mat.materialMemory) {
+			vkFreeMemory(state->context.device, mat.materialMemory, nullptr);
+		}
+		VkDescriptorSet descriptorSet = mat.descriptorSet;
+		mat = Material{};
+		mat.descriptorSet = descriptorSet;
+	}
+	materialRangeRelease(state, { model.baseMaterialIndex, model.materialCount });
+	for (uint32_t texture : model.textures)
+		textureRelease(state, texture);
+
+	state->scene.modelCache.erase(model.path);
+
+	uint32_t generation = model.generation;
+	model = Model{};
+	model.generation = generation;
+}
 
-	// 3. Clear models – this calls ~Model and deletes all nodes in linearNodes
+InstanceHandle modelInstanceCreate(State* state, std::string modelPath)
+{
+	Scene& scene = state->scene;
+	ModelInstance instance{};
+	instance.model = modelAcquire(state, modelPath);
+
+	const Model& model = scene.models[instance.model.index];
+	if (!model.animations.empty()) {
+		animationPoseCreate(model, instance);
+	}
+
+	// Reuse a freed slot under its new generation, so stale handles miss
+	if (scene.instanceSlotsFree.empty()) {
+		scene.instanceSlotsFree.push_back(static_cast<uint32_t>(scene.instanceSlots.size()));
+		scene.instanceSlots.emplace_back();
+	}
+	instance.slot = scene.instanceSlotsFree.back();
+	scene.instanceSlotsFree.pop_back();
+
+	InstanceSlot& slot = scene.instanceSlots[instance.slot];
+	slot.instance = static_cast<uint32_t>(scene.instances.size());
+	scene.instances.push_back(std::move(instance));
+	return InstanceHandle{ .index = scene.instances.back().slot, .generation = slot.generation };
+}
+
+ModelInstance* modelInstanceGet(State* state, InstanceHandle handle)
+{
+	Scene& scene = state->scene;
+	if (handle.index >= scene.instanceSlots.size()) return nullptr;
+	const InstanceSlot& slot = scene.instanceSlots[handle.index];
+	return slot.generation == handle.generation && slot.instance != UINT32_MAX ? &scene.instances[slot.instance] : nullptr;
+}
+
+// Stops drawing the instance at once. Its morph outputs and its reference on
+// the model are dropped by modelInstancesReclaim, once every frame that may
+// have recorded it has finished.
+void modelInstanceDestroy(State* state, InstanceHandle handle)
+{
+	Scene& scene = state->scene;
+	if (!modelInstanceGet(state, handle)) return;
+	InstanceSlot& slot = scene.instanceSlots[handle.index];
+
+	// Swap-and-pop keeps the array packed, the moved instance's slot follows it
+	uint32_t index = slot.instance;
+	std::swap(scene.instances[index], scene.instances.back());
+	scene.instanceSlots[scene.instances[index].slot].instance = index;
+	scene.instancesRetired.push_back({ std::move(scene.instances.back()), state->config.swapchainBuffering });
+	scene.instances.pop_back();
+
+	slot.instance = UINT32_MAX;
+	slot.generation++;
+	scene.instanceSlotsFree.push_back(handle.index);
+}
+
+// Called right after a frame's fence wait: each wait retires one more frame
+// that was in flight when the instance was destroyed
+void modelInstancesReclaim(State* state)
+{
+	std::vector<InstanceRetired>& retired = state->scene.instancesRetired;
+	for (size_t i = 0; i < retired.size();) {
+		if (--retired[i].framesLeft > 0) {
+			i++;
+			continue;
+		}
+		morphInstanceRelease(state, retired[i].instance);
+		modelRelease(state, retired[i].instance.model);
+		std::swap(retired[i], retired.back());
+		retired.pop_back();
+	}
+}
+
+void modelUnload(State* state)
+{
+	// The device is idle, nothing in flight reads the retired instances
+	for (InstanceRetired& retired : state->scene.instancesRetired)
+		morphInstanceRelease(state, retired.instance);
+	state->scene.instancesRetired.clear();
+	state->scene.instances.clear();
+	state->scene.instanceSlots.clear();
+	state->scene.instanceSlotsFree.clear();
+	state->scene.modelCache.clear();
+
+	// 1. Destroy mesh buffers of every model
+	for (Model& model : state->scene.models)
+		meshBuffersDestroy(state, model);
+
+	// 2. Clear models
 	state->scene.models.clear();
 
-	// 4. Destroy global material UBOs
+	// 3. Destroy global material UBOs
 	for (Material& mat : state->scene.materials)
 	{
 		if (mat.materialBuffer) {
@@ -686,27 +1738,30 @@ void modelUnload(State* state)
 		}
 	}
 	state->scene.materials.clear();
+	state->scene.materialRangesFree.clear();
 
-	// 5. Destroy global textures
+	// 4. Destroy global textures, samplers belong to the cache
 	for (Texture& tex : state->scene.textures)
 	{
 		if (tex.textureImageView)
 			vkDestroyImageView(state->context.device, tex.textureImageView, nullptr);
-		if (tex.textureSampler)
-			vkDestroySampler(state->context.device, tex.textureSampler, nullptr);
 		if (tex.textureImage)
 			vkDestroyImage(state->context.device, tex.textureImage, nullptr);
 		if (tex.textureImageMemory)
 			vkFreeMemory(state->context.device, tex.textureImageMemory, nullptr);
 	}
 	state->scene.textures.clear();
+	state->scene.textureRegistry.byHash.clear();
+	samplerCacheDestroy(state);
 
-	// 6. Fallback texture if you still use one
+	// 5. Fallback texture if you still use one
 	textureImageDestroy(state);
 }
 
-void drawMesh(State* state, VkCommandBuffer cmd, const Mesh& mesh, const glm::mat4& nodeMatrix, const glm::mat4& modelTransform)
+void drawMesh(State* state, VkCommandBuffer cmd, const Mesh& mesh, const glm::mat4& nodeMatrix, const glm::mat4& modelTransform, int jointOffset, int vatVertexBase, uint32_t instanceCount, VkBuffer vertexBuffer,
+	const MaterialOverride* materialOverride)
 {
+	const CommandTable& vk = state->context.vk;
 	const Material& mat = state->scene.materials[mesh.materialIndex];
 
 	auto resolveTex = [&](int index) -> const Texture&
@@ -719,7 +1774,7 @@ void drawMesh(State* state, VkCommandBuffer cmd, const Mesh& mesh, const glm::ma
 	const Texture& baseTex = resolveTex(mat.baseColorTextureIndex);
 
 	// Bind descriptor set for this material (set = 1)
-	vkCmdBindDescriptorSets(
+	vk.cmdBindDescriptorSets(
 		cmd,
 		VK_PIPELINE_BIND_POINT_GRAPHICS,
 		state->renderer.pipelineLayout,
@@ -736,6 +1791,11 @@ void drawMesh(State* state, VkCommandBuffer cmd, const Mesh& mesh, const glm::ma
 	pcb.baseColorFactor = mat.baseColorFactor;
 	pcb.metallicFactor = mat.metallicFactor;
 	pcb.roughnessFactor = mat.roughnessFactor;
+	if (materialOverride && materialOverride->active) {
+		pcb.baseColorFactor *= materialOverride->baseColorFactor;
+		if (materialOverride->metallicFactor >= 0.0f) pcb.metallicFactor = materialOverride->metallicFactor;
+		if (materialOverride->roughnessFactor >= 0.0f) pcb.roughnessFactor = materialOverride->roughnessFactor;
+	}
 
 	pcb.baseColorTextureSet = 0;
 	pcb.physicalDescriptorTextureSet = 1;
@@ -744,8 +1804,10 @@ void drawMesh(State* state, VkCommandBuffer cmd, const Mesh& mesh, const glm::ma
 	pcb.emissiveTextureSet = 4;
 	pcb.alphaMask = (mat.alphaMode == "MASK") ? 1.0f : 0.0f;
 	pcb.alphaMaskCutoff = mat.alphaCutoff;
+	pcb.jointOffset = jointOffset;
+	pcb.vatVertexBase = vatVertexBase;
 
-	vkCmdPushConstants(
+	vk.cmdPushConstants(
 		cmd,
 		state->renderer.pipelineLayout,
 		VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
@@ -754,41 +1816,37 @@ void drawMesh(State* state, VkCommandBuffer cmd, const Mesh& mesh, const glm::ma
 		&pcb
 	);
 
-	// Bind vertex + index buffers
+	// Bind vertex + index buffers, morphed instances bring their own vertices
 	VkDeviceSize offsets[] = { 0 };
-	vkCmdBindVertexBuffers(cmd, 0, 1, &mesh.vertexBuffer, offsets);
-	vkCmdBindIndexBuffer(cmd, mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-	vkCmdDrawIndexed(cmd, mesh.indices.size(), 1, 0, 0, 0);
+	VkBuffer vertices = vertexBuffer != VK_NULL_HANDLE ? vertexBuffer : mesh.vertexBuffer;
+	vk.cmdBindVertexBuffers(cmd, 0, 1, &vertices, offsets);
+	vk.cmdBindIndexBuffer(cmd, mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+	vk.cmdDrawIndexed(cmd, mesh.indices.size(), instanceCount, 0, 0, 0);
+
+	RenderStats& stats = state->renderer.stats;
+	stats.descriptorBinds++;
+	stats.pushConstantBytes += sizeof(PushConstantBlock);
+	stats.drawCalls++;
+	stats.instances += instanceCount;
+	stats.triangles += (uint64_t)(mesh.indices.size() / 3) * instanceCount;
 }
 
 
 
 
-void drawNode(State* state,
-	VkCommandBuffer cmd,
-	const Node* node,
-	const glm::mat4& modelTransform)
-{
-	glm::mat4 nodeMatrix = node->getGlobalMatrix();
-
-	for (const Mesh& mesh : node->meshes) {
-		drawMesh(state, cmd, mesh, nodeMatrix, modelTransform);
-	}
-
-	for (const Node* child : node->children) {
-		drawNode(state, cmd, child, modelTransform);
-	}
-}
-void gatherDrawItems(const Node* root, const glm::vec3& camPos, const std::vector<Material>& materials, std::vector<DrawItem>& out) {
-	std::function<void(const Node*)> recurse = [&](const Node* node) {
+// Expects model.nodes.global to be up to date
+void gatherDrawItems(const Model& model, const glm::vec3& camPos, const std::vector<Material>& materials, std::vector<DrawItem>& out) {
+	PROFILE_FUNCTION();
+	const NodeStore& nodes = model.nodes;
 
-		// FIX: extract translation from global matrix
-		glm::mat4 M = node->getGlobalMatrix();
+	for (uint32_t node = 0; node < nodes.size(); node++) {
+		const glm::mat4& M = nodes.global[node];
 		glm::vec3 worldPos = glm::vec3(M[3]);
 		float dist = glm::length(worldPos - camPos);
 
-		for (const Mesh& mesh : node->meshes) {
+		for (uint32_t m = nodes.meshFirst[node]; m < nodes.meshFirst[node] + nodes.meshCount[node]; m++) {
+			const Mesh& mesh = model.meshes[m];
 
 			bool isTransparent = false;
 
@@ -803,18 +1861,16 @@ void gatherDrawItems(const Node* root, const glm::vec3& camPos, const std::vecto
 					isTransparent = true;
 			};
 
+			// glTF ignores a skinned node's own transform, the joints place the mesh
+			int32_t skin = nodes.skin[node];
 			out.push_back({
 				.node = node,
 				.mesh = &mesh,
 				.distanceToCamera = dist,
-				.transparent = isTransparent
+				.transparent = isTransparent,
+				.nodeMatrix = skin >= 0 ? gltfAxisSwap() : M,
+				.skin = skin
 				});
-
 		}
-
-		for (const Node* child : node->children) {
-			recurse(child);
-		}
-	};
-	recurse(root);
+	}
 }
@@ -0,0 +1,321 @@
+#include "headers/morph.h"
+#include "headers/renderer.h"
+
+//Blend
+// Animated weights once the instance has a pose, the asset's defaults otherwise
+const float* morphWeights(const Model& model, const ModelInstance& instance) {
+	return instance.pose.weights.empty() ? model.morphWeights.data() : instance.pose.weights.data();
+}
+
+// CPU version of what morph.comp does: out starts as a copy of the mesh's
+// vertices and only the entries of non-zero targets are touched
+void morphBlendSparse(const Mesh& mesh, const float* weights, Vertex* out) {
+	for (uint32_t t = 0; t < mesh.morphTargetCount(); t++) {
+		float weight = weights[t];
+		if (weight == 0.0f) continue;
+		for (uint32_t d = mesh.morphTargetFirst[t]; d < mesh.morphTargetFirst[t + 1]; d++) {
+			const MorphDelta& delta = mesh.morphDeltas[d];
+			Vertex& vertex = out[delta.vertex];
+			vertex.pos += weight * glm::vec3(delta.position[0], delta.position[1], delta.position[2]);
+			vertex.normal += weight * glm::vec3(delta.normal[0], delta.normal[1], delta.normal[2]);
+			vertex.tangent += weight * glm::vec4(delta.tangent[0], delta.tangent[1], delta.tangent[2], 0.0f);
+		}
+	}
+}
+
+//Compute
+static bool meshMorphed(const Mesh& mesh) {
+	return mesh.morphTargetCount() > 0 && mesh.morphDeltaBuffer != VK_NULL_HANDLE;
+}
+
+static void morphPipelineCreate(State* state) {
+	VkDevice device = state->context.device;
+	Renderer& renderer = state->renderer;
+
+	// binding 0 — sparse deltas of the mesh, binding 1 — the instance's vertices
+	std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+	for (uint32_t binding = 0; binding < bindings.size(); binding++) {
+		bindings[binding] = {
+			.binding = binding,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.pImmutableSamplers = nullptr
+		};
+	}
+	VkDescriptorSetLayoutCreateInfo setLayoutInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount = static_cast<uint32_t>(bindings.size()),
+		.pBindings = bindings.data()
+	};
+	PANIC(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &renderer.morphSetLayout), "Failed To Create Morph Set Layout");
+
+	VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = sizeof(MorphPushConstants),
+	};
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 1,
+		.pSetLayouts = &renderer.morphSetLayout,
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange
+	};
+	PANIC(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &renderer.morphPipelineLayout), "Failed To Create Morph Pipeline Layout");
+
+	auto shaderCode = shaderRead("./res/shaders/morph.spv");
+	VkShaderModuleCreateInfo shaderModuleInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.codeSize = shaderCode.size(),
+		.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data()),
+	};
+	PANIC(vkCreateShaderModule(device, &shaderModuleInfo, nullptr, &renderer.morphShaderModule), "Failed To Create Morph Shader Module");
+
+	VkComputePipelineCreateInfo pipelineInfo{
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.stage = {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+			.module = renderer.morphShaderModule,
+			.pName = "main"
+		},
+		.layout = renderer.morphPipelineLayout,
+	};
+	PANIC(pipelineComputeCreate(state, pipelineInfo, &renderer.morphPipeline), "Failed To Create Morph Pipeline");
+}
+
+// One output vertex buffer per morphed mesh of every instance that exists
+// now; instances added later draw the unmorphed mesh.
+void morphCreate(State* state) {
+	VkDevice device = state->context.device;
+	Renderer& renderer = state->renderer;
+
+	uint32_t outputCount = 0;
+	for (const ModelInstance& instance : state->scene.instances) {
+		const Model* model = modelGet(state, instance.model);
+		if (!model) continue;
+		for (const Mesh& mesh : model->meshes) outputCount += meshMorphed(mesh);
+	}
+	if (outputCount == 0) return;
+
+	morphPipelineCreate(state);
+
+	VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, outputCount * 2 };
+	VkDescriptorPoolCreateInfo poolInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.maxSets = outputCount,
+		.poolSizeCount = 1,
+		.pPoolSizes = &poolSize,
+	};
+	PANIC(vkCreateDescriptorPool(device, &poolInfo, nullptr, &renderer.morphDescriptorPool), "Failed To Create Morph Descriptor Pool");
+
+	for (ModelInstance& instance : state->scene.instances) {
+		const Model* model = modelGet(state, instance.model);
+		if (!model) continue;
+		for (uint32_t m = 0; m < model->meshes.size(); m++) {
+			const Mesh& mesh = model->meshes[m];
+			if (!meshMorphed(mesh)) continue;
+
+			MorphOutput output{ .mesh = m };
+			VkDeviceSize size = mesh.vertices.size() * sizeof(Vertex);
+			createBuffer(state, size,
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, output.buffer, output.memory);
+
+			VkDescriptorSetAllocateInfo allocInfo{
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+				.descriptorPool = renderer.morphDescriptorPool,
+				.descriptorSetCount = 1,
+				.pSetLayouts = &renderer.morphSetLayout
+			};
+			PANIC(vkAllocateDescriptorSets(device, &allocInfo, &output.descriptorSet), "Failed To Allocate Morph Descriptor Set");
+
+			VkDescriptorBufferInfo deltaInfo{ .buffer = mesh.morphDeltaBuffer, .offset = 0, .range = VK_WHOLE_SIZE };
+			VkDescriptorBufferInfo vertexInfo{ .buffer = output.buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+			std::array<VkWriteDescriptorSet, 2> writes{};
+			writes[0] = {
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = output.descriptorSet,
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.pBufferInfo = &deltaInfo
+			};
+			writes[1] = {
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = output.descriptorSet,
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.pBufferInfo = &vertexInfo
+			};
+			vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+			instance.morph.push_back(std::move(output));
+		}
+	}
+}
+
+static void memoryBarrier(const CommandTable& vk, VkCommandBuffer cmd, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+	VkMemoryBarrier barrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask = srcAccess,
+		.dstAccessMask = dstAccess,
+	};
+	vk.cmdPipelineBarrier(cmd, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+// Recorded before the render pass. Outputs whose weights match what they
+// hold after the last submitted frame are skipped; the rest are reset from the mesh's vertices and
+// get one dispatch per non-zero target, over that target's deltas only.
+// Dispatches are issued in rounds (the n-th active target of every output)
+// so only targets of the same output are serialised by a barrier.
+void morphRecord(State* state, VkCommandBuffer cmd) {
+	PROFILE_FUNCTION();
+	const CommandTable& vk = state->context.vk;
+	Renderer& renderer = state->renderer;
+	renderer.morphBlends = renderer.morphCacheHits = renderer.morphDeltasApplied = 0;
+	if (renderer.morphPipeline == VK_NULL_HANDLE) return;
+
+	struct Blend {
+		const MorphOutput* output;
+		const Mesh* mesh;
+		uint32_t firstActive;         // range in active
+		uint32_t activeCount;
+	};
+	std::vector<Blend> blends;
+	std::vector<uint32_t> active;     // non-zero target indices of every blend back to back
+	uint32_t rounds = 0;
+
+	for (ModelInstance& instance : state->scene.instances) {
+		if (instance.morph.empty()) continue;
+		const Model* model = modelGet(state, instance.model);
+		if (!model) continue;
+		const float* weights = morphWeights(*model, instance);
+
+		for (MorphOutput& output : instance.morph) {
+			const Mesh& mesh = model->meshes[output.mesh];
+			const float* meshWeights = weights + mesh.morphWeightFirst;
+			uint32_t targetCount = mesh.morphTargetCount();
+			output.recorded.clear();
+			if (output.weights.size() == targetCount && std::equal(output.weights.begin(), output.weights.end(), meshWeights)) {
+				renderer.morphCacheHits++;
+				continue;
+			}
+			output.recorded.assign(meshWeights, meshWeights + targetCount);
+
+			Blend blend{ &output, &mesh, static_cast<uint32_t>(active.size()), 0 };
+			for (uint32_t t = 0; t < targetCount; t++) {
+				if (meshWeights[t] != 0.0f && mesh.morphTargetFirst[t + 1] > mesh.morphTargetFirst[t]) {
+					active.push_back(t);
+					blend.activeCount++;
+				}
+			}
+			rounds = std::max(rounds, blend.activeCount);
+			blends.push_back(blend);
+		}
+	}
+	renderer.morphBlends = static_cast<uint32_t>(blends.size());
+	if (blends.empty()) return;
+
+	// Earlier frames may still be drawing from or blending into these buffers
+	memoryBarrier(vk, cmd,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+	for (const Blend& blend : blends) {
+		VkBufferCopy region{ .srcOffset = 0, .dstOffset = 0, .size = blend.mesh->vertices.size() * sizeof(Vertex) };
+		vk.cmdCopyBuffer(cmd, blend.mesh->vertexBuffer, blend.output->buffer, 1, &region);
+	}
+
+	if (rounds > 0) {
+		memoryBarrier(vk, cmd,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+		vk.cmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, renderer.morphPipeline);
+		renderer.stats.pipelineBinds++;
+
+		MorphPushConstants push{
+			.vertexStride = sizeof(Vertex) / sizeof(float),
+			.positionOffset = offsetof(Vertex, pos) / sizeof(float),
+			.normalOffset = offsetof(Vertex, normal) / sizeof(float),
+			.tangentOffset = offsetof(Vertex, tangent) / sizeof(float),
+		};
+		for (uint32_t round = 0; round < rounds; round++) {
+			if (round > 0) {
+				memoryBarrier(vk, cmd,
+					VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+					VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+			}
+			for (const Blend& blend : blends) {
+				if (round >= blend.activeCount) continue;
+				uint32_t target = active[blend.firstActive + round];
+				const Mesh& mesh = *blend.mesh;
+
+				push.firstDelta = mesh.morphTargetFirst[target];
+				push.deltaCount = mesh.morphTargetFirst[target + 1] - push.firstDelta;
+				push.weight = blend.output->recorded[target];
+				vk.cmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, renderer.morphPipelineLayout, 0, 1, &blend.output->descriptorSet, 0, nullptr);
+				vk.cmdPushConstants(cmd, renderer.morphPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+				vk.cmdDispatch(cmd, (push.deltaCount + 63) / 64, 1, 1);
+				renderer.stats.descriptorBinds++;
+				renderer.stats.pushConstantBytes += sizeof(push);
+				renderer.stats.dispatches++;
+				renderer.morphDeltasApplied += push.deltaCount;
+			}
+		}
+	}
+
+	memoryBarrier(vk, cmd,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+}
+
+// After the recording went to the queue. Recordings that are never submitted
+// (the ones made at startup and on swapchain recreation) leave the weights as
+// they were, so the next recording blends those outputs again.
+void morphSubmitted(State* state) {
+	for (ModelInstance& instance : state->scene.instances) {
+		for (MorphOutput& output : instance.morph) {
+			if (output.recorded.empty()) continue;
+			output.weights.swap(output.recorded);
+			output.recorded.clear();
+		}
+	}
+}
+
+VkBuffer morphVertexBuffer(const ModelInstance& instance, uint32_t mesh) {
+	for (const MorphOutput& output : instance.morph) {
+		if (output.mesh == mesh) return output.buffer;
+	}
+	return VK_NULL_HANDLE;
+}
+
+// Descriptor sets go back with the pool in morphDestroy
+void morphInstanceRelease(State* state, ModelInstance& instance) {
+	for (MorphOutput& output : instance.morph) {
+		vkDestroyBuffer(state->context.device, output.buffer, nullptr);
+		vkFreeMemory(state->context.device, output.memory, nullptr);
+	}
+	instance.morph.clear();
+}
+
+void morphDestroy(State* state) {
+	VkDevice device = state->context.device;
+	Renderer& renderer = state->renderer;
+	for (ModelInstance& instance : state->scene.instances) {
+		morphInstanceRelease(state, instance);
+	}
+	if (renderer.morphPipeline == VK_NULL_HANDLE) return;
+
+	vkDestroyDescriptorPool(device, renderer.morphDescriptorPool, nullptr);
+	vkDestroyPipeline(device, renderer.morphPipeline, nullptr);
+	vkDestroyPipelineLayout(device, renderer.morphPipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(device, renderer.morphSetLayout, nullptr);
+	vkDestroyShaderModule(device, renderer.morphShaderModule, nullptr);
+	renderer.morphDescriptorPool = VK_NULL_HANDLE;
+	renderer.morphPipeline = VK_NULL_HANDLE;
+	renderer.morphPipelineLayout = VK_NULL_HANDLE;
+	renderer.morphSetLayout = VK_NULL_HANDLE;
+	renderer.morphShaderModule = VK_NULL_HANDLE;
+}
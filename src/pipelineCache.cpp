@@ -0,0 +1,205 @@
+#include "headers/pipelineCache.h"
+#include <filesystem>
+#include <fstream>
+
+// Written in front of the driver's data. Vulkan's own header only carries the
+// vendor, device and cache UUID; the driver version is checked here as well,
+// and the hash catches files torn or edited outside the atomic write.
+struct PipelineCacheFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint64_t dataSize;
+	uint64_t dataHash;
+};
+static constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43505256;   // "VRPC"
+static constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+
+//Utility
+// FNV-1a, 64-bit
+static uint64_t pipelineCacheHash(const std::vector<char>& data) {
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (char byte : data) {
+		hash = (hash ^ static_cast<uint8_t>(byte)) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static PipelineCacheFileHeader pipelineCacheHeaderExpected(State* state) {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(state->context.physicalDevice, &properties);
+	PipelineCacheFileHeader header{
+		.magic = PIPELINE_CACHE_MAGIC,
+		.version = PIPELINE_CACHE_VERSION,
+		.vendorID = properties.vendorID,
+		.deviceID = properties.deviceID,
+		.driverVersion = properties.driverVersion,
+	};
+	memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+	return header;
+}
+
+// The file's data if every check passes, else empty with the reason in why
+static std::vector<char> pipelineCacheRead(State* state, const std::string& path, std::string& why) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		why = "no file yet";
+		return {};
+	}
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	file.seekg(0);
+	PipelineCacheFileHeader header{};
+	if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		why = "truncated header";
+		return {};
+	}
+
+	PipelineCacheFileHeader expected = pipelineCacheHeaderExpected(state);
+	if (header.magic != expected.magic || header.version != expected.version) {
+		why = "not a pipeline cache of this version";
+		return {};
+	}
+	if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID) {
+		why = "written on another device";
+		return {};
+	}
+	if (header.driverVersion != expected.driverVersion ||
+		memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+		why = "written by another driver";
+		return {};
+	}
+	if (header.dataSize != fileSize - sizeof(header)) {
+		why = "size does not match the header";
+		return {};
+	}
+
+	std::vector<char> data(header.dataSize);
+	if (!file.read(data.data(), data.size()) || pipelineCacheHash(data) != header.dataHash) {
+		why = "data does not match its hash";
+		return {};
+	}
+
+	// The driver's own header, which vkCreatePipelineCache would also check
+	VkPipelineCacheHeaderVersionOne driverHeader{};
+	if (data.size() < sizeof(driverHeader)) {
+		why = "no driver header";
+		return {};
+	}
+	memcpy(&driverHeader, data.data(), sizeof(driverHeader));
+	if (driverHeader.headerSize < sizeof(driverHeader) || driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+		driverHeader.vendorID != expected.vendorID || driverHeader.deviceID != expected.deviceID ||
+		memcmp(driverHeader.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+		why = "driver header does not match this device";
+		return {};
+	}
+	return data;
+}
+
+//Cache
+void pipelineCacheCreate(State* state) {
+	PROFILE_FUNCTION();
+	Context& context = state->context;
+	context.pipelineCacheStats = PipelineCacheStats{};
+	const std::string& path = state->config.pipelineCachePath;
+	if (path.empty()) {
+		context.pipelineCache = VK_NULL_HANDLE;
+		printf("pipeline cache: off\n");
+		return;
+	}
+
+	std::string why = "ignored for a cold start";
+	std::vector<char> data = state->config.coldStart ? std::vector<char>{} : pipelineCacheRead(state, path, why);
+	VkPipelineCacheCreateInfo cacheInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.initialDataSize = data.size(),
+		.pInitialData = data.empty() ? nullptr : data.data(),
+	};
+	if (!data.empty() && vkCreatePipelineCache(context.device, &cacheInfo, nullptr, &context.pipelineCache) != VK_SUCCESS) {
+		// The driver may still refuse data that passed every check above
+		why = "rejected by the driver";
+		data.clear();
+		cacheInfo.initialDataSize = 0;
+		cacheInfo.pInitialData = nullptr;
+	}
+	if (data.empty()) {
+		PANIC(vkCreatePipelineCache(context.device, &cacheInfo, nullptr, &context.pipelineCache), "Failed To Create Pipeline Cache");
+		printf("pipeline cache: %s, %s: starting empty\n", path.c_str(), why.c_str());
+		return;
+	}
+	context.pipelineCacheStats.loadedBytes = data.size();
+	context.pipelineCacheStats.savedHash = pipelineCacheHash(data);
+	printf("pipeline cache: %.1f KB loaded from %s\n", data.size() / 1024.0, path.c_str());
+}
+
+void pipelineCacheSave(State* state) {
+	PROFILE_FUNCTION();
+	Context& context = state->context;
+	const std::string& path = state->config.pipelineCachePath;
+	if (context.pipelineCache == VK_NULL_HANDLE || path.empty()) return;
+
+	size_t size = 0;
+	PANIC(vkGetPipelineCacheData(context.device, context.pipelineCache, &size, nullptr), "Failed To Get Pipeline Cache Size");
+	std::vector<char> data(size);
+	PANIC(vkGetPipelineCacheData(context.device, context.pipelineCache, &size, data.data()), "Failed To Get Pipeline Cache Data");
+	data.resize(size);
+	uint64_t hash = pipelineCacheHash(data);
+	if (data.empty() || hash == context.pipelineCacheStats.savedHash) return;
+
+	PipelineCacheFileHeader header = pipelineCacheHeaderExpected(state);
+	header.dataSize = data.size();
+	header.dataHash = hash;
+
+	// Written next to the target and renamed over it, so readers see the old file or the new one
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			printf("pipeline cache: cannot write %s\n", tempPath.c_str());
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(data.data(), data.size());
+		if (!file.flush()) {
+			printf("pipeline cache: writing %s failed\n", tempPath.c_str());
+			return;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(tempPath, path, ec);
+	if (ec) {
+		std::filesystem::remove(tempPath, ec);
+		printf("pipeline cache: cannot replace %s\n", path.c_str());
+		return;
+	}
+	context.pipelineCacheStats.savedHash = hash;
+	printf("pipeline cache: %.1f KB written to %s\n", data.size() / 1024.0, path.c_str());
+}
+
+void pipelineCacheDestroy(State* state) {
+	if (state->context.pipelineCache == VK_NULL_HANDLE) return;
+	pipelineCacheSave(state);
+	vkDestroyPipelineCache(state->context.device, state->context.pipelineCache, nullptr);
+	state->context.pipelineCache = VK_NULL_HANDLE;
+}
+
+//Pipelines
+VkResult pipelineGraphicsCreate(State* state, const VkGraphicsPipelineCreateInfo& info, VkPipeline* pipeline) {
+	PROFILE_FUNCTION();
+	auto start = std::chrono::high_resolution_clock::now();
+	VkResult result = vkCreateGraphicsPipelines(state->context.device, state->context.pipelineCache, 1, &info, nullptr, pipeline);
+	state->context.pipelineCacheStats.createMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	state->context.pipelineCacheStats.pipelines++;
+	return result;
+}
+
+VkResult pipelineComputeCreate(State* state, const VkComputePipelineCreateInfo& info, VkPipeline* pipeline) {
+	PROFILE_FUNCTION();
+	auto start = std::chrono::high_resolution_clock::now();
+	VkResult result = vkCreateComputePipelines(state->context.device, state->context.pipelineCache, 1, &info, nullptr, pipeline);
+	state->context.pipelineCacheStats.createMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	state->context.pipelineCacheStats.pipelines++;
+	return result;
+}
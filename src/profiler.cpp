@@ -0,0 +1,126 @@
+#include "headers/profiler.h"
+#include <cstdio>
+#include <algorithm>
+
+#ifdef VR_ENABLE_PROFILER
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Rings
+// Power of two; 32768 zones x 24 bytes per recording thread. The oldest
+// zones are overwritten once a thread has recorded more than that.
+static constexpr uint64_t PROFILE_RING_SIZE = 1 << 15;
+
+struct ProfileEvent {
+	const char* name;
+	int64_t start;
+	int64_t end;
+};
+
+// Written only by its owning thread; head is published with release so the
+// exporter sees complete events up to it
+struct ProfileRing {
+	std::array<ProfileEvent, PROFILE_RING_SIZE> events;
+	std::atomic<uint64_t> head{ 0 };
+	uint32_t threadId = 0;
+	std::string threadName;
+};
+
+static std::mutex profileRingsMutex;
+static std::vector<std::unique_ptr<ProfileRing>> profileRings;
+static const int64_t profileEpoch = profilerNow();
+static const std::chrono::steady_clock::time_point profileEpochClock = std::chrono::steady_clock::now();
+
+// The registry lock is only taken the first time a thread records
+static ProfileRing* profilerRing() {
+	thread_local ProfileRing* ring = nullptr;
+	if (!ring) {
+		std::lock_guard<std::mutex> lock(profileRingsMutex);
+		profileRings.push_back(std::make_unique<ProfileRing>());
+		ring = profileRings.back().get();
+		ring->threadId = static_cast<uint32_t>(profileRings.size());
+		ring->threadName = "thread " + std::to_string(ring->threadId);
+	}
+	return ring;
+}
+
+void profilerRecord(const char* name, int64_t start, int64_t end) {
+	ProfileRing* ring = profilerRing();
+	uint64_t head = ring->head.load(std::memory_order_relaxed);
+	ring->events[head & (PROFILE_RING_SIZE - 1)] = { name, start, end };
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+//Threads
+void profilerThreadName(const std::string& name) {
+	ProfileRing* ring = profilerRing();
+	std::lock_guard<std::mutex> lock(profileRingsMutex);
+	ring->threadName = name;
+}
+
+//Export
+// Copies a ring without stopping its thread. Events the writer may have
+// lapped while they were being copied are dropped.
+static std::vector<ProfileEvent> profilerRingSnapshot(const ProfileRing& ring) {
+	uint64_t head = ring.head.load(std::memory_order_acquire);
+	uint64_t first = head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0;
+	std::vector<ProfileEvent> events;
+	events.reserve(head - first);
+	for (uint64_t i = first; i < head; i++) {
+		events.push_back(ring.events[i & (PROFILE_RING_SIZE - 1)]);
+	}
+
+	uint64_t headAfter = ring.head.load(std::memory_order_acquire);
+	uint64_t overwritten = headAfter > PROFILE_RING_SIZE ? headAfter - PROFILE_RING_SIZE : 0;
+	if (overwritten > first) {
+		events.erase(events.begin(), events.begin() + std::min<uint64_t>(overwritten - first, events.size()));
+	}
+	return events;
+}
+
+bool profilerTraceWrite(const std::string& path) {
+	// Ticks per microsecond over the whole run so far
+	double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - profileEpochClock).count();
+	int64_t elapsedTicks = profilerNow() - profileEpoch;
+	double ticksToUs = elapsedTicks > 0 ? elapsedUs / elapsedTicks : 0.0;
+
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file) {
+		fprintf(stderr, "profiler: cannot write %s\n", path.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(profileRingsMutex);
+	size_t zoneCount = 0;
+	const char* separator = "";
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (const std::unique_ptr<ProfileRing>& ring : profileRings) {
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			separator, ring->threadId, ring->threadName.c_str());
+		separator = ",\n";
+		for (const ProfileEvent& event : profilerRingSnapshot(*ring)) {
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				event.name, ring->threadId, (event.start - profileEpoch) * ticksToUs, (event.end - event.start) * ticksToUs);
+			zoneCount++;
+		}
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	printf("profiler: %zu zones from %zu threads written to %s\n", zoneCount, profileRings.size(), path.c_str());
+	return true;
+}
+
+#else
+
+void profilerThreadName(const std::string&) {}
+
+bool profilerTraceWrite(const std::string& path) {
+	printf("profiler: built without VR_ENABLE_PROFILER, %s not written\n", path.c_str());
+	return false;
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include "headers/renderStats.h"
+#include "headers/gpuProfiler.h"
+
+// Heap figures come from the driver; a few times a second is plenty
+static constexpr uint64_t MEMORY_REFRESH_FRAMES = 15;
+
+//Frame
+void renderStatsFrameBegin(State* state) {
+	RenderStats& stats = state->renderer.stats;
+	stats.drawCalls = 0;
+	stats.dispatches = 0;
+	stats.instances = 0;
+	stats.triangles = 0;
+	stats.pipelineBinds = 0;
+	stats.descriptorBinds = 0;
+	stats.pushConstantBytes = 0;
+	stats.uploads = 0;
+	stats.uploadWaitMs = 0.0;
+}
+
+void renderStatsFrameEnd(State* state) {
+	RenderStats& stats = state->renderer.stats;
+	auto now = std::chrono::steady_clock::now();
+	if (stats.frames > 0) {
+		stats.cpuFrameMs[stats.historyHead] = std::chrono::duration<float, std::milli>(now - stats.lastFrameEnd).count();
+		stats.gpuFrameMs[stats.historyHead] = (float)gpuScopeMs(state, "frame");
+		stats.historyHead = (stats.historyHead + 1) % RENDER_STATS_HISTORY;
+	}
+	stats.lastFrameEnd = now;
+
+	// Triangles that entered clipping but never left it: outside the frustum.
+	// There is no CPU culling, so this is the only culled count there is.
+	stats.trianglesCulled = 0;
+	for (const GpuScope& scope : state->renderer.profiler.results) {
+		if (scope.statisticsQuery < 0) continue;
+		if (strcmp(scope.name, "opaque") != 0 && strcmp(scope.name, "transparent") != 0) continue;
+		uint64_t entered = scope.statistics[GPU_STAT_CLIPPING_INVOCATIONS];
+		uint64_t left = scope.statistics[GPU_STAT_CLIPPING_PRIMITIVES];
+		stats.trianglesCulled += entered > left ? entered - left : 0;
+	}
+
+	if (stats.frames % MEMORY_REFRESH_FRAMES == 0) {
+		renderStatsMemoryUpdate(state);
+	}
+	stats.frames++;
+}
+
+//Memory
+void renderStatsMemoryUpdate(State* state) {
+	RenderStats& stats = state->renderer.stats;
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+	};
+	VkPhysicalDeviceMemoryProperties2 properties{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+		.pNext = state->context.memoryBudget ? &budget : nullptr,
+	};
+	if (state->context.getMemoryProperties2)
+		state->context.getMemoryProperties2(state->context.physicalDevice, &properties);
+	else
+		vkGetPhysicalDeviceMemoryProperties(state->context.physicalDevice, &properties.memoryProperties);
+
+	const VkPhysicalDeviceMemoryProperties& memory = properties.memoryProperties;
+	stats.heapCount = memory.memoryHeapCount;
+	for (uint32_t i = 0; i < memory.memoryHeapCount; i++) {
+		stats.heapSize[i] = memory.memoryHeaps[i].size;
+		stats.heapDeviceLocal[i] = (memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		stats.heapUsage[i] = state->context.memoryBudget ? budget.heapUsage[i] : 0;
+		stats.heapBudget[i] = state->context.memoryBudget ? budget.heapBudget[i] : memory.memoryHeaps[i].size;
+	}
+}
+
+//Queries
+double renderStatsBlockedFraction(const State* state) {
+	const RenderStats& stats = state->renderer.stats;
+	float frameMs = stats.cpuFrameMs[(stats.historyHead + RENDER_STATS_HISTORY - 1) % RENDER_STATS_HISTORY];
+	if (frameMs <= 0.0f) return 0.0;
+	return std::min(1.0, (stats.fenceWaitMs + stats.acquireMs) / frameMs);
+}
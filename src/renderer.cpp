@@ -1,7 +1,7 @@
 #pragma once
 #include "headers/renderer.h"
 //utility
-static std::vector<char> shaderRead(const char* filePath) {
+std::vector<char> shaderRead(const char* filePath) {
 	std::ifstream file(filePath, std::ios::ate | std::ios::binary);
 	PANIC(!file.is_open(), "Failed To Open Shader: %s", filePath);
 	size_t fileSize = (size_t)file.tellg();
@@ -51,7 +51,8 @@ void renderPassCreate(State* state) {
 	colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// Headless frames are copied out instead of presented
+	colorAttachmentResolve.finalLayout = state->config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 	
 	VkAttachmentReference colorAttachmentResolveRef{};
 	colorAttachmentResolveRef.attachment = 2;
@@ -89,9 +90,12 @@ void renderPassDestroy(State* state) {
 	vkDestroyRenderPass(state->context.device, state->renderer.renderPass, nullptr);
 };
 
-// set 0: global UBO
+// set 0: global UBO + joint palette + crowd vertex animation textures
 void createGlobalSetLayout(State* state) {
-	VkDescriptorSetLayoutBinding uboBinding{
+	std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+
+	// binding 0 — global UBO
+	bindings[0] = {
 		.binding = 0,
 		.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
 		.descriptorCount = 1,
@@ -99,10 +103,39 @@ void createGlobalSetLayout(State* state) {
 		.pImmutableSamplers = nullptr
 	};
 
+	// binding 1 — joint matrices of every skinned instance this frame
+	bindings[1] = {
+		.binding = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+		.pImmutableSamplers = nullptr
+	};
+
+	// binding 2, 3 — crowd vertex animation textures (positions, normals)
+	for (uint32_t binding = 2; binding <= 3; binding++) {
+		bindings[binding] = {
+			.binding = binding,
+			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+			.pImmutableSamplers = nullptr
+		};
+	}
+
+	// binding 4 — crowd placement and playback, one VatInstance per member
+	bindings[4] = {
+		.binding = 4,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+		.pImmutableSamplers = nullptr
+	};
+
 	VkDescriptorSetLayoutCreateInfo info{
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-		.bindingCount = 1,
-		.pBindings = &uboBinding
+		.bindingCount = static_cast<uint32_t>(bindings.size()),
+		.pBindings = bindings.data()
 	};
 
 	PANIC(
@@ -344,7 +377,7 @@ void graphicsPipelineCreate(State* state) {
 		.subpass = 0,
 		.basePipelineHandle = VK_NULL_HANDLE, // Optional
 	};
-	PANIC(vkCreateGraphicsPipelines(state->context.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &state->renderer.graphicsPipeline),"Failed To Create GraphicsPipeline");
+	PANIC(pipelineGraphicsCreate(state, pipelineInfo, &state->renderer.graphicsPipeline),"Failed To Create GraphicsPipeline");
 };
 void graphicsPipelineDestroy(State* state) {
 	vkDestroyPipelineLayout(state->context.device, state->renderer.pipelineLayout, nullptr);
@@ -369,12 +402,14 @@ void descriptorPoolCreate(State* state)
 	uint32_t frames = state->config.swapchainBuffering;
 	uint32_t materialCount = state->scene.materials.size();
 
-	uint32_t imageDescriptorCount = materialCount * 5 * state->renderer.descriptorPoolMultiplier;
+	uint32_t imageDescriptorCount = (materialCount * 5 + frames * 2) * state->renderer.descriptorPoolMultiplier;
 	uint32_t uboDescriptorCount = frames * state->renderer.descriptorPoolMultiplier;
+	uint32_t storageDescriptorCount = frames * 2 * state->renderer.descriptorPoolMultiplier;
 
-	std::array<VkDescriptorPoolSize, 2> poolSizes{
+	std::array<VkDescriptorPoolSize, 3> poolSizes{
 		VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, uboDescriptorCount },
-		VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageDescriptorCount }
+		VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageDescriptorCount },
+		VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageDescriptorCount }
 	};
 
 	uint32_t totalSets = (frames + materialCount) * state->renderer.descriptorPoolMultiplier;
@@ -442,7 +477,35 @@ void descriptorSetsCreate(State* state)
 			.range = sizeof(UniformBufferObject)
 		};
 
-		VkWriteDescriptorSet writeUBO{
+		VkDescriptorBufferInfo jointInfo{
+			.buffer = state->renderer.jointBuffers[i],
+			.offset = 0,
+			.range = VK_WHOLE_SIZE
+		};
+
+		// Without a crowd the VAT bindings still need valid descriptors, the
+		// shader never reads them
+		const VatCrowd& crowd = state->scene.crowd;
+		const Texture& fallback = state->scene.textures[state->scene.defaultTextureIndex];
+		bool hasCrowd = crowd.instanceCount > 0;
+		VkDescriptorImageInfo vatPositionInfo{
+			.sampler = hasCrowd ? crowd.sampler : fallback.textureSampler,
+			.imageView = hasCrowd ? crowd.positionView : fallback.textureImageView,
+			.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		};
+		VkDescriptorImageInfo vatNormalInfo{
+			.sampler = hasCrowd ? crowd.sampler : fallback.textureSampler,
+			.imageView = hasCrowd ? crowd.normalView : fallback.textureImageView,
+			.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		};
+		VkDescriptorBufferInfo vatInstanceInfo{
+			.buffer = hasCrowd ? crowd.instanceBuffer : state->renderer.jointBuffers[i],
+			.offset = 0,
+			.range = VK_WHOLE_SIZE
+		};
+
+		std::array<VkWriteDescriptorSet, 5> writes{};
+		writes[0] = {
 			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 			.dstSet = state->renderer.descriptorSets[i],
 			.dstBinding = 0,
@@ -450,11 +513,43 @@ void descriptorSetsCreate(State* state)
 			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
 			.pBufferInfo = &bufferInfo
 		};
+		writes[1] = {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = state->renderer.descriptorSets[i],
+			.dstBinding = 1,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.pBufferInfo = &jointInfo
+		};
+		writes[2] = {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = state->renderer.descriptorSets[i],
+			.dstBinding = 2,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.pImageInfo = &vatPositionInfo
+		};
+		writes[3] = {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = state->renderer.descriptorSets[i],
+			.dstBinding = 3,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.pImageInfo = &vatNormalInfo
+		};
+		writes[4] = {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = state->renderer.descriptorSets[i],
+			.dstBinding = 4,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.pBufferInfo = &vatInstanceInfo
+		};
 
 		vkUpdateDescriptorSets(
 			state->context.device,
-			1,
-			&writeUBO,
+			static_cast<uint32_t>(writes.size()),
+			writes.data(),
 			0,
 			nullptr
 		);
@@ -493,11 +588,15 @@ void createBufferForMaterial(
 }
 void createMaterialDescriptorSets(State* state)
 {
-	uint32_t materialCount = state->scene.materials.size();
-	if (materialCount == 0) return;
-
 	for (Material& mat : state->scene.materials)
-	{
+		materialDescriptorSetWrite(state, mat);
+}
+
+// Points the material's set at its textures and a fresh material UBO. A set
+// left behind by a released model in the same slot is reused, not reallocated.
+void materialDescriptorSetWrite(State* state, Material& mat)
+{
+	if (mat.descriptorSet == VK_NULL_HANDLE) {
 		VkDescriptorSetAllocateInfo allocInfo{
 			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
 			.descriptorPool = state->renderer.descriptorPool,
@@ -508,81 +607,80 @@ void createMaterialDescriptorSets(State* state)
 		VkResult result = allocateDescriptorSetsWithResize(state, &allocInfo, &mat.descriptorSet);
 
 		PANIC(result, "Failed to allocate material descriptor set");
+	}
 
 
-		auto resolveTex = [&](int index) -> const Texture&
-			{
-				if (index >= 0 && index < state->scene.textures.size())
-					return state->scene.textures[index];
-				return state->scene.textures[state->scene.defaultTextureIndex];
-			};
-
-		const Texture& baseTex = resolveTex(mat.baseColorTextureIndex);
-		const Texture& mrTex = resolveTex(mat.metallicRoughnessTextureIndex);
-		const Texture& occTex = resolveTex(mat.occlusionTextureIndex);
-		const Texture& emisTex = resolveTex(mat.emissiveTextureIndex);
-		const Texture& normTex = resolveTex(mat.normalTextureIndex);
-		
-		// Create/fill MaterialGPU
-		MaterialGPU gpu{};
-		gpu.baseColorTT = toGPU(mat.baseColorTransform);
-		gpu.mrTT = toGPU(mat.metallicRoughnessTransform);
-		gpu.normalTT = toGPU(mat.normalTransform);
-		gpu.occlusionTT = toGPU(mat.occlusionTransform);
-		gpu.emissiveTT = toGPU(mat.emissiveTransform);
-
-		// Create a small uniform buffer for this material (you already have helpers for UBOs)
-		createBufferForMaterial(state, sizeof(MaterialGPU),
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			&mat.materialBuffer, &mat.materialMemory);
-
-		void* data = nullptr;
-		vkMapMemory(state->context.device, mat.materialMemory, 0, sizeof(MaterialGPU), 0, &data);
-		memcpy(data, &gpu, sizeof(MaterialGPU));
-		vkUnmapMemory(state->context.device, mat.materialMemory);
-
-		VkDescriptorBufferInfo materialBufInfo{
-			.buffer = mat.materialBuffer,
-			.offset = 0,
-			.range = sizeof(MaterialGPU)
+	auto resolveTex = [&](int index) -> const Texture&
+		{
+			if (index >= 0 && index < state->scene.textures.size())
+				return state->scene.textures[index];
+			return state->scene.textures[state->scene.defaultTextureIndex];
 		};
 
+	const Texture& baseTex = resolveTex(mat.baseColorTextureIndex);
+	const Texture& mrTex = resolveTex(mat.metallicRoughnessTextureIndex);
+	const Texture& occTex = resolveTex(mat.occlusionTextureIndex);
+	const Texture& emisTex = resolveTex(mat.emissiveTextureIndex);
+	const Texture& normTex = resolveTex(mat.normalTextureIndex);
+	
+	// Create/fill MaterialGPU
+	MaterialGPU gpu{};
+	gpu.baseColorTT = toGPU(mat.baseColorTransform);
+	gpu.mrTT = toGPU(mat.metallicRoughnessTransform);
+	gpu.normalTT = toGPU(mat.normalTransform);
+	gpu.occlusionTT = toGPU(mat.occlusionTransform);
+	gpu.emissiveTT = toGPU(mat.emissiveTransform);
+
+	// Create a small uniform buffer for this material (you already have helpers for UBOs)
+	createBufferForMaterial(state, sizeof(MaterialGPU),
+		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+		&mat.materialBuffer, &mat.materialMemory);
+
+	void* data = nullptr;
+	vkMapMemory(state->context.device, mat.materialMemory, 0, sizeof(MaterialGPU), 0, &data);
+	memcpy(data, &gpu, sizeof(MaterialGPU));
+	vkUnmapMemory(state->context.device, mat.materialMemory);
+
+	VkDescriptorBufferInfo materialBufInfo{
+		.buffer = mat.materialBuffer,
+		.offset = 0,
+		.range = sizeof(MaterialGPU)
+	};
 
-		std::array<VkDescriptorImageInfo, 5> infos{
-			VkDescriptorImageInfo{ baseTex.textureSampler, baseTex.textureImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 0
-			VkDescriptorImageInfo{ mrTex.textureSampler,   mrTex.textureImageView,   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 1
-			VkDescriptorImageInfo{ occTex.textureSampler,  occTex.textureImageView,  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 2
-			VkDescriptorImageInfo{ emisTex.textureSampler, emisTex.textureImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 3
-			VkDescriptorImageInfo{ normTex.textureSampler, normTex.textureImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }  // binding 4
-		};
 
-		std::array<VkWriteDescriptorSet, 6> writes{};
-		for (uint32_t i = 0; i < 5; ++i) {
-			writes[i] = {
-				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-				.dstSet = mat.descriptorSet,
-				.dstBinding = i,
-				.descriptorCount = 1,
-				.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-				.pImageInfo = &infos[i]
-			};
-		}
+	std::array<VkDescriptorImageInfo, 5> infos{
+		VkDescriptorImageInfo{ baseTex.textureSampler, baseTex.textureImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 0
+		VkDescriptorImageInfo{ mrTex.textureSampler,   mrTex.textureImageView,   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 1
+		VkDescriptorImageInfo{ occTex.textureSampler,  occTex.textureImageView,  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 2
+		VkDescriptorImageInfo{ emisTex.textureSampler, emisTex.textureImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, // binding 3
+		VkDescriptorImageInfo{ normTex.textureSampler, normTex.textureImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }  // binding 4
+	};
 
-		// binding 5: material UBO
-		writes[5] = {
+	std::array<VkWriteDescriptorSet, 6> writes{};
+	for (uint32_t i = 0; i < 5; ++i) {
+		writes[i] = {
 			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 			.dstSet = mat.descriptorSet,
-			.dstBinding = 5,
+			.dstBinding = i,
 			.descriptorCount = 1,
-			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-			.pBufferInfo = &materialBufInfo
+			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.pImageInfo = &infos[i]
 		};
-
-		vkUpdateDescriptorSets(state->context.device,
-			static_cast<uint32_t>(writes.size()), writes.data(),
-			0, nullptr);
 	}
 
+	// binding 5: material UBO
+	writes[5] = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = mat.descriptorSet,
+		.dstBinding = 5,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+		.pBufferInfo = &materialBufInfo
+	};
+
+	vkUpdateDescriptorSets(state->context.device,
+		static_cast<uint32_t>(writes.size()), writes.data(),
+		0, nullptr);
 }
 
 void descriptorPoolDestroy(State* state)
@@ -1 +1,320 @@
 #include "headers/scene.h"
+#include <fstream>
+#include <random>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+//Utility
+static json jsonRead(const std::string& path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open " + path);
+	}
+	return json::parse(file);
+}
+
+static glm::vec3 vec3Read(const json& object, const char* key, glm::vec3 fallback) {
+	if (!object.contains(key)) return fallback;
+	const json& value = object.at(key);
+	return glm::vec3(value.at(0).get<float>(), value.at(1).get<float>(), value.at(2).get<float>());
+}
+
+static json vec3Json(const glm::vec3& value) {
+	return json::array({ value.x, value.y, value.z });
+}
+
+// Same composition as ModelInstance::setTransform
+static glm::mat4 sceneEntryLocal(const SceneEntry& entry) {
+	glm::mat4 T = glm::translate(glm::mat4(1.0f), entry.position);
+	glm::mat4 R = glm::mat4_cast(glm::quat(glm::radians(entry.rotation)));
+	glm::mat4 S = glm::scale(glm::mat4(1.0f), entry.scale);
+	return T * R * S;
+}
+
+//Description
+// { "baseColor": [r, g, b, a], "metallic": 0, "roughness": 1, "alphaMode": "BLEND" }
+static MaterialOverride materialOverrideParse(const json& material) {
+	MaterialOverride result{ .active = true };
+	if (material.contains("baseColor")) {
+		const json& color = material.at("baseColor");
+		result.baseColorFactor = glm::vec4(color.at(0).get<float>(), color.at(1).get<float>(), color.at(2).get<float>(),
+			color.size() > 3 ? color.at(3).get<float>() : 1.0f);
+	}
+	result.metallicFactor = material.value("metallic", -1.0f);
+	result.roughnessFactor = material.value("roughness", -1.0f);
+	result.transparent = material.value("alphaMode", std::string("OPAQUE")) == "BLEND";
+	return result;
+}
+
+static json materialOverrideJson(const MaterialOverride& material) {
+	const glm::vec4& color = material.baseColorFactor;
+	json result{ { "baseColor", json::array({ color.r, color.g, color.b, color.a }) } };
+	if (material.metallicFactor >= 0.0f) result["metallic"] = material.metallicFactor;
+	if (material.roughnessFactor >= 0.0f) result["roughness"] = material.roughnessFactor;
+	if (material.transparent) result["alphaMode"] = "BLEND";
+	return result;
+}
+
+// { "layout": "grid" | "clusters", "count": 1000, "models": [ "a.glb" ], "origin": [x, y, z],
+//   "spacing": 1, "scale": 1, "depth": 1, "materials": 0, "transparent": 0, "clusters": 16, "seed": 1 }
+static SceneGenerator sceneGeneratorParse(const json& block) {
+	SceneGenerator generator{};
+	std::string layout = block.value("layout", std::string("grid"));
+	if (layout == "clusters") generator.layout = SCENE_LAYOUT_CLUSTERS;
+	else if (layout != "grid") throw std::runtime_error("unknown scene layout " + layout);
+
+	generator.count = block.at("count").get<uint32_t>();
+	if (block.contains("model")) generator.models.push_back(block.at("model").get<std::string>());
+	for (const json& model : block.value("models", json::array())) generator.models.push_back(model.get<std::string>());
+	generator.origin = vec3Read(block, "origin", generator.origin);
+	generator.spacing = block.value("spacing", generator.spacing);
+	generator.scale = block.value("scale", generator.scale);
+	generator.depth = std::max(1u, block.value("depth", generator.depth));
+	generator.materials = block.value("materials", generator.materials);
+	generator.transparent = std::clamp(block.value("transparent", generator.transparent), 0.0f, 1.0f);
+	generator.clusters = std::max(1u, block.value("clusters", generator.clusters));
+	generator.seed = block.value("seed", generator.seed);
+	if (generator.models.empty()) throw std::runtime_error("scene generator without models");
+	return generator;
+}
+
+// {
+//   "name": "default",
+//   "camera": { "position": [x, y, z], "yaw": 90, "pitch": 0 },
+//   "lights": [ { "position": [x, y, z], "radius": 0, "color": [r, g, b], "intensity": 1 } ],
+//   "instances": [ { "model": "a.glb", "position": [...], "rotation": [...], "scale": [...],
+//                    "parent": 0, "material": { override } } ],
+//   "generate": [ { generator } ]
+// }
+void sceneDescriptionLoad(const std::string& path, SceneDescription& description) {
+	PROFILE_FUNCTION();
+	json scene = jsonRead(path);
+	description.name = scene.value("name", path);
+
+	if (scene.contains("camera")) {
+		const json& camera = scene.at("camera");
+		description.camera = true;
+		description.cameraPosition = vec3Read(camera, "position", glm::vec3(0.0f));
+		description.cameraYaw = camera.value("yaw", 90.0f);
+		description.cameraPitch = camera.value("pitch", 0.0f);
+	}
+
+	for (const json& light : scene.value("lights", json::array())) {
+		description.lights.push_back({
+			.position = vec3Read(light, "position", glm::vec3(0.0f)),
+			.radius = light.value("radius", 0.0f),
+			.color = vec3Read(light, "color", glm::vec3(1.0f)),
+			.intensity = light.value("intensity", 1.0f),
+		});
+	}
+
+	uint32_t first = static_cast<uint32_t>(description.entries.size());
+	for (const json& instance : scene.value("instances", json::array())) {
+		SceneEntry entry{
+			.model = instance.at("model").get<std::string>(),
+			.position = vec3Read(instance, "position", glm::vec3(0.0f)),
+			.rotation = vec3Read(instance, "rotation", glm::vec3(0.0f)),
+			.scale = vec3Read(instance, "scale", glm::vec3(1.0f)),
+			.parent = instance.value("parent", -1),
+		};
+		// Parents are indices within this file's instance list
+		if (entry.parent >= 0) {
+			if (entry.parent >= (int32_t)(description.entries.size() - first)) {
+				throw std::runtime_error(path + ": instance " + std::to_string(description.entries.size() - first) + " has a parent that is not listed before it");
+			}
+			entry.parent += (int32_t)first;
+		}
+		if (instance.contains("material")) entry.material = materialOverrideParse(instance.at("material"));
+		description.entries.push_back(std::move(entry));
+	}
+
+	const json& generate = scene.value("generate", json::array());
+	for (const json& block : generate.is_array() ? generate : json::array({ generate })) {
+		sceneGenerate(sceneGeneratorParse(block), description);
+	}
+}
+
+void sceneDescriptionWrite(const std::string& path, const SceneDescription& description) {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to write " + path);
+	}
+	file << "{\n\t\"name\": " << json(description.name).dump() << ",\n";
+	if (description.camera) {
+		json camera{ { "position", vec3Json(description.cameraPosition) }, { "yaw", description.cameraYaw }, { "pitch", description.cameraPitch } };
+		file << "\t\"camera\": " << camera.dump() << ",\n";
+	}
+	if (!description.lights.empty()) {
+		file << "\t\"lights\": [\n";
+		for (size_t i = 0; i < description.lights.size(); i++) {
+			const SceneLight& light = description.lights[i];
+			json entry{ { "position", vec3Json(light.position) }, { "radius", light.radius }, { "color", vec3Json(light.color) }, { "intensity", light.intensity } };
+			file << "\t\t" << entry.dump() << (i + 1 < description.lights.size() ? ",\n" : "\n");
+		}
+		file << "\t],\n";
+	}
+	file << "\t\"instances\": [\n";
+	for (size_t i = 0; i < description.entries.size(); i++) {
+		const SceneEntry& entry = description.entries[i];
+		json instance{ { "model", entry.model }, { "position", vec3Json(entry.position) } };
+		if (entry.rotation != glm::vec3(0.0f)) instance["rotation"] = vec3Json(entry.rotation);
+		if (entry.scale != glm::vec3(1.0f)) instance["scale"] = vec3Json(entry.scale);
+		if (entry.parent >= 0) instance["parent"] = entry.parent;
+		if (entry.material.active) instance["material"] = materialOverrideJson(entry.material);
+		file << "\t\t" << instance.dump() << (i + 1 < description.entries.size() ? ",\n" : "\n");
+	}
+	file << "\t]\n}\n";
+}
+
+//Generator
+// Hues spread by the golden angle so neighbouring indices never look alike
+static glm::vec4 sceneTint(uint32_t index) {
+	float hue = std::fmod(index * 0.618034f, 1.0f) * 6.0f;
+	float x = 1.0f - std::fabs(std::fmod(hue, 2.0f) - 1.0f);
+	glm::vec3 rgb = hue < 1.0f ? glm::vec3(1, x, 0) : hue < 2.0f ? glm::vec3(x, 1, 0) : hue < 3.0f ? glm::vec3(0, 1, x)
+		: hue < 4.0f ? glm::vec3(0, x, 1) : hue < 5.0f ? glm::vec3(x, 0, 1) : glm::vec3(1, 0, x);
+	return glm::vec4(0.25f + 0.75f * rgb, 1.0f);
+}
+
+void sceneGenerate(const SceneGenerator& generator, SceneDescription& description) {
+	PROFILE_FUNCTION();
+	if (generator.models.empty() || generator.count == 0) return;
+	std::mt19937 rng(generator.seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	// Chain roots are laid out; the other links of a chain stack on their root
+	uint32_t chains = (generator.count + generator.depth - 1) / generator.depth;
+	uint32_t side = (uint32_t)std::ceil(std::sqrt((float)chains));
+	float extent = 0.5f * side * generator.spacing;
+
+	std::vector<glm::vec3> centers(generator.clusters);
+	for (glm::vec3& center : centers) {
+		center = glm::vec3(extent * (2.0f * unit(rng) - 1.0f), 0.0f, extent * (2.0f * unit(rng) - 1.0f));
+	}
+	std::normal_distribution<float> spread(0.0f, generator.spacing * std::sqrt((float)chains / generator.clusters) * 0.5f);
+
+	uint32_t base = static_cast<uint32_t>(description.entries.size());
+	description.entries.reserve(base + generator.count);
+	for (uint32_t i = 0; i < generator.count; i++) {
+		uint32_t chain = i / generator.depth;
+		uint32_t link = i % generator.depth;
+		SceneEntry entry{ .model = generator.models[i % generator.models.size()] };
+
+		if (link == 0) {
+			if (generator.layout == SCENE_LAYOUT_GRID) {
+				entry.position = glm::vec3(((float)(chain % side) - 0.5f * side) * generator.spacing, 0.0f,
+					((float)(chain / side) - 0.5f * side) * generator.spacing);
+			}
+			else {
+				const glm::vec3& center = centers[chain % centers.size()];
+				entry.position = center + glm::vec3(spread(rng), 0.0f, spread(rng));
+				entry.rotation = glm::vec3(0.0f, 360.0f * unit(rng), 0.0f);
+			}
+			entry.position += generator.origin;
+			entry.scale = glm::vec3(generator.scale);
+		}
+		else {
+			// A twisting tower: each link half a cell above its parent, in the parent's (scaled) space
+			entry.parent = (int32_t)(base + i - 1);
+			entry.position = glm::vec3(0.0f, 0.5f * generator.spacing / generator.scale, 0.0f);
+			entry.rotation = glm::vec3(0.0f, 15.0f, 0.0f);
+		}
+
+		if (generator.materials > 0) {
+			entry.material.active = true;
+			entry.material.baseColorFactor = sceneTint(i % generator.materials);
+		}
+		if (generator.transparent > 0.0f && unit(rng) < generator.transparent) {
+			entry.material.active = true;
+			entry.material.transparent = true;
+			entry.material.baseColorFactor.a = 0.5f;
+		}
+		description.entries.push_back(std::move(entry));
+	}
+
+	if (!description.camera) {
+		description.camera = true;
+		description.cameraPosition = generator.origin + glm::vec3(0.0f, std::max(2.0f, 0.6f * extent), -(extent + 3.0f));
+		description.cameraYaw = 90.0f;
+		description.cameraPitch = -30.0f;
+	}
+	if (description.name.empty()) {
+		description.name = std::string(generator.layout == SCENE_LAYOUT_GRID ? "grid" : "clusters") + "-" + std::to_string(generator.count);
+	}
+}
+
+struct SceneGeneratorPreset {
+	const char* name;
+	const char* description;
+	void (*apply)(SceneGenerator& generator);
+};
+
+static const SceneGeneratorPreset sceneGeneratorPresets[] = {
+	{ "grid", "N instances on a square grid", [](SceneGenerator&) {} },
+	{ "clusters", "N instances in 16 random clusters", [](SceneGenerator& generator) { generator.layout = SCENE_LAYOUT_CLUSTERS; } },
+	{ "hierarchy", "N instances in parent chains 16 deep", [](SceneGenerator& generator) { generator.depth = 16; } },
+	{ "materials", "N instances, every one with its own tint", [](SceneGenerator& generator) { generator.materials = generator.count; } },
+	{ "transparent", "N instances, half of them in the sorted transparent pass", [](SceneGenerator& generator) { generator.transparent = 0.5f; } },
+};
+
+bool sceneGeneratorPreset(const std::string& name, uint32_t count, const std::string& model, SceneGenerator& generator) {
+	for (const SceneGeneratorPreset& preset : sceneGeneratorPresets) {
+		if (name != preset.name) continue;
+		generator = SceneGenerator{ .count = count, .models = { model } };
+		preset.apply(generator);
+		return true;
+	}
+	return false;
+}
+
+void sceneGeneratorPresetList() {
+	printf("scene presets:\n");
+	for (const SceneGeneratorPreset& preset : sceneGeneratorPresets) {
+		printf("  %-12s %s\n", preset.name, preset.description);
+	}
+}
+
+//Instances
+void sceneInstantiate(State* state, const SceneDescription& description) {
+	PROFILE_FUNCTION();
+	Scene& scene = state->scene;
+	std::vector<glm::mat4> world(description.entries.size());
+	scene.instances.reserve(scene.instances.size() + description.entries.size());
+
+	for (size_t i = 0; i < description.entries.size(); i++) {
+		const SceneEntry& entry = description.entries[i];
+		if (entry.parent >= (int32_t)i) {
+			throw std::runtime_error(description.name + ": instance " + std::to_string(i) + " is placed under a later one");
+		}
+		world[i] = entry.parent >= 0 ? world[entry.parent] * sceneEntryLocal(entry) : sceneEntryLocal(entry);
+
+		ModelInstance* instance = modelInstanceGet(state, modelInstanceCreate(state, entry.model));
+		instance->transform = world[i];
+		instance->material = entry.material;
+	}
+
+	if (!description.lights.empty()) {
+		if (description.lights.size() > SCENE_LIGHTS_MAX) {
+			printf("scene %s: %zu lights, the shader takes the first %u\n", description.name.c_str(), description.lights.size(), SCENE_LIGHTS_MAX);
+		}
+		for (uint32_t i = 0; i < SCENE_LIGHTS_MAX; i++) {
+			scene.lights[i] = i < description.lights.size() ? description.lights[i] : SceneLight{};
+		}
+	}
+
+	if (description.camera) {
+		scene.camera.position = description.cameraPosition;
+		scene.camera.yaw = description.cameraYaw;
+		scene.camera.pitch = description.cameraPitch;
+		scene.camera.updateCameraVectors();
+	}
+}
+
+void sceneLoad(State* state, const std::string& path) {
+	PROFILE_FUNCTION();
+	SceneDescription description;
+	sceneDescriptionLoad(path, description);
+	sceneInstantiate(state, description);
+	printf("scene %s: %zu instances\n", description.name.c_str(), description.entries.size());
+}
@@ -0,0 +1,128 @@
+#include "headers/skinning.h"
+
+//Palette
+// One matrix per joint: the joint's global pose times its bind matrix. The
+// vertex shader blends up to four of them per vertex.
+void skinningInstancePalette(const Model& model, const ModelInstance& instance, glm::mat4* out) {
+	const std::vector<glm::mat4>& global = instance.pose.empty() ? model.nodes.global : instance.pose.global;
+	for (const Skin& skin : model.skins) {
+		glm::mat4* palette = out + skin.paletteOffset;
+		for (size_t j = 0; j < skin.joints.size(); j++) {
+			palette[j] = global[skin.joints[j]] * skin.jointBind[j];
+		}
+	}
+}
+
+// Matrices needed to skin every current instance in one frame
+uint32_t skinningPaletteSize(State* state) {
+	uint32_t total = 0;
+	for (const ModelInstance& instance : state->scene.instances) {
+		const Model* model = modelGet(state, instance.model);
+		if (model) total += model->jointCount;
+	}
+	return total;
+}
+
+//Resources
+static void jointBufferCreate(State* state, uint32_t frame, uint32_t capacity) {
+	Renderer& renderer = state->renderer;
+	VkDeviceSize bufferSize = capacity * sizeof(glm::mat4);
+	createBuffer(
+		state,
+		bufferSize,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		renderer.jointBuffers[frame],
+		renderer.jointBuffersMemory[frame]
+	);
+	vkMapMemory(state->context.device, renderer.jointBuffersMemory[frame], 0, bufferSize, 0, &renderer.jointBuffersMapped[frame]);
+	renderer.jointCapacity[frame] = capacity;
+}
+
+static void jointBufferDestroy(State* state, uint32_t frame) {
+	Renderer& renderer = state->renderer;
+	vkUnmapMemory(state->context.device, renderer.jointBuffersMemory[frame]);
+	vkDestroyBuffer(state->context.device, renderer.jointBuffers[frame], nullptr);
+	vkFreeMemory(state->context.device, renderer.jointBuffersMemory[frame], nullptr);
+}
+
+// Sized for the instances that exist at startup. skinningPaletteReserve
+// grows a frame's buffer when later instances need more.
+void skinningCreate(State* state) {
+	uint32_t frames = state->config.swapchainBuffering;
+	uint32_t capacity = std::max(skinningPaletteSize(state), 1u);
+	state->renderer.jointBuffers.resize(frames);
+	state->renderer.jointBuffersMemory.resize(frames);
+	state->renderer.jointBuffersMapped.resize(frames);
+	state->renderer.jointCapacity.resize(frames);
+	for (uint32_t i = 0; i < frames; i++) {
+		jointBufferCreate(state, i, capacity);
+	}
+
+	printf("skinning: %u joint matrices per frame (%.1f KB x %u frames)\n",
+		capacity, capacity * sizeof(glm::mat4) / 1024.0, frames);
+}
+
+// Replaces one frame's palette buffer with a larger one and points that
+// frame's set 0 at it. Only called once the frame's fence has signalled, so
+// neither the old buffer nor the set is still in use.
+static void jointBufferGrow(State* state, uint32_t frame, uint32_t needed) {
+	Renderer& renderer = state->renderer;
+	uint32_t capacity = std::max(needed, renderer.jointCapacity[frame] + renderer.jointCapacity[frame] / 2);
+	jointBufferDestroy(state, frame);
+	jointBufferCreate(state, frame, capacity);
+
+	VkDescriptorBufferInfo jointInfo{
+		.buffer = renderer.jointBuffers[frame],
+		.offset = 0,
+		.range = VK_WHOLE_SIZE
+	};
+	std::array<VkWriteDescriptorSet, 2> writes{};
+	writes[0] = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = renderer.descriptorSets[frame],
+		.dstBinding = 1,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.pBufferInfo = &jointInfo
+	};
+	// Without a VAT crowd binding 4 borrows the joint buffer as well
+	writes[1] = writes[0];
+	writes[1].dstBinding = 4;
+	uint32_t writeCount = state->scene.crowd.instanceCount > 0 ? 1 : 2;
+	vkUpdateDescriptorSets(state->context.device, writeCount, writes.data(), 0, nullptr);
+
+	printf("skinning: frame %u joint buffer grown to %u matrices\n", frame, capacity);
+}
+
+// Called once the frame's fence has signalled: its palette buffer is no
+// longer in use by the GPU. Hands every skinned instance a slot, growing the
+// buffer first if they no longer fit; animationUpdate fills them in parallel.
+glm::mat4* skinningPaletteReserve(State* state) {
+	uint32_t frame = state->renderer.frameIndex;
+
+	uint32_t used = 0;
+	for (ModelInstance& instance : state->scene.instances) {
+		instance.jointBase = UINT32_MAX;
+		const Model* model = modelGet(state, instance.model);
+		if (!model || model->jointCount == 0 || instance.lod == ANIMATION_LOD_FROZEN) continue;
+
+		instance.jointBase = used;
+		used += model->jointCount;
+	}
+	if (used > state->renderer.jointCapacity[frame]) {
+		jointBufferGrow(state, frame, used);
+	}
+	state->renderer.jointsInUse = used;
+	return static_cast<glm::mat4*>(state->renderer.jointBuffersMapped[frame]);
+}
+
+void skinningDestroy(State* state) {
+	for (uint32_t i = 0; i < state->renderer.jointBuffers.size(); i++) {
+		jointBufferDestroy(state, i);
+	}
+	state->renderer.jointBuffers.clear();
+	state->renderer.jointBuffersMemory.clear();
+	state->renderer.jointBuffersMapped.clear();
+	state->renderer.jointCapacity.clear();
+}
@@ -0,0 +1,178 @@
+#include "headers/startup.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+using StartupClock = std::chrono::steady_clock;
+
+//Utility
+static double startupMs(StartupClock::time_point from, StartupClock::time_point to) {
+	return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+//Phases
+void startupBegin(State* state) {
+	state->startup.start = state->startup.lap = StartupClock::now();
+	state->startup.phases.clear();
+	state->startup.firstFrameMs = 0.0;
+}
+
+void startupPhase(State* state, const char* name) {
+	Startup& startup = state->startup;
+	if (startup.firstFrameMs > 0.0) return;
+	auto now = StartupClock::now();
+	startup.phases.push_back({ name, startupMs(startup.lap, now) });
+	startup.lap = now;
+}
+
+void startupFirstFrame(State* state) {
+	Startup& startup = state->startup;
+	if (startup.firstFrameMs > 0.0) return;
+	// The frame counts once the GPU is done with it; later frames never wait here
+	state->context.vk.queueWaitIdle(state->context.queue);
+	startupPhase(state, "first frame");
+	startup.firstFrameMs = startupMs(startup.start, startup.lap);
+
+	printf("startup: first frame after %.1f ms%s\n", startup.firstFrameMs, state->config.coldStart ? " (cold caches)" : "");
+	for (const StartupPhase& phase : startup.phases) {
+		printf("  %-16s %9.1f ms %5.1f%%\n", phase.name, phase.ms, 100.0 * phase.ms / startup.firstFrameMs);
+	}
+
+	if (startup.reportPath.empty()) return;
+	json report = { { "cold", state->config.coldStart }, { "firstFrameMs", startup.firstFrameMs }, { "phases", json::array() } };
+	for (const StartupPhase& phase : startup.phases) {
+		report["phases"].push_back({ { "name", phase.name }, { "ms", phase.ms } });
+	}
+	std::ofstream file(startup.reportPath);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to write " + startup.reportPath);
+	}
+	file << report.dump(2) << "\n";
+	// Headless runs are already limited to one frame by main
+	if (state->window.handle) glfwSetWindowShouldClose(state->window.handle, GLFW_TRUE);
+}
+
+//Benchmark
+// Best effort: drops the cached pages of every file under dir so the next
+// process reads models, textures and shaders from the disk again
+static uint32_t startupPageCacheEvict(const std::string& dir) {
+	uint32_t evicted = 0;
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec)) {
+		if (!entry.is_regular_file(ec)) continue;
+#ifdef _WIN32
+		// A non-cached open makes the cache manager flush and purge the file's pages
+		HANDLE file = CreateFileW(entry.path().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+			OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+		if (file == INVALID_HANDLE_VALUE) continue;
+		CloseHandle(file);
+#else
+		int file = open(entry.path().c_str(), O_RDONLY);
+		if (file < 0) continue;
+		posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+		close(file);
+#endif
+		evicted++;
+	}
+	return evicted;
+}
+
+struct StartupSeries {
+	std::vector<std::string> order;                        // phase names as the first run reported them
+	std::map<std::string, std::vector<double>> phases;
+	std::vector<double> firstFrame;
+	std::vector<double> process;                           // launch to exit, teardown included
+};
+
+static double startupMedian(std::vector<double> values) {
+	if (values.empty()) return 0.0;
+	std::sort(values.begin(), values.end());
+	return values[values.size() / 2];
+}
+
+// One child process; false if it failed or wrote no report
+static bool startupBenchLaunch(const std::string& exe, const std::string& args, bool cold, StartupSeries& series) {
+	std::string reportPath = (std::filesystem::temp_directory_path() / "VulkanRenderer-startup.json").string();
+	std::error_code ec;
+	std::filesystem::remove(reportPath, ec);
+
+	std::string command = "\"" + exe + "\"" + args + " --startup-report \"" + reportPath + "\"" + (cold ? " --cold" : "");
+#ifdef _WIN32
+	// cmd.exe strips one pair of outer quotes
+	command = "\"" + command + "\"";
+#endif
+	auto start = StartupClock::now();
+	int status = std::system(command.c_str());
+	double processMs = startupMs(start, StartupClock::now());
+
+	std::ifstream file(reportPath);
+	if (status != 0 || !file.is_open()) {
+		printf("  %s run failed (exit status %i)\n", cold ? "cold" : "warm", status);
+		return false;
+	}
+	json report = json::parse(file);
+	for (const json& phase : report.at("phases")) {
+		std::string name = phase.at("name").get<std::string>();
+		if (!series.phases.contains(name)) series.order.push_back(name);
+		series.phases[name].push_back(phase.at("ms").get<double>());
+	}
+	series.firstFrame.push_back(report.at("firstFrameMs").get<double>());
+	series.process.push_back(processMs);
+	return true;
+}
+
+static json startupSeriesJson(const StartupSeries& series) {
+	json result = { { "runs", series.firstFrame.size() }, { "firstFrameMs", startupMedian(series.firstFrame) },
+		{ "processMs", startupMedian(series.process) }, { "phases", json::array() } };
+	for (const std::string& name : series.order) {
+		result["phases"].push_back({ { "name", name }, { "ms", startupMedian(series.phases.at(name)) } });
+	}
+	return result;
+}
+
+int startupBenchRun(State* state, const std::string& exe, const std::string& args, uint32_t runs) {
+	// One unmeasured run first, so the warm runs find cooked textures and a hot page cache
+	StartupSeries discard, cold, warm;
+	printf("startup benchmark: %u cold and %u warm runs of %s%s\n", runs, runs, exe.c_str(), args.c_str());
+	if (!startupBenchLaunch(exe, args, false, discard)) return 1;
+
+	// Interleaved, so drift in the machine's state hits both series alike
+	for (uint32_t run = 0; run < runs; run++) {
+		uint32_t evicted = startupPageCacheEvict("res");
+		if (run == 0) printf("  cold runs: page cache dropped for %u files under res/, on-disk caches ignored\n", evicted);
+		if (!startupBenchLaunch(exe, args, true, cold)) return 1;
+		if (!startupBenchLaunch(exe, args, false, warm)) return 1;
+	}
+
+	printf("  %-16s %10s %10s\n", "median ms", "cold", "warm");
+	for (const std::string& name : cold.order) {
+		double warmMs = warm.phases.contains(name) ? startupMedian(warm.phases.at(name)) : 0.0;
+		printf("  %-16s %10.1f %10.1f\n", name.c_str(), startupMedian(cold.phases.at(name)), warmMs);
+	}
+	printf("  %-16s %10.1f %10.1f\n", "to first frame", startupMedian(cold.firstFrame), startupMedian(warm.firstFrame));
+	printf("  %-16s %10.1f %10.1f\n", "process", startupMedian(cold.process), startupMedian(warm.process));
+
+	const std::string& outputPath = state->frameBench.outputPath;
+	if (!outputPath.empty()) {
+		json results = { { "name", "startup" }, { "cold", startupSeriesJson(cold) }, { "warm", startupSeriesJson(warm) } };
+		std::ofstream file(outputPath);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to write " + outputPath);
+		}
+		file << results.dump(2) << "\n";
+		printf("results written to %s\n", outputPath.c_str());
+	}
+	return 0;
+}
@@ -28,6 +28,23 @@ VkFormat findDepthFormat(State *state) {
 bool hasStencilComponent(VkFormat format) {
     return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 }
+bool textureFormatSupported(State* state, VkFormat format) {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(state->context.physicalDevice, format, &props);
+    return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+static VkDeviceSize imageMemorySize(State* state, VkImage image) {
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(state->context.device, image, &memRequirements);
+    return memRequirements.size;
+}
+static VkDeviceSize rgba8ChainSize(uint32_t width, uint32_t height, uint32_t mipLevels) {
+    VkDeviceSize size = 0;
+    for (uint32_t level = 0; level < mipLevels; level++) {
+        size += (VkDeviceSize)std::max(1u, width >> level) * std::max(1u, height >> level) * 4;
+    }
+    return size;
+}
 //Textures
 void imageCreate(State *state,uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, uint32_t mipLevels, VkSampleCountFlagBits numSamples) {
     VkImageCreateInfo imageInfo{};
@@ -65,6 +82,7 @@ void imageCreate(State *state,uint32_t width, uint32_t height, VkFormat format,
 }
 
 void transitionImageLayout(State* state, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
+    PROFILE_FUNCTION();
     VkCommandBuffer commandBuffer = beginSingleTimeCommands(state, state->renderer.commandPool);
 
     VkImageMemoryBarrier barrier{};
@@ -103,7 +121,7 @@ void transitionImageLayout(State* state, VkImage image, VkFormat format, VkImage
         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
         sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        destinationStage = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     }
     else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
         barrier.srcAccessMask = 0;
@@ -115,7 +133,7 @@ void transitionImageLayout(State* state, VkImage image, VkFormat format, VkImage
     else {
         throw std::invalid_argument("unsupported layout transition!");
     }
-    vkCmdPipelineBarrier(
+    state->context.vk.cmdPipelineBarrier(
         commandBuffer,
         sourceStage, destinationStage,
         0,
@@ -151,7 +169,7 @@ void transitionSwapchainImagesToPresent(State* state) {
         barriers.push_back(barrier);
     }
 
-    vkCmdPipelineBarrier(
+    state->context.vk.cmdPipelineBarrier(
         cmd,
         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
@@ -166,6 +184,7 @@ void transitionSwapchainImagesToPresent(State* state) {
 }
 
 void copyBufferToImage(State *state, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
+    PROFILE_FUNCTION();
     VkCommandBuffer commandBuffer = beginSingleTimeCommands(state,state->renderer.commandPool);
 
     VkBufferImageCopy region{};
@@ -185,7 +204,7 @@ void copyBufferToImage(State *state, VkBuffer buffer, VkImage image, uint32_t wi
         1
     };
 
-    vkCmdCopyBufferToImage(
+    state->context.vk.cmdCopyBufferToImage(
         commandBuffer,
         buffer,
         image,
@@ -196,8 +215,22 @@ void copyBufferToImage(State *state, VkBuffer buffer, VkImage image, uint32_t wi
 
     endSingleTimeCommands(state, commandBuffer);
 }
+void copyBufferToImageLevels(State* state, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions) {
+    PROFILE_FUNCTION();
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(state, state->renderer.commandPool);
+
+    state->context.vk.cmdCopyBufferToImage(
+        commandBuffer,
+        buffer,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
+    );
+
+    endSingleTimeCommands(state, commandBuffer);
+}
 void textureImageCreate(State* state, std::string texturePath) {
-    // Load KTX2 texture instead of using stb_image
     ktxTexture* kTexture;
     KTX_error_code result = ktxTexture_CreateFromNamedFile(
         texturePath.c_str(),
@@ -207,39 +240,79 @@ void textureImageCreate(State* state, std::string texturePath) {
     if (result != KTX_SUCCESS) {
         throw std::runtime_error("failed to load ktx texture image!");
     }
+    if (kTexture->classId == ktxTexture2_c && !textureTranscodeBasis((ktxTexture2*)kTexture, basisTranscodeTargetSelect(state))) {
+        ktxTexture_Destroy(kTexture);
+        throw std::runtime_error("failed to transcode ktx texture image!");
+    }
 
-    // Get texture dimensions and data
+    textureUploadKtx(state, kTexture, state->texture);
+    ktxTexture_Destroy(kTexture);
+};
+
+// Uploads a KTX/KTX2 texture as-is. When the file carries a mip chain every
+// level goes up in a single multi-region copy; a single uncompressed level
+// falls back to blitting the chain on the GPU.
+void textureUploadKtx(State* state, ktxTexture* kTexture, Texture& outTex) {
+    PROFILE_FUNCTION();
     uint32_t texWidth = kTexture->baseWidth;
     uint32_t texHeight = kTexture->baseHeight;
-    ktx_size_t imageSize = ktxTexture_GetImageSize(kTexture, 0);
+    ktx_size_t dataSize = ktxTexture_GetDataSize(kTexture);
     ktx_uint8_t* ktxTextureData = ktxTexture_GetData(kTexture);
 
-    VkFormat textureFormat = ktxTexture_GetVkFormat(kTexture);
-
     // Save the actual format used for image creation so image views use the
     // identical format (required by Vulkan unless VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT).
-    state->texture.format = textureFormat;
+    VkFormat textureFormat = ktxTexture_GetVkFormat(kTexture);
+    outTex.format = textureFormat;
 
-    state->texture.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    bool generateLevels = kTexture->numLevels == 1 && !kTexture->isCompressed;
+    outTex.mipLevels = generateLevels
+        ? static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1
+        : kTexture->numLevels;
 
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
 
-    createBuffer(state, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    createBuffer(state, dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
     void* data;
-    vkMapMemory(state->context.device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, ktxTextureData, imageSize);
+    vkMapMemory(state->context.device, stagingBufferMemory, 0, dataSize, 0, &data);
+    memcpy(data, ktxTextureData, dataSize);
     vkUnmapMemory(state->context.device, stagingBufferMemory);
 
-    imageCreate(state, texWidth, texHeight, textureFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT| VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, state->texture.textureImage, state->texture.textureImageMemory, state->texture.mipLevels,VK_SAMPLE_COUNT_1_BIT);
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (generateLevels) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    imageCreate(state, texWidth, texHeight, textureFormat, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outTex.textureImage, outTex.textureImageMemory, outTex.mipLevels, VK_SAMPLE_COUNT_1_BIT);
+
+    std::vector<VkBufferImageCopy> regions(kTexture->numLevels);
+    for (uint32_t level = 0; level < kTexture->numLevels; level++) {
+        ktx_size_t offset = 0;
+        ktxTexture_GetImageOffset(kTexture, level, 0, 0, &offset);
+
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { std::max(1u, texWidth >> level), std::max(1u, texHeight >> level), 1 };
+    }
 
-    transitionImageLayout(state, state->texture.textureImage, textureFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, state->texture.mipLevels);
-    copyBufferToImage(state, stagingBuffer, state->texture.textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-    vkDestroyBuffer(state->context.device, stagingBuffer, nullptr);
-    vkFreeMemory(state->context.device, stagingBufferMemory, nullptr);
-    generateMipmaps(state, state->texture.textureImage, textureFormat, texWidth, texHeight, state->texture.mipLevels);
-    ktxTexture_Destroy(kTexture);
+    transitionImageLayout(state, outTex.textureImage, textureFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, outTex.mipLevels);
+    copyBufferToImageLevels(state, stagingBuffer, outTex.textureImage, regions);
+    stagingBufferRelease(state, stagingBuffer, stagingBufferMemory, dataSize);
+
+    if (generateLevels) {
+        generateMipmaps(state, outTex.textureImage, textureFormat, texWidth, texHeight, outTex.mipLevels);
+    }
+    else {
+        transitionImageLayout(state, outTex.textureImage, textureFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, outTex.mipLevels);
+    }
+
+    outTex.memorySize = imageMemorySize(state, outTex.textureImage);
+    outTex.uncompressedSize = rgba8ChainSize(texWidth, texHeight, outTex.mipLevels);
 };
 
 void textureImageViewCreate(State* state) {
@@ -283,30 +356,154 @@ VkImageView imageViewCreate(State *state, VkImage image, VkFormat format, VkImag
 void textureSamplerCreate(State* state) {
     VkPhysicalDeviceProperties properties{};
     vkGetPhysicalDeviceProperties(state->context.physicalDevice, &properties);
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerInfo.mipLodBias = 0.0f;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
-
-    PANIC(vkCreateSampler(state->context.device, &samplerInfo, nullptr, &state->texture.textureSampler), "failed to create texture sampler!");
+
+    SamplerKey key{};
+    key.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    state->texture.textureSampler = samplerAcquire(state, key);
 };
 void textureSamplerDestroy(State* state) {
-    vkDestroySampler(state->context.device, state->texture.textureSampler, nullptr);
+    samplerRelease(state, state->texture.textureSampler);
+    state->texture.textureSampler = VK_NULL_HANDLE;
 };
 
+//Sampler cache
+VkSampler samplerAcquire(State* state, const SamplerKey& key) {
+    SamplerCache& cache = state->scene.samplerCache;
+    cache.requested++;
+
+    SamplerCache::Entry& entry = cache.entries[key];
+    if (entry.sampler == VK_NULL_HANDLE) {
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = key.magFilter;
+        samplerInfo.minFilter = key.minFilter;
+        samplerInfo.mipmapMode = key.mipmapMode;
+        samplerInfo.addressModeU = key.addressModeU;
+        samplerInfo.addressModeV = key.addressModeV;
+        samplerInfo.addressModeW = key.addressModeW;
+        samplerInfo.anisotropyEnable = key.maxAnisotropy > 0.0f ? VK_TRUE : VK_FALSE;
+        samplerInfo.maxAnisotropy = key.maxAnisotropy;
+        samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        samplerInfo.unnormalizedCoordinates = VK_FALSE;
+        samplerInfo.compareEnable = VK_FALSE;
+        samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+        samplerInfo.mipLodBias = key.mipLodBias;
+        samplerInfo.minLod = key.minLod;
+        samplerInfo.maxLod = key.maxLod;
+
+        PANIC(vkCreateSampler(state->context.device, &samplerInfo, nullptr, &entry.sampler), "failed to create texture sampler!");
+    }
+    entry.refCount++;
+    return entry.sampler;
+}
+void samplerRelease(State* state, VkSampler sampler) {
+    SamplerCache& cache = state->scene.samplerCache;
+    for (auto it = cache.entries.begin(); it != cache.entries.end(); ++it) {
+        if (it->second.sampler != sampler) continue;
+        if (--it->second.refCount == 0) {
+            vkDestroySampler(state->context.device, sampler, nullptr);
+            cache.entries.erase(it);
+        }
+        return;
+    }
+}
+void samplerCacheDestroy(State* state) {
+    for (auto& [key, entry] : state->scene.samplerCache.entries) {
+        vkDestroySampler(state->context.device, entry.sampler, nullptr);
+    }
+    state->scene.samplerCache.entries.clear();
+}
+
+//Texture registry
+// FNV-1a; seed chains several buffers (or a role tag) into one key
+uint64_t textureContentHash(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+// Second, unrelated 64-bit hash that confirms a key match without keeping
+// the source around: 8-byte words through a multiply-rotate mix, length
+// folded in, splitmix64 finalizer
+uint64_t textureContentCheck(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const uint64_t k = 0x9e3779b97f4a7c15ull;
+    uint64_t hash = size * k;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ (word * 0xbf58476d1ce4e5b9ull)) * k;
+        hash = (hash << 31) | (hash >> 33);
+    }
+    uint64_t tail = 0;
+    if (i < size) memcpy(&tail, bytes + i, size - i);
+    hash ^= tail * 0x94d049bb133111ebull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+// Returns the scene texture already holding this content, or -1
+int textureRegistryAcquire(State* state, uint64_t hash, uint64_t check, size_t size, uint32_t tag) {
+    TextureRegistry& registry = state->scene.textureRegistry;
+    registry.requested++;
+
+    auto [begin, end] = registry.byHash.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        const TextureRegistryEntry& entry = it->second;
+        if (entry.tag != tag || entry.size != size || entry.check != check) {
+            continue;
+        }
+        state->scene.textures[entry.index].refCount++;
+        return (int)entry.index;
+    }
+    return -1;
+}
+uint32_t textureRegistryInsert(State* state, uint64_t hash, uint64_t check, size_t size, uint32_t tag, const Texture& texture) {
+    std::vector<Texture>& textures = state->scene.textures;
+
+    uint32_t index = (uint32_t)textures.size();
+    for (uint32_t i = 0; i < textures.size(); i++) {
+        if (textures[i].refCount == 0 && textures[i].textureImageView == VK_NULL_HANDLE) {
+            index = i;
+            break;
+        }
+    }
+    if (index == textures.size()) {
+        textures.emplace_back();
+    }
+
+    textures[index] = texture;
+    textures[index].contentHash = hash;
+    textures[index].refCount = 1;
+
+    state->scene.textureRegistry.byHash.emplace(hash, TextureRegistryEntry{ index, tag, check, size });
+    return index;
+}
+void textureRelease(State* state, uint32_t index) {
+    if (index >= state->scene.textures.size()) return;
+    Texture& tex = state->scene.textures[index];
+    if (tex.refCount == 0 || --tex.refCount > 0) return;
+
+    VkDevice device = state->context.device;
+    if (tex.textureImageView) vkDestroyImageView(device, tex.textureImageView, nullptr);
+    if (tex.textureImage) vkDestroyImage(device, tex.textureImage, nullptr);
+    if (tex.textureImageMemory) vkFreeMemory(device, tex.textureImageMemory, nullptr);
+    if (tex.textureSampler) samplerRelease(state, tex.textureSampler);
+
+    auto [begin, end] = state->scene.textureRegistry.byHash.equal_range(tex.contentHash);
+    for (auto it = begin; it != end; ++it) {
+        if (it->second.index == index) {
+            state->scene.textureRegistry.byHash.erase(it);
+            break;
+        }
+    }
+    tex = Texture{};
+}
+
 void createTextureFromMemory(
     State* state,
     const unsigned char* pixels,
@@ -399,23 +596,154 @@ void createTextureFromMemory(
         outTex.mipLevels
     );
 
-    // 6. Create sampler
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = static_cast<float>(outTex.mipLevels);
-
-    vkCreateSampler(device, &samplerInfo, nullptr, &outTex.textureSampler);
-
-    // 7. Cleanup staging
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingMemory, nullptr);
+    // 6. Sampler, shared through the cache. The view already bounds the mip
+    // chain, so maxLod stays unclamped rather than keyed per texture.
+    outTex.textureSampler = samplerAcquire(state, SamplerKey{});
+
+    // 7. Cleanup staging, deferred to the fence when an upload batch is open
+    stagingBufferRelease(state, stagingBuffer, stagingMemory, size);
+
+    outTex.memorySize = imageMemorySize(state, outTex.textureImage);
+    outTex.uncompressedSize = rgba8ChainSize(width, height, outTex.mipLevels);
+}
+void createTextureFromKtx(State* state, ktxTexture* kTexture, Texture& outTex) {
+    textureUploadKtx(state, kTexture, outTex);
+    outTex.textureImageView = imageViewCreate(state, outTex.textureImage, outTex.format, VK_IMAGE_ASPECT_COLOR_BIT, outTex.mipLevels);
+    outTex.textureSampler = samplerAcquire(state, SamplerKey{});
+}
+
+//Block compression
+VkFormat textureRoleFormat(TextureRole role) {
+    switch (role) {
+    case TextureRole::COLOR:         return VK_FORMAT_BC7_SRGB_BLOCK;
+    case TextureRole::NORMAL:        return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureRole::PACKED_LINEAR: return VK_FORMAT_BC7_UNORM_BLOCK;
+    case TextureRole::OCCLUSION:     return VK_FORMAT_BC4_UNORM_BLOCK;
+    }
+    return VK_FORMAT_UNDEFINED;
+}
+const char* textureRoleName(TextureRole role) {
+    switch (role) {
+    case TextureRole::COLOR:         return "bc7srgb";
+    case TextureRole::NORMAL:        return "bc5";
+    case TextureRole::PACKED_LINEAR: return "bc7";
+    case TextureRole::OCCLUSION:     return "bc4";
+    }
+    return "unknown";
+}
+
+// Basis Universal (ETC1S / UASTC) textures are transcoded to the best block
+// format the device samples, falling back to plain RGBA8.
+struct BasisTarget {
+    VkFormat format;
+    ktx_transcode_fmt_e target;
+    bool Context::* feature;
+};
+ktx_transcode_fmt_e basisTranscodeTargetSelect(State* state) {
+    static const BasisTarget candidates[] = {
+        { VK_FORMAT_BC7_SRGB_BLOCK,           KTX_TTF_BC7_RGBA,       &Context::textureCompressionBC },
+        { VK_FORMAT_ASTC_4x4_SRGB_BLOCK,      KTX_TTF_ASTC_4x4_RGBA,  &Context::textureCompressionASTC },
+        { VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, KTX_TTF_ETC2_RGBA,      &Context::textureCompressionETC2 },
+        { VK_FORMAT_BC3_SRGB_BLOCK,           KTX_TTF_BC3_RGBA,       &Context::textureCompressionBC },
+    };
+    for (const BasisTarget& candidate : candidates) {
+        if (state->context.*candidate.feature && textureFormatSupported(state, candidate.format)) {
+            return candidate.target;
+        }
+    }
+    return KTX_TTF_RGBA32;
+}
+bool textureTranscodeBasis(ktxTexture2* texture, ktx_transcode_fmt_e target) {
+    if (!ktxTexture2_NeedsTranscoding(texture)) {
+        return true;
+    }
+    return ktxTexture2_TranscodeBasis(texture, target, 0) == KTX_SUCCESS;
+}
+bool textureIsKtx2(const unsigned char* bytes, size_t size) {
+    static const unsigned char identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    return size >= sizeof(identifier) && memcmp(bytes, identifier, sizeof(identifier)) == 0;
+}
+
+// 2x2 box filter, edges clamp for odd sizes
+static std::vector<unsigned char> downsampleRgba8(const std::vector<unsigned char>& src, uint32_t width, uint32_t height) {
+    uint32_t dstWidth = std::max(1u, width / 2);
+    uint32_t dstHeight = std::max(1u, height / 2);
+    std::vector<unsigned char> dst((size_t)dstWidth * dstHeight * 4);
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        uint32_t y0 = std::min(y * 2, height - 1);
+        uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            uint32_t x0 = std::min(x * 2, width - 1);
+            uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            for (uint32_t c = 0; c < 4; c++) {
+                uint32_t sum = src[((size_t)y0 * width + x0) * 4 + c] + src[((size_t)y0 * width + x1) * 4 + c]
+                    + src[((size_t)y1 * width + x0) * 4 + c] + src[((size_t)y1 * width + x1) * 4 + c];
+                dst[((size_t)y * dstWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+// Encodes RGBA8 pixels (full mip chain) to UASTC and transcodes to the BC
+// format for the role. Runs on worker threads; touches no Vulkan state.
+ktxTexture2* textureCook(const unsigned char* pixels, uint32_t width, uint32_t height, TextureRole role) {
+    uint32_t mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+    ktxTextureCreateInfo createInfo{};
+    createInfo.vkFormat = role == TextureRole::COLOR ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    createInfo.baseWidth = width;
+    createInfo.baseHeight = height;
+    createInfo.baseDepth = 1;
+    createInfo.numDimensions = 2;
+    createInfo.numLevels = mipLevels;
+    createInfo.numLayers = 1;
+    createInfo.numFaces = 1;
+    createInfo.isArray = KTX_FALSE;
+    createInfo.generateMipmaps = KTX_FALSE;
+
+    ktxTexture2* texture = nullptr;
+    if (ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture) != KTX_SUCCESS) {
+        return nullptr;
+    }
+
+    std::vector<unsigned char> level(pixels, pixels + (size_t)width * height * 4);
+    uint32_t levelWidth = width;
+    uint32_t levelHeight = height;
+    for (uint32_t i = 0; i < mipLevels; i++) {
+        ktxTexture_SetImageFromMemory(ktxTexture(texture), i, 0, 0, level.data(), level.size());
+        if (i + 1 < mipLevels) {
+            level = downsampleRgba8(level, levelWidth, levelHeight);
+            levelWidth = std::max(1u, levelWidth / 2);
+            levelHeight = std::max(1u, levelHeight / 2);
+        }
+    }
+
+    ktxBasisParams params{};
+    params.structSize = sizeof(params);
+    params.uastc = KTX_TRUE;
+    params.uastcFlags = KTX_PACK_UASTC_LEVEL_DEFAULT;
+    params.threadCount = 1;   // parallelism comes from the job system
+    if (role == TextureRole::NORMAL) {
+        // BC5 is transcoded from R and A, so move the Y axis into alpha
+        params.normalMap = KTX_TRUE;
+        params.inputSwizzle[0] = 'r';
+        params.inputSwizzle[1] = 'r';
+        params.inputSwizzle[2] = 'r';
+        params.inputSwizzle[3] = 'g';
+    }
+
+    ktx_transcode_fmt_e target = KTX_TTF_BC7_RGBA;
+    if (role == TextureRole::NORMAL) target = KTX_TTF_BC5_RG;
+    if (role == TextureRole::OCCLUSION) target = KTX_TTF_BC4_R;
+
+    if (ktxTexture2_CompressBasisEx(texture, &params) != KTX_SUCCESS ||
+        ktxTexture2_TranscodeBasis(texture, target, 0) != KTX_SUCCESS) {
+        ktxTexture_Destroy(ktxTexture(texture));
+        return nullptr;
+    }
+    return texture;
 }
 void destroyTextures(State* state) {
     VkDevice device = state->context.device;
@@ -463,6 +791,7 @@ void depthBufferDestroy(State* state) {
 };
 
 void generateMipmaps(State *state, VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels) {
+    PROFILE_FUNCTION();
     VkFormatProperties formatProperties;
     vkGetPhysicalDeviceFormatProperties(state->context.physicalDevice, imageFormat, &formatProperties);
     if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
@@ -491,7 +820,7 @@ void generateMipmaps(State *state, VkImage image, VkFormat imageFormat, int32_t
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
-        vkCmdPipelineBarrier(commandBuffer,
+        state->context.vk.cmdPipelineBarrier(commandBuffer,
             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
             0, nullptr,
             0, nullptr,
@@ -511,7 +840,7 @@ void generateMipmaps(State *state, VkImage image, VkFormat imageFormat, int32_t
         blit.dstSubresource.baseArrayLayer = 0;
         blit.dstSubresource.layerCount = 1;
 
-        vkCmdBlitImage(commandBuffer,
+        state->context.vk.cmdBlitImage(commandBuffer,
             image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
             image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
             1, &blit,
@@ -522,7 +851,7 @@ void generateMipmaps(State *state, VkImage image, VkFormat imageFormat, int32_t
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-        vkCmdPipelineBarrier(commandBuffer,
+        state->context.vk.cmdPipelineBarrier(commandBuffer,
             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
             0, nullptr,
             0, nullptr,
@@ -538,7 +867,7 @@ void generateMipmaps(State *state, VkImage image, VkFormat imageFormat, int32_t
     barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    vkCmdPipelineBarrier(commandBuffer,
+    state->context.vk.cmdPipelineBarrier(commandBuffer,
         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
         0, nullptr,
         0, nullptr,
@@ -0,0 +1,203 @@
+#include "headers/vat.h"
+#include <random>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+//Bake
+// Poses the clip with the runtime's own sampling and palette code, then skins
+// every vertex once on the CPU. Frames cover [start, end) so playback wraps
+// from the last frame straight back to the first.
+void vatBake(const Model& model, uint32_t clip, float frameRate, VatBake& out) {
+	if (clip >= model.animations.size()) {
+		throw std::runtime_error("vatBake: " + model.name + " has no animation " + std::to_string(clip));
+	}
+	const Animation& animation = model.animations[clip];
+	const NodeStore& nodes = model.nodes;
+	float duration = std::max(animation.end - animation.start, 0.0f);
+
+	out.frameRate = frameRate;
+	out.frameCount = std::max(1u, static_cast<uint32_t>(std::ceil(duration * frameRate)));
+	out.width = 0;
+	out.vertexBase.assign(model.meshes.size(), 0);
+	for (size_t m = 0; m < model.meshes.size(); m++) {
+		out.vertexBase[m] = out.width;
+		out.width += static_cast<uint32_t>(model.meshes[m].vertices.size());
+	}
+	out.positions.assign((size_t)out.width * out.frameCount, glm::vec4(0.0f));
+	out.normals.assign((size_t)out.width * out.frameCount * 4, 0);
+
+	ModelInstance instance{};
+	instance.animationIndex = clip;
+	animationPoseCreate(model, instance);
+	std::vector<glm::mat4> palette(model.jointCount);
+
+	for (uint32_t frame = 0; frame < out.frameCount; frame++) {
+		// Frame times only ever increase, so the keyframe cursors still just step forward
+		instance.animationTime = animation.start + duration * frame / out.frameCount;
+		animationInstanceUpdate(model, instance, 0.0f);
+		skinningInstancePalette(model, instance, palette.data());
+
+		size_t row = (size_t)frame * out.width;
+		for (uint32_t node = 0; node < nodes.size(); node++) {
+			// The transforms the skinned draw path would use for this node
+			int32_t skin = nodes.skin[node];
+			glm::mat4 nodeMatrix = skin >= 0 ? gltfAxisSwap() : instance.pose.global[node];
+			const glm::mat4* joints = skin >= 0 ? palette.data() + model.skins[skin].paletteOffset : nullptr;
+
+			for (uint32_t m = nodes.meshFirst[node]; m < nodes.meshFirst[node] + nodes.meshCount[node]; m++) {
+				const std::vector<Vertex>& vertices = model.meshes[m].vertices;
+				for (size_t v = 0; v < vertices.size(); v++) {
+					const Vertex& vertex = vertices[v];
+					glm::mat4 M = nodeMatrix;
+					if (joints && glm::dot(vertex.weights, glm::vec4(1.0f)) > 0.0f) {
+						M = M * (vertex.weights.x * joints[vertex.joints.x] +
+							vertex.weights.y * joints[vertex.joints.y] +
+							vertex.weights.z * joints[vertex.joints.z] +
+							vertex.weights.w * joints[vertex.joints.w]);
+					}
+
+					size_t texel = row + out.vertexBase[m] + v;
+					out.positions[texel] = M * glm::vec4(vertex.pos, 1.0f);
+					glm::vec3 normal = glm::normalize(glm::inverseTranspose(glm::mat3(M)) * vertex.normal);
+					glm::uint64 packed = glm::packHalf4x16(glm::vec4(normal, 0.0f));
+					memcpy(&out.normals[texel * 4], &packed, sizeof(packed));
+				}
+			}
+		}
+	}
+}
+
+// GPU footprint of both textures
+size_t vatBakeMemory(const VatBake& bake) {
+	return (size_t)bake.width * bake.frameCount * (sizeof(glm::vec4) + 4 * sizeof(uint16_t));
+}
+
+//Crowd
+static void vatImageUpload(State* state, const void* texels, VkDeviceSize size, VkFormat format, uint32_t width, uint32_t height,
+	VkImage& image, VkDeviceMemory& memory, VkImageView& view) {
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingMemory;
+	createBuffer(state, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+
+	void* data;
+	vkMapMemory(state->context.device, stagingMemory, 0, size, 0, &data);
+	memcpy(data, texels, size);
+	vkUnmapMemory(state->context.device, stagingMemory);
+
+	imageCreate(state, width, height, format, VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		image, memory, 1, VK_SAMPLE_COUNT_1_BIT);
+	transitionImageLayout(state, image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+	copyBufferToImage(state, stagingBuffer, image, width, height);
+	transitionImageLayout(state, image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
+	view = imageViewCreate(state, image, format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+	vkDestroyBuffer(state->context.device, stagingBuffer, nullptr);
+	vkFreeMemory(state->context.device, stagingMemory, nullptr);
+}
+
+// Bakes the Fox's first clip and lays the crowd out on the same grid as the
+// skinned --fox crowd, so the two paths can be compared frame for frame.
+// Must run before descriptorSetsCreate, which points set 0 at the textures.
+void vatCrowdCreate(State* state, uint32_t instanceCount) {
+	VatCrowd& crowd = state->scene.crowd;
+	crowd.model = modelAcquire(state, state->config.FOX_MODEL_PATH);
+	const Model& model = *modelGet(state, crowd.model);
+	VatBake& bake = crowd.bake;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	vatBake(model, 0, 30.0f, bake);
+	double bakeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(state->context.physicalDevice, &properties);
+	uint32_t maxDimension = properties.limits.maxImageDimension2D;
+	if (bake.width > maxDimension || bake.frameCount > maxDimension) {
+		throw std::runtime_error("vertex animation texture " + std::to_string(bake.width) + "x" + std::to_string(bake.frameCount) +
+			" exceeds maxImageDimension2D " + std::to_string(maxDimension));
+	}
+
+	vatImageUpload(state, bake.positions.data(), bake.positions.size() * sizeof(glm::vec4), VK_FORMAT_R32G32B32A32_SFLOAT,
+		bake.width, bake.frameCount, crowd.positionImage, crowd.positionMemory, crowd.positionView);
+	vatImageUpload(state, bake.normals.data(), bake.normals.size() * sizeof(uint16_t), VK_FORMAT_R16G16B16A16_SFLOAT,
+		bake.width, bake.frameCount, crowd.normalImage, crowd.normalMemory, crowd.normalView);
+
+	// Read with texelFetch, the shader interpolates between frames itself
+	crowd.sampler = samplerAcquire(state, SamplerKey{
+		.magFilter = VK_FILTER_NEAREST,
+		.minFilter = VK_FILTER_NEAREST,
+		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+		.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+	});
+
+	// Placement never changes, only the start frame and pace vary per member
+	std::vector<VatInstance> instances(instanceCount);
+	std::mt19937 rng(37);
+	std::uniform_real_distribution<float> startFrame(0.0f, (float)bake.frameCount);
+	std::uniform_real_distribution<float> pace(0.9f, 1.1f);
+	uint32_t gridSide = (uint32_t)std::ceil(std::sqrt((float)instanceCount));
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		glm::vec3 position((float)(i % gridSide) - gridSide * 0.5f, 0.0f, -2.0f - (float)(i / gridSide));
+		instances[i].transform = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.01f));
+		instances[i].playback = glm::vec4(startFrame(rng), bake.frameRate * pace(rng), 0.0f, 0.0f);
+	}
+
+	VkDeviceSize size = instances.size() * sizeof(VatInstance);
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingMemory;
+	createBuffer(state, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+	void* data;
+	vkMapMemory(state->context.device, stagingMemory, 0, size, 0, &data);
+	memcpy(data, instances.data(), size);
+	vkUnmapMemory(state->context.device, stagingMemory);
+	createBuffer(state, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, crowd.instanceBuffer, crowd.instanceMemory);
+	copyBuffer(state, stagingBuffer, crowd.instanceBuffer, size);
+	vkDestroyBuffer(state->context.device, stagingBuffer, nullptr);
+	vkFreeMemory(state->context.device, stagingMemory, nullptr);
+
+	crowd.instanceCount = instanceCount;
+	printf("VAT crowd: %u x %s, '%s' baked to %u frames x %u vertices in %.1f ms, %.2f MB of textures\n",
+		instanceCount, model.name.c_str(), model.animations[0].name.c_str(), bake.frameCount, bake.width, bakeMs,
+		vatBakeMemory(bake) / (1024.0 * 1024.0));
+
+	// Only the texel layout is needed from here on
+	bake.positions = {};
+	bake.normals = {};
+}
+
+// One instanced draw per mesh for the whole crowd, inside the opaque pass.
+// Transparent meshes are left out: sorting thousands of copies isn't worth it.
+void vatCrowdDraw(State* state, VkCommandBuffer cmd) {
+	const VatCrowd& crowd = state->scene.crowd;
+	const Model* model = modelGet(state, crowd.model);
+	if (!model || crowd.instanceCount == 0) return;
+
+	for (const DrawItem& item : model->drawItems) {
+		if (item.transparent) continue;
+		size_t mesh = item.mesh - model->meshes.data();
+		drawMesh(state, cmd, *item.mesh, glm::mat4(1.0f), glm::mat4(1.0f), -1, (int)crowd.bake.vertexBase[mesh], crowd.instanceCount);
+	}
+}
+
+void vatCrowdDestroy(State* state) {
+	VatCrowd& crowd = state->scene.crowd;
+	VkDevice device = state->context.device;
+	if (crowd.instanceCount == 0) return;
+
+	vkDestroyImageView(device, crowd.positionView, nullptr);
+	vkDestroyImage(device, crowd.positionImage, nullptr);
+	vkFreeMemory(device, crowd.positionMemory, nullptr);
+	vkDestroyImageView(device, crowd.normalView, nullptr);
+	vkDestroyImage(device, crowd.normalImage, nullptr);
+	vkFreeMemory(device, crowd.normalMemory, nullptr);
+	vkDestroyBuffer(device, crowd.instanceBuffer, nullptr);
+	vkFreeMemory(device, crowd.instanceMemory, nullptr);
+	samplerRelease(state, crowd.sampler);
+	modelRelease(state, crowd.model);
+	crowd = VatCrowd{};
+}
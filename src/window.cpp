@@ -109,26 +109,47 @@ void surfaceDestroy(State* state) {
 };
 
 void windowCreate(State* state) {
-	initGLFW(state);
-	state->window.handle = glfwCreateWindow(state->config.windowWidth, state->config.windowHeight, state->config.windowTitle, nullptr, nullptr);
+	PROFILE_FUNCTION();
+	if (state->config.headless) {
+		// No GLFW, surface or swapchain: offscreen images stand in for it
+		instanceCreate(state);
+		startupPhase(state, "instance");
+		deviceCreate(state);
+		pipelineCacheCreate(state);
+		startupPhase(state, "device");
+		headlessTargetsCreate(state);
+		imageViewsCreate(state);
+		renderPassCreate(state);
+		startupPhase(state, "targets");
+	}
+	else {
+		initGLFW(state);
+		state->window.handle = glfwCreateWindow(state->config.windowWidth, state->config.windowHeight, state->config.windowTitle, nullptr, nullptr);
 
-	glfwSetFramebufferSizeCallback(state->window.handle, framebufferResizeCallback);
+		glfwSetFramebufferSizeCallback(state->window.handle, framebufferResizeCallback);
+		startupPhase(state, "window");
 
-	instanceCreate(state);
-	surfaceCreate(state);
-	deviceCreate(state);
+		instanceCreate(state);
+		startupPhase(state, "instance");
+		surfaceCreate(state);
+		deviceCreate(state);
+		pipelineCacheCreate(state);         // before guiInit, ImGui builds its pipeline through it
+		startupPhase(state, "device");
 
 
-	swapchainCreate(state);
-	swapchainImageGet(state);
-	imageViewsCreate(state);
-	renderPassCreate(state);
+		swapchainCreate(state);
+		swapchainImageGet(state);
+		imageViewsCreate(state);
+		renderPassCreate(state);
+		startupPhase(state, "targets");
 
-	guiRenderPassCreate(state);
-	guiFramebuffersCreate(state);
-	guiDescriptorPoolCreate(state);   // <-- MUST be here
+		guiRenderPassCreate(state);
+		guiFramebuffersCreate(state);
+		guiDescriptorPoolCreate(state);   // <-- MUST be here
 
-	guiInit(state);
+		guiInit(state);
+		startupPhase(state, "gui");
+	}
 	// MUST come BEFORE pipeline creation
 	createGlobalSetLayout(state);
 	createTextureSetLayout(state);   
@@ -137,59 +158,74 @@ void windowCreate(State* state) {
 
 	graphicsPipelineCreate(state);
 	tranparencyPipelineCreate(state);
+	startupPhase(state, "pipelines");
 	commandPoolCreate(state);
 	colorResourceCreate(state);
 	depthResourceCreate(state);
 	frameBuffersCreate(state);
+	startupPhase(state, "attachments");
+
+	if (!state->config.headless) {
+		// Store ImGui callbacks so we can chain them
+		auto imguiMouseCallback = ImGui_ImplGlfw_MouseButtonCallback;
+		auto imguiCursorCallback = ImGui_ImplGlfw_CursorPosCallback;
+		auto imguiScrollCallback = ImGui_ImplGlfw_ScrollCallback;
+		auto imguiKeyCallback = ImGui_ImplGlfw_KeyCallback;
+		auto imguiCharCallback = ImGui_ImplGlfw_CharCallback;
+
+		glfwSetWindowUserPointer(state->window.handle, state);
+		glfwSetCursorPosCallback(state->window.handle, mouseCallback);
+		glfwSetMouseButtonCallback(state->window.handle, mouseButtonCallback);
+		glfwSetCharCallback(state->window.handle, charCallback);
+		glfwSetKeyCallback(state->window.handle, keyCallback);
+	}
+
 
-	// Store ImGui callbacks so we can chain them
-	auto imguiMouseCallback = ImGui_ImplGlfw_MouseButtonCallback;
-	auto imguiCursorCallback = ImGui_ImplGlfw_CursorPosCallback;
-	auto imguiScrollCallback = ImGui_ImplGlfw_ScrollCallback;
-	auto imguiKeyCallback = ImGui_ImplGlfw_KeyCallback;
-	auto imguiCharCallback = ImGui_ImplGlfw_CharCallback;
-
-	glfwSetWindowUserPointer(state->window.handle, state);
-	glfwSetCursorPosCallback(state->window.handle, mouseCallback);
-	glfwSetMouseButtonCallback(state->window.handle, mouseButtonCallback);
-	glfwSetCharCallback(state->window.handle, charCallback);
-	glfwSetKeyCallback(state->window.handle, keyCallback);
-
-
-	// Load model + textures BEFORE descriptor sets
-	modelLoad(state, state->config.KOBOLD_MODEL_PATH);
-	modelLoad(state, state->config.HOVER_BIKE_MODEL_PATH);
-	modelLoad(state, state->config.MODEL_PATH);
-
-
-	state->scene.models[0].setTransform(
-		{ 0.0f, 0.0f, 0.0f },   // position
-		{ 0.0f, 0.0f, 0.0f },    // rotation
-		{ 1.0f, 1.0f, 1.0f }     // scale
-	);
-
-	state->scene.models[1].setTransform(
-		{ -1.0f, 0.0f, 0.0f },
-		{ 0.0f, 0.0f, 0.0f },
-		{ 0.003f, 0.003f, 0.003f }
-	);
-	state->scene.models[2].setTransform(
-		{ 2.0f, 0.0f, 0.0f },
-		{ 0.0f, 0.0f, 0.0f },
-		{ 0.003f, 0.003f, 0.003f }
-	);
+	// Load model + textures BEFORE descriptor sets.
+	// Instances of the same path share one asset.
+	sceneLoad(state, state->config.scenePath);
+	startupPhase(state, "scene");
+
+	// Crowd of Fox instances behind the hero models, one asset load total
+	uint32_t gridSide = (uint32_t)std::ceil(std::sqrt((float)state->config.foxInstanceCount));
+	for (uint32_t i = 0; i < state->config.foxInstanceCount; i++) {
+		ModelInstance* fox = modelInstanceGet(state, modelInstanceCreate(state, state->config.FOX_MODEL_PATH));
+		fox->setTransform(
+			{ (float)(i % gridSide) - gridSide * 0.5f, 0.0f, -2.0f - (float)(i / gridSide) },
+			{ 0.0f, 0.0f, 0.0f },
+			{ 0.01f, 0.01f, 0.01f }
+		);
+	}
+
+	// Crowd drawn from baked vertex animation textures, one instanced draw per mesh
+	if (state->config.vatInstanceCount > 0) {
+		vatCrowdCreate(state, state->config.vatInstanceCount);
+	}
+	startupPhase(state, "crowds");
 
 	uniformBuffersCreate(state);
+	skinningCreate(state);              // joint palettes, sized for the instances above
+	morphCreate(state);                 // per-instance vertex buffers for morphed meshes
+	startupPhase(state, "buffers");
 
 	descriptorPoolCreate(state);
 
-	descriptorSetsCreate(state);        // global UBO set (set = 0)
+	descriptorSetsCreate(state);        // global UBO + joints set (set = 0)
 	createMaterialDescriptorSets(state); // texture sets (set = 1)
+	startupPhase(state, "descriptors");
 
 	commandBufferGet(state);
+	gpuProfilerCreate(state);           // per-pass timestamp queries, before the first recording
 	commandBufferRecord(state);
 
 	syncObjectsCreate(state);
+	startupPhase(state, "first record");
+
+	const PipelineCacheStats& pipelines = state->context.pipelineCacheStats;
+	printf("pipelines: %u created in %.1f ms, %s\n", pipelines.pipelines, pipelines.createMs,
+		state->context.pipelineCache == VK_NULL_HANDLE ? "no cache" : pipelines.loadedBytes > 0 ? "from a warm cache" : "cache started empty");
+	// Written now as well as on exit, so a crash later on still keeps them
+	pipelineCacheSave(state);
 }
 
 
@@ -201,11 +237,18 @@ void windowDestroy(State* state) {
 	vkDestroyShaderModule(state->context.device, state->renderer.vertShaderModule, nullptr);
 	swapchainCleanup(state);
 	
-	guiClean(state);
+	if (state->config.headless)
+		headlessTargetsDestroy(state);
+	else
+		guiClean(state);
+	vatCrowdDestroy(state);
+	morphDestroy(state);
 	modelUnload(state);
 	destroyTextures(state);
 
 	uniformBuffersDestroy(state);
+	skinningDestroy(state);
+	gpuProfilerDestroy(state);
 	descriptorPoolDestroy(state);
 	descriptorSetLayoutDestroy(state);
 	indexBufferDestroy(state);
@@ -214,8 +257,13 @@ void windowDestroy(State* state) {
 	commandPoolDestroy(state);
 	tranparencyPipelineDestroy(state);
 	graphicsPipelineDestroy(state);
+	pipelineCacheDestroy(state);
 	renderPassDestroy(state);
 	deviceDestroy(state);
+	if (state->config.headless) {
+		instanceDestroy(state);
+		return;
+	}
 	surfaceDestroy(state);
 	instanceDestroy(state);
 	glfwDestroyWindow(state->window.handle);
@@ -319,6 +367,7 @@ void swapchainCreate(State* state) {
 
 };
 void swapchainDestroy(State* state) {
+	if (state->window.swapchain.handle == VK_NULL_HANDLE) return;   // headless
 	vkDestroySwapchainKHR(state->context.device, state->window.swapchain.handle, nullptr);
 };
 
@@ -332,6 +381,7 @@ void swapchainCleanup(State* state) {
 	guiFramebuffersDestroy(state);
 };
 void swapchainRecreate(State* state) {
+	metricsSwapchainRecreate(state);
 	int width = 0, height = 0;
 	glfwGetFramebufferSize(state->window.handle, &width, &height);
 	while (width == 0 || height == 0) {
@@ -359,9 +409,27 @@ void swapchainRecreate(State* state) {
 };
 
 //Draw
-void frameDraw(State* state) {
-	vkWaitForFences(state->context.device, 1, &state->renderer.inFlightFence[state->renderer.frameIndex], VK_TRUE, UINT64_MAX);
+// Milliseconds since `start`, then restarts it
+static double phaseLap(std::chrono::high_resolution_clock::time_point& start) {
+	auto now = std::chrono::high_resolution_clock::now();
+	double ms = std::chrono::duration<double, std::milli>(now - start).count();
+	start = now;
+	return ms;
+}
+
+void frameDraw(State* state, float deltaTime) {
+	PROFILE_FUNCTION();
+	FrameTimings& timings = state->renderer.timings;
+	RenderStats& stats = state->renderer.stats;
+	auto phase = std::chrono::high_resolution_clock::now();
+	{
+		PROFILE_ZONE("vkWaitForFences");
+		vkWaitForFences(state->context.device, 1, &state->renderer.inFlightFence[state->renderer.frameIndex], VK_TRUE, UINT64_MAX);
+	}
+	modelInstancesReclaim(state);
+	stats.fenceWaitMs = phaseLap(phase);
 	VkResult result = vkAcquireNextImageKHR(state->context.device, state->window.swapchain.handle, UINT64_MAX, state->renderer.imageAvailableSemaphore[state->renderer.frameIndex], VK_NULL_HANDLE, &state->renderer.imageAquiredIndex);
+	stats.acquireMs = phaseLap(phase);
 	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
 		swapchainRecreate(state);
 		return;
@@ -371,7 +439,12 @@ void frameDraw(State* state) {
 	}
 	vkResetFences(state->context.device, 1, &state->renderer.inFlightFence[state->renderer.frameIndex]);
 	vkResetCommandBuffer(state->buffers.commandBuffer[state->renderer.frameIndex],/*VkCommandBufferResetFlagBits*/0);
+	timings.wait = stats.fenceWaitMs + stats.acquireMs + phaseLap(phase);
+	gpuProfilerCollect(state);
+	animationUpdate(state, deltaTime);
+	timings.update = phaseLap(phase);
 	commandBufferRecord(state);
+	timings.record = phaseLap(phase) - timings.gather;
 
 	
 	VkSemaphore waitSemaphores[] = { state->renderer.imageAvailableSemaphore[state->renderer.frameIndex] };
@@ -391,6 +464,8 @@ void frameDraw(State* state) {
 	};
 
 	PANIC(vkQueueSubmit(state->context.queue, 1, &submitInfo, state->renderer.inFlightFence[state->renderer.frameIndex]), "Failed To Submit Queue");
+	morphSubmitted(state);
+	timings.submit = phaseLap(phase);
 	VkPresentInfoKHR presentInfo{
 		.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 
@@ -401,7 +476,11 @@ void frameDraw(State* state) {
 		.pImageIndices = &state->renderer.imageAquiredIndex,
 		.pResults = nullptr, // Optional
 	};
-	result = vkQueuePresentKHR(state->context.presentQueue, &presentInfo);
+	{
+		PROFILE_ZONE("vkQueuePresentKHR");
+		result = vkQueuePresentKHR(state->context.presentQueue, &presentInfo);
+	}
+	timings.present = phaseLap(phase);
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || state->window.framebufferResized) {
 		state->window.framebufferResized = false;
@@ -410,6 +489,8 @@ void frameDraw(State* state) {
 	else if (result != VK_SUCCESS) {
 		throw std::runtime_error("failed to present swap chain image!");
 	}
+	renderStatsFrameEnd(state);
+	startupFirstFrame(state);
 	state->renderer.frameIndex = (state->renderer.frameIndex + 1) % state->config.swapchainBuffering;
 };
 
@@ -470,4 +551,12 @@ void processInput(State* state) {
 		);
 	}
 	previous = current;
+
+	// Snapshot of the CPU zones recorded so far
+	static bool tracePrevious = false;
+	bool traceCurrent = glfwGetKey(state->window.handle, GLFW_KEY_F9) == GLFW_PRESS;
+	if (traceCurrent && !tracePrevious) {
+		profilerTraceWrite(state->config.tracePath.empty() ? "trace.json" : state->config.tracePath);
+	}
+	tracePrevious = traceCurrent;
 }